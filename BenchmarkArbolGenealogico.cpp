@@ -0,0 +1,908 @@
+/* ==============================================================
+   BANCO DE PRUEBAS DE RENDIMIENTO DEL ARBOL GENEALOGICO
+
+   Programa aparte que reutiliza ArbolGenealogico tal como lo compila
+   el menu (mismo archivo, sin su main) y mide, para cada tamano:
+   - insertar (insertarMiembroAVL y emplazarMiembro, con nombres nuevos
+     y repetidos), buscar (acierto y fallo, en el arbol y con el indice
+     congelado), modificar, eliminar y eliminar miembros con dos hijos,
+     con la latencia de cada operacion
+   - congelar el indice, vaciar el arbol completo, guardar la
+     instantanea binaria y cargarla (hasta poder consultar), y la primera
+     busqueda despues de cargar (una llamada cada una; la instantanea va
+     a benchmark_instantanea.bin en el directorio actual y se borra)
+   - buscar en un arbol aparte cuyos nombres comparten 32 bytes (el peor
+     caso de los prefijos que guarda cada nodo)
+   - los cuatro recorridos, mostrarEstadisticasAvanzadas y los
+     diagramas (vista por defecto, vista completa y vista de una region),
+     con la duracion de cada llamada completa
+
+   Los datos salen de GeneradorGenealogia: nombres quechuas y
+   castellanos con apellidos repetidos, como en un padron andino, asi
+   muchos nombres comparten sus primeros 16 bytes. El mismo indice y la
+   misma semilla dan siempre el mismo miembro en cualquier plataforma.
+
+   La salida del arbol (recorridos y diagramas) va a un dispositivo
+   nulo; el reporte va a la salida estandar original o a --salida, en
+   JSON o CSV, un registro por (tamano, operacion). Los mensajes de
+   avance van a stderr.
+
+   Se compila con MEDIR_ASIGNACIONES: cada registro trae tambien las
+   asignaciones de memoria (new) por operacion. El contador es un
+   incremento atomico por asignacion y entra en todas las latencias
+   por igual. Las operaciones por nombre traen ademas, de
+   MetricasOperacion, las comparaciones de nombres por operacion y
+   cuantas de ellas leyeron el texto (las demas se resolvieron con los
+   prefijos del nodo); en CSV esas columnas van vacias en el resto.
+
+   Compilar junto a CodigoArbolGenealogico.cpp:
+     g++ -std=c++98 -O2 -pthread -o benchmark BenchmarkArbolGenealogico.cpp
+
+   Pool de nodos contra un new/delete por nodo: compilar una segunda
+   vez con -DARBOL_NODOS_HEAP (el JSON lo indica en "nodos") y comparar
+   las dos corridas con la misma semilla:
+     g++ -std=c++98 -O2 -pthread -DARBOL_NODOS_HEAP -o benchmark_heap BenchmarkArbolGenealogico.cpp
+     benchmark --formato csv --etiqueta pool; benchmark_heap --formato csv --etiqueta heap
+
+   Uso:
+     benchmark [--tamanos 3-6] [--consultas N] [--repeticiones N]
+               [--semilla S] [--formato json|csv] [--salida archivo]
+               [--etiqueta texto]
+
+     --tamanos       Potencias de diez a medir: "3-6" (defecto) mide
+                     10^3, 10^4, 10^5 y 10^6; "7" solo 10^7 (unos 4 GB
+                     de memoria y varios minutos)
+     --consultas     Busquedas y modificaciones por tamano (defecto 100000)
+     --repeticiones  Minimo de llamadas por recorrido o diagrama (defecto 5);
+                     se repite hasta sumar medio segundo, como maximo 10000
+     --etiqueta      Texto libre copiado a cada registro (version, commit)
+                     para comparar corridas entre versiones
+   ============================================================== */
+#define ARBOL_SIN_MAIN
+#define MEDIR_ASIGNACIONES
+#include "CodigoArbolGenealogico.cpp"
+#include <ctime>
+#ifdef _WIN32
+#include <fcntl.h>
+#endif
+
+// Instantanea temporal de guardar_instantanea y cargar_instantanea
+const char* const INSTANTANEA_BENCHMARK = "benchmark_instantanea.bin";
+
+// Como reserva el arbol sus nodos (va en el reporte JSON)
+#ifdef ARBOL_NODOS_HEAP
+const char* const NODOS_DEL_ARBOL = "\"heap\"";
+#else
+const char* const NODOS_DEL_ARBOL = "\"pool\"";
+#endif
+
+/**
+ * Nanosegundos de un reloj monotono (solo para medir intervalos)
+ * Leerlo cuesta unas decenas de ns, que quedan dentro de cada latencia
+ */
+double nanosegundosActuales() {
+#ifdef _WIN32
+    static LARGE_INTEGER frecuencia;
+    if (frecuencia.QuadPart == 0) QueryPerformanceFrequency(&frecuencia);
+    LARGE_INTEGER t;
+    QueryPerformanceCounter(&t);
+    return (double)t.QuadPart * 1e9 / (double)frecuencia.QuadPart;
+#else
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec * 1e9 + (double)t.tv_nsec;
+#endif
+}
+
+/* ---------------------------
+   CLASE: AleatorioDeterminista
+   splitmix64: la misma semilla da la misma secuencia en cualquier
+   compilador (rand() cambia entre bibliotecas)
+   --------------------------- */
+class AleatorioDeterminista {
+private:
+    unsigned long long estado;
+
+public:
+    explicit AleatorioDeterminista(unsigned long long semilla) : estado(semilla) {}
+
+    /**
+     * Mezcla de splitmix64: biyectiva y con buena dispersion de bits
+     */
+    static unsigned long long mezclar(unsigned long long x) {
+        x += 0x9E3779B97F4A7C15ULL;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+        return x ^ (x >> 31);
+    }
+
+    unsigned long long siguiente() {
+        unsigned long long x = mezclar(estado);
+        estado += 0x9E3779B97F4A7C15ULL;
+        return x;
+    }
+
+    /**
+     * Entero en [0, n) (el sesgo del modulo es despreciable para n < 2^32)
+     */
+    long menorQue(long n) {
+        return (long)((siguiente() >> 11) % (unsigned long long)n);
+    }
+};
+
+/* ---------------------------
+   CLASE: GeneradorGenealogia
+   Miembro sintetico numero i, calculado solo a partir de (semilla, i):
+   no guarda nada, asi 10^7 miembros no ocupan memoria fuera del arbol.
+   Cada lista esta ordenada de mas a menos frecuente y se elige con
+   peso u^2 (u uniforme), de modo que los primeros nombres y apellidos
+   se repiten mucho, como en un padron real. El codigo final es i
+   permutado en 8 digitos: el nombre es unico para i < 10^8 y los
+   indices >= n sirven como nombres ausentes con la misma forma.
+   --------------------------- */
+const char* const NOMBRES_MASCULINOS[] = {
+    "Juan", "Jose", "Luis", "Carlos", "Jorge", "Inti", "Miguel", "Pedro",
+    "Amaru", "Tupac", "Victor", "Wayra", "Julio", "Sinchi", "Mario",
+    "Huayna", "Yupanqui", "Mayta", "Rumi", "Kusi", "Atoq", "Apu", "Illari"
+};
+const char* const NOMBRES_FEMENINOS[] = {
+    "Maria", "Rosa", "Ana", "Carmen", "Juana", "Quilla", "Luz", "Elena",
+    "Sumaq", "Flor", "Nina", "Chaska", "Lucia", "Sisa", "Gladys", "Ocllo",
+    "Killa", "Urpi", "Wayta", "Kantu", "Pacha", "Yuraq"
+};
+const char* const APELLIDOS[] = {
+    "Quispe", "Mamani", "Huaman", "Condori", "Flores", "Choque", "Sanchez",
+    "Rojas", "Apaza", "Ramos", "Ccahuana", "Chambi", "Huanca", "Gutierrez",
+    "Ticona", "Yupanqui", "Torres", "Vargas", "Paucar", "Huallpa", "Cutipa",
+    "Layme", "Poma", "Ccori", "Machaca", "Pari", "Callo", "Tito", "Cusi"
+};
+const char* const RELACIONES_SINTETICAS[] = {
+    "Hijo", "Hija", "Padre", "Madre", "Hermano", "Hermana", "Primo", "Prima",
+    "Tio", "Tia", "Nieto", "Nieta", "Abuelo", "Abuela"
+};
+const char* const OCUPACIONES_SINTETICAS[] = {
+    "Agricultura", "Pastoreo", "Comercio", "Tejido", "Docencia", "Artesania",
+    "Mineria", "Salud", "Construccion", "Transporte"
+};
+const char* const LUGARES_SINTETICOS[] = {
+    "Cusco", "Puno", "Juliaca", "Ayacucho", "Abancay", "Arequipa", "Lima",
+    "Huancavelica", "Andahuaylas", "Sicuani", "Urubamba", "Calca"
+};
+
+#define CANTIDAD(lista) ((int)(sizeof(lista) / sizeof(lista[0])))
+
+class GeneradorGenealogia {
+private:
+    unsigned long long semilla;
+
+    /**
+     * Posicion en una lista de n con peso u^2: favorece las primeras
+     * @param bits 16 bits aleatorios
+     */
+    static int sesgado(unsigned long long bits, int n) {
+        unsigned long long u = bits & 0xFFFF;
+        return (int)((u * u * (unsigned long long)n) >> 32);
+    }
+
+    unsigned long long azar(long i, unsigned long long flujo) const {
+        return AleatorioDeterminista::mezclar(semilla ^ AleatorioDeterminista::mezclar((unsigned long long)i * 4 + flujo));
+    }
+
+public:
+    static const long MAXIMO_INDICE = 100000000L; // 10^8 codigos de 8 digitos
+
+    explicit GeneradorGenealogia(unsigned long long _semilla) : semilla(_semilla) {}
+
+    /**
+     * Nombre del miembro i: "Nombre [Segundo] Paterno Materno CODIGO"
+     * @param destino Se reutiliza su memoria (assign, sin temporales)
+     */
+    void nombre(long i, string &destino) const {
+        unsigned long long h = azar(i, 0);
+        bool femenino = (h & 1) != 0;
+        const char* const* nombres = femenino ? NOMBRES_FEMENINOS : NOMBRES_MASCULINOS;
+        int cantidad = femenino ? CANTIDAD(NOMBRES_FEMENINOS) : CANTIDAD(NOMBRES_MASCULINOS);
+
+        destino.assign(nombres[sesgado(h >> 1, cantidad)]);
+        if (((h >> 17) & 3) == 0) { // Uno de cada cuatro lleva segundo nombre
+            destino += ' ';
+            destino += nombres[sesgado(h >> 19, cantidad)];
+        }
+        destino += ' ';
+        destino += APELLIDOS[sesgado(h >> 35, CANTIDAD(APELLIDOS))];
+        destino += ' ';
+        destino += APELLIDOS[sesgado(azar(i, 2), CANTIDAD(APELLIDOS))];
+
+        // 48271 es coprimo con 10^8: i -> codigo es una permutacion
+        unsigned long long codigo = ((unsigned long long)i * 48271ULL + 12345ULL) % MAXIMO_INDICE;
+        char digitos[10];
+        digitos[0] = ' ';
+        for (int d = 8; d >= 1; d--) {
+            digitos[d] = (char)('0' + codigo % 10);
+            codigo /= 10;
+        }
+        destino.append(digitos, 9);
+    }
+
+    /**
+     * Registro completo del miembro i (el genero sigue al nombre)
+     */
+    void miembro(long i, DatosMiembro &datos) const {
+        nombre(i, datos.nombre);
+        unsigned long long h = azar(i, 1);
+        bool femenino = (azar(i, 0) & 1) != 0;
+        datos.edad = (int)(h % 100);
+        datos.genero.assign(femenino ? "Femenino" : "Masculino");
+        int relacion = sesgado(h >> 8, CANTIDAD(RELACIONES_SINTETICAS) / 2) * 2 + (femenino ? 1 : 0);
+        datos.relacionFamiliar.assign(RELACIONES_SINTETICAS[relacion]);
+        datos.ocupacion.assign(OCUPACIONES_SINTETICAS[sesgado(h >> 24, CANTIDAD(OCUPACIONES_SINTETICAS))]);
+        datos.lugarNacimiento.assign(LUGARES_SINTETICOS[sesgado(h >> 40, CANTIDAD(LUGARES_SINTETICOS))]);
+    }
+};
+
+/* ---------------------------
+   ESTRUCTURA: Medicion
+   Latencias de una operacion en un tamano de arbol
+   --------------------------- */
+struct Medicion {
+    string operacion;
+    long tamano;
+    vector<double> muestras;    // ns por llamada
+    double totalNs;
+    long long asignaciones;     // new durante las llamadas medidas
+    bool cuentaComparaciones;   // true en las operaciones por nombre
+    long long comparaciones;    // Comparaciones de nombres
+    long long completas;        // De ellas, las que leyeron el texto
+
+    Medicion(const string &_operacion, long _tamano)
+        : operacion(_operacion), tamano(_tamano), totalNs(0), asignaciones(0),
+          cuentaComparaciones(false), comparaciones(0), completas(0) {}
+
+    /**
+     * @param ns Duracion de una llamada
+     * @param asignacionesAntes asignacionesTotales al empezar la llamada
+     */
+    void agregar(double ns, long long asignacionesAntes) {
+        muestras.push_back(ns);
+        totalNs += ns;
+        asignaciones += asignacionesTotales - asignacionesAntes;
+    }
+
+    /**
+     * Suma el trabajo de la ultima llamada (se lee fuera del tiempo medido)
+     * @param m metricasUltimaOperacion() del arbol
+     */
+    void contarComparaciones(const MetricasOperacion &m) {
+        cuentaComparaciones = true;
+        comparaciones += m.comparaciones;
+        completas += m.comparacionesCompletas;
+    }
+
+    /**
+     * Percentil por rango mas cercano (reordena las muestras)
+     * @param q Fraccion en (0, 1]
+     */
+    double percentil(double q) {
+        if (muestras.empty()) return 0;
+        size_t k = (size_t)(q * muestras.size() + 0.999999);
+        if (k < 1) k = 1;
+        if (k > muestras.size()) k = muestras.size();
+        nth_element(muestras.begin(), muestras.begin() + (k - 1), muestras.end());
+        return muestras[k - 1];
+    }
+
+    double maximo() const {
+        return muestras.empty() ? 0 : *max_element(muestras.begin(), muestras.end());
+    }
+};
+
+/* ---------------------------
+   CLASE: ReporteBenchmark
+   Escribe cada medicion en cuanto termina (si una corrida grande se
+   interrumpe, los tamanos anteriores ya estan en el reporte)
+   --------------------------- */
+class ReporteBenchmark {
+private:
+    BufferSalida salida;
+    bool json;
+    string etiqueta;
+    int registros;
+
+    /**
+     * Texto entre comillas con \ y " escapados (JSON y CSV)
+     */
+    void citar(const string &s) {
+        salida.caracter('"');
+        for (size_t i = 0; i < s.size(); i++) {
+            if (json && (s[i] == '"' || s[i] == '\\')) salida.caracter('\\');
+            else if (!json && s[i] == '"') salida.caracter('"');
+            salida.caracter(s[i]);
+        }
+        salida.caracter('"');
+    }
+
+public:
+    ReporteBenchmark(FILE* destino, bool _json, const string &_etiqueta,
+                     unsigned long long semilla, long consultas)
+        : salida(destino), json(_json), etiqueta(_etiqueta), registros(0)
+    {
+        if (json) {
+            salida.texto("{\n  \"etiqueta\": ");
+            citar(etiqueta);
+            salida.texto(",\n  \"nodos\": ").texto(NODOS_DEL_ARBOL);
+            salida.texto(",\n  \"semilla\": ").entero((long long)semilla);
+            salida.texto(",\n  \"consultas\": ").entero(consultas);
+            salida.texto(",\n  \"resultados\": [");
+        } else {
+            salida.texto("etiqueta,tamano,operacion,repeticiones,total_ms,ops_por_s,"
+                         "p50_ns,p99_ns,max_ns,asignaciones_por_op,"
+                         "comparaciones_por_op,completas_por_op\n");
+        }
+    }
+
+    void escribir(Medicion &m) {
+        long repeticiones = (long)m.muestras.size();
+        double opsPorSegundo = m.totalNs > 0 ? repeticiones * 1e9 / m.totalNs : 0;
+        double p50 = m.percentil(0.50), p99 = m.percentil(0.99), maximo = m.maximo();
+        double asignacionesPorOp = repeticiones > 0 ? (double)m.asignaciones / repeticiones : 0;
+        double comparacionesPorOp = repeticiones > 0 ? (double)m.comparaciones / repeticiones : 0;
+        double completasPorOp = repeticiones > 0 ? (double)m.completas / repeticiones : 0;
+        if (json) {
+            salida.texto(registros == 0 ? "\n" : ",\n");
+            salida.texto("    {\"tamano\": ").entero(m.tamano);
+            salida.texto(", \"operacion\": ");
+            citar(m.operacion);
+            salida.texto(", \"repeticiones\": ").entero(repeticiones);
+            salida.texto(", \"total_ms\": ").decimal(m.totalNs / 1e6, 3);
+            salida.texto(", \"ops_por_s\": ").decimal(opsPorSegundo, 1);
+            salida.texto(", \"p50_ns\": ").decimal(p50, 0);
+            salida.texto(", \"p99_ns\": ").decimal(p99, 0);
+            salida.texto(", \"max_ns\": ").decimal(maximo, 0);
+            salida.texto(", \"asignaciones_por_op\": ").decimal(asignacionesPorOp, 2);
+            if (m.cuentaComparaciones) {
+                salida.texto(", \"comparaciones_por_op\": ").decimal(comparacionesPorOp, 2);
+                salida.texto(", \"completas_por_op\": ").decimal(completasPorOp, 2);
+            }
+            salida.caracter('}');
+        } else {
+            citar(etiqueta);
+            salida.caracter(',').entero(m.tamano).caracter(',').texto(m.operacion);
+            salida.caracter(',').entero(repeticiones);
+            salida.caracter(',').decimal(m.totalNs / 1e6, 3);
+            salida.caracter(',').decimal(opsPorSegundo, 1);
+            salida.caracter(',').decimal(p50, 0);
+            salida.caracter(',').decimal(p99, 0);
+            salida.caracter(',').decimal(maximo, 0);
+            salida.caracter(',').decimal(asignacionesPorOp, 2).caracter(',');
+            // Vacias en las operaciones que no comparan nombres
+            if (m.cuentaComparaciones) {
+                salida.decimal(comparacionesPorOp, 2).caracter(',');
+                salida.decimal(completasPorOp, 2);
+            } else {
+                salida.caracter(',');
+            }
+            salida.finLinea();
+        }
+        registros++;
+        salida.vaciar();
+    }
+
+    ~ReporteBenchmark() {
+        if (json) salida.texto(registros == 0 ? "]\n}\n" : "\n  ]\n}\n");
+    }
+};
+
+/* ---------------------------
+   Salida del arbol a un dispositivo nulo: los recorridos y diagramas
+   escriben por stdout (BufferSalida y cout), y medirlos contra una
+   terminal mediria la terminal
+   --------------------------- */
+
+/**
+ * Redirige stdout al dispositivo nulo
+ * @return Descriptor con la salida estandar original (-1 si fallo)
+ */
+int silenciarSalidaEstandar() {
+    fflush(stdout);
+#ifdef _WIN32
+    int original = _dup(_fileno(stdout));
+    int nulo = _open("NUL", _O_WRONLY);
+    if (original < 0 || nulo < 0) return -1;
+    _dup2(nulo, _fileno(stdout));
+    _close(nulo);
+#else
+    int original = dup(fileno(stdout));
+    int nulo = open("/dev/null", O_WRONLY);
+    if (original < 0 || nulo < 0) return -1;
+    dup2(nulo, fileno(stdout));
+    close(nulo);
+#endif
+    return original;
+}
+
+/**
+ * Abre como FILE* un descriptor obtenido con silenciarSalidaEstandar
+ */
+FILE* abrirDescriptor(int descriptor) {
+#ifdef _WIN32
+    return _fdopen(descriptor, "w");
+#else
+    return fdopen(descriptor, "w");
+#endif
+}
+
+/* ---------------------------
+   CLASE: BancoPruebas
+   Corre todas las mediciones de un tamano sobre un arbol nuevo
+   --------------------------- */
+class BancoPruebas {
+private:
+    const GeneradorGenealogia &generador;
+    ReporteBenchmark &reporte;
+    long consultas;
+    long minimoRepeticiones;
+    AleatorioDeterminista azar;
+    int errores;
+
+    static const long MAXIMO_REPETICIONES = 10000;
+
+    /**
+     * Indica un resultado inesperado (el reporte sigue, pero el
+     * programa termina con codigo 2)
+     */
+    void fallo(const char* operacion, long tamano, long esperados, long obtenidos) {
+        fprintf(stderr, "ERROR: %s con %ld miembros: %ld de %ld\n",
+                operacion, tamano, obtenidos, esperados);
+        errores++;
+    }
+
+    /**
+     * Repeticiones de una llamada completa: al menos minimoRepeticiones
+     * y hasta sumar medio segundo
+     */
+    bool seguirRepitiendo(const Medicion &m) const {
+        long hechas = (long)m.muestras.size();
+        if (hechas < minimoRepeticiones) return true;
+        return hechas < MAXIMO_REPETICIONES && m.totalNs < 5e8;
+    }
+
+    void medirRecorrido(ArbolGenealogico &arbol, long n, int tipo, const char* nombre) {
+        Medicion m(nombre, n);
+        while (seguirRepitiendo(m)) {
+            long long a0 = asignacionesTotales;
+            double t0 = nanosegundosActuales();
+            switch (tipo) {
+                case 0: arbol.mostrarPreorden(); break;
+                case 1: arbol.mostrarInorden(); break;
+                case 2: arbol.mostrarPostorden(); break;
+                default: arbol.mostrarPorNiveles(); break;
+            }
+            fflush(stdout);
+            m.agregar(nanosegundosActuales() - t0, a0);
+        }
+        reporte.escribir(m);
+    }
+
+public:
+    BancoPruebas(const GeneradorGenealogia &_generador, ReporteBenchmark &_reporte,
+                 long _consultas, long _minimoRepeticiones, unsigned long long semilla)
+        : generador(_generador), reporte(_reporte), consultas(_consultas),
+          minimoRepeticiones(_minimoRepeticiones), azar(semilla ^ 0xA5A5A5A5ULL), errores(0) {}
+
+    int totalErrores() const { return errores; }
+
+    /**
+     * Inserciones con emplazarMiembro (el nombre se mueve al nodo) en un
+     * arbol aparte, para comparar tiempo y asignaciones con insertar.
+     * El arbol se libera antes de medir lo demas (10^7 no entra dos veces)
+     */
+    void medirEmplazamiento(long n) {
+        ArbolGenealogico arbol;
+        DatosMiembro d;
+
+        fprintf(stderr, "[%ld] emplazar\n", n);
+        Medicion emplazar("emplazar", n);
+        emplazar.muestras.reserve(n);
+        long insertados = 0;
+        for (long i = 0; i < n; i++) {
+            generador.miembro(i, d);
+            long long a0 = asignacionesTotales;
+            double t0 = nanosegundosActuales();
+            bool ok = arbol.emplazarMiembro(d);
+            emplazar.agregar(nanosegundosActuales() - t0, a0);
+            emplazar.contarComparaciones(arbol.metricasUltimaOperacion());
+            if (ok) insertados++;
+        }
+        if (insertados != n) fallo("emplazar", n, n, insertados);
+        reporte.escribir(emplazar);
+
+        Medicion repetido("emplazar_repetido", n);
+        long rechazados = 0;
+        for (long q = 0; q < consultas; q++) {
+            generador.miembro(azar.menorQue(n), d);
+            long long a0 = asignacionesTotales;
+            double t0 = nanosegundosActuales();
+            bool ok = arbol.emplazarMiembro(d);
+            repetido.agregar(nanosegundosActuales() - t0, a0);
+            repetido.contarComparaciones(arbol.metricasUltimaOperacion());
+            if (!ok) rechazados++;
+        }
+        if (rechazados != consultas) fallo("emplazar_repetido", n, consultas, rechazados);
+        reporte.escribir(repetido);
+
+        // La instantanea se guarda con los n miembros y se vuelve a
+        // cargar en este mismo arbol despues de vaciarlo (10^7 no entra dos veces)
+        fprintf(stderr, "[%ld] guardar instantanea\n", n);
+        Medicion guardar("guardar_instantanea", n);
+        long long a0 = asignacionesTotales;
+        double t0 = nanosegundosActuales();
+        bool guardada = arbol.guardarInstantanea(INSTANTANEA_BENCHMARK);
+        guardar.agregar(nanosegundosActuales() - t0, a0);
+        if (!guardada) fallo("guardar_instantanea", n, 1, 0);
+        reporte.escribir(guardar);
+
+        // Eliminaciones de miembros con dos hijos (el sucesor se reenlaza
+        // en su lugar), elegidos al azar; a lo sumo un cuarto del arbol
+        fprintf(stderr, "[%ld] eliminar con dos hijos\n", n);
+        Medicion dosHijos("eliminar_dos_hijos", n);
+        string nombre;
+        long objetivo = consultas < n / 4 ? consultas : n / 4;
+        for (long intentos = 0; (long)dosHijos.muestras.size() < objetivo && intentos < 16 * objetivo; intentos++) {
+            generador.nombre(azar.menorQue(n), nombre);
+            const Miembro* m = arbol.buscarMiembroLectura(nombre);
+            if (m == NULL || m->izquierdo == NULL || m->derecho == NULL) continue;
+            long long a0 = asignacionesTotales;
+            double t0 = nanosegundosActuales();
+            bool ok = arbol.eliminarMiembro(nombre);
+            dosHijos.agregar(nanosegundosActuales() - t0, a0);
+            dosHijos.contarComparaciones(arbol.metricasUltimaOperacion());
+            if (!ok) fallo("eliminar_dos_hijos", n, 1, 0);
+        }
+        if (!arbol.estaBalanceado()) fallo("eliminar_dos_hijos (balance AVL)", n, 1, 0);
+        reporte.escribir(dosHijos);
+
+        // Vaciar el arbol completo de una vez: con el pool los nodos se
+        // devuelven por bloques, con -DARBOL_NODOS_HEAP uno por uno
+        Medicion vaciar("vaciar", n);
+        a0 = asignacionesTotales;
+        t0 = nanosegundosActuales();
+        arbol.vaciar();
+        vaciar.agregar(nanosegundosActuales() - t0, a0);
+        reporte.escribir(vaciar);
+
+        if (guardada) medirCargaInstantanea(arbol, n);
+        remove(INSTANTANEA_BENCHMARK);
+    }
+
+    /**
+     * Carga la instantanea de n miembros en un arbol vacio (hasta que
+     * se puede consultar) y mide la primera busqueda despues de cargar
+     */
+    void medirCargaInstantanea(ArbolGenealogico &arbol, long n) {
+        fprintf(stderr, "[%ld] cargar instantanea\n", n);
+        Medicion cargar("cargar_instantanea", n), primera("buscar_tras_cargar", n);
+        string error, nombre;
+        long long a0 = asignacionesTotales;
+        double t0 = nanosegundosActuales();
+        bool ok = arbol.cargarInstantanea(INSTANTANEA_BENCHMARK, error);
+        cargar.agregar(nanosegundosActuales() - t0, a0);
+        if (!ok) fprintf(stderr, "ERROR: %s\n", error.c_str());
+        if (!ok || arbol.totalMiembros() != n) fallo("cargar_instantanea", n, n, arbol.totalMiembros());
+        reporte.escribir(cargar);
+
+        generador.nombre(azar.menorQue(n), nombre);
+        a0 = asignacionesTotales;
+        t0 = nanosegundosActuales();
+        const Miembro* m = arbol.buscarMiembro(nombre);
+        primera.agregar(nanosegundosActuales() - t0, a0);
+        primera.contarComparaciones(arbol.metricasUltimaOperacion());
+        if (m == NULL) fallo("buscar_tras_cargar", n, 1, 0);
+        reporte.escribir(primera);
+    }
+
+    /**
+     * Congela el indice y repite las busquedas de buscar_acierto y
+     * buscar_fallo sobre el: misma cantidad de consultas, nombres del
+     * mismo generador. El indice sigue vigente hasta la siguiente
+     * insercion o eliminacion (las modificaciones no lo invalidan)
+     */
+    void medirCongelado(ArbolGenealogico &arbol, long n) {
+        fprintf(stderr, "[%ld] buscar con el indice congelado\n", n);
+        string nombre;
+        Medicion congelar("congelar", n);
+        long long a0 = asignacionesTotales;
+        double t0 = nanosegundosActuales();
+        long indexados = arbol.congelar();
+        congelar.agregar(nanosegundosActuales() - t0, a0);
+        if (indexados != n || !arbol.estaCongelado()) fallo("congelar", n, n, indexados);
+        reporte.escribir(congelar);
+
+        Medicion acierto("buscar_congelado_acierto", n), ausente("buscar_congelado_fallo", n);
+        long encontrados = 0, falsos = 0;
+        for (long q = 0; q < consultas; q++) {
+            generador.nombre(azar.menorQue(n), nombre);
+            a0 = asignacionesTotales;
+            t0 = nanosegundosActuales();
+            const Miembro* m = arbol.buscarMiembro(nombre);
+            acierto.agregar(nanosegundosActuales() - t0, a0);
+            acierto.contarComparaciones(arbol.metricasUltimaOperacion());
+            if (m != NULL) encontrados++;
+        }
+        for (long q = 0; q < consultas; q++) {
+            generador.nombre(n + azar.menorQue(n), nombre); // Nunca insertado
+            a0 = asignacionesTotales;
+            t0 = nanosegundosActuales();
+            const Miembro* m = arbol.buscarMiembro(nombre);
+            ausente.agregar(nanosegundosActuales() - t0, a0);
+            ausente.contarComparaciones(arbol.metricasUltimaOperacion());
+            if (m != NULL) falsos++;
+        }
+        if (encontrados != consultas) fallo("buscar_congelado_acierto", n, consultas, encontrados);
+        if (falsos != 0) fallo("buscar_congelado_fallo", n, 0, falsos);
+        reporte.escribir(acierto);
+        reporte.escribir(ausente);
+    }
+
+    /**
+     * Peor caso de los prefijos cacheados: n nombres que comparten sus
+     * primeros 32 bytes, asi ninguna comparacion se resuelve con los 24
+     * bytes del nodo y todas leen el texto. Se compara con buscar_acierto
+     */
+    void medirPrefijoComun(long n) {
+        fprintf(stderr, "[%ld] buscar con prefijo comun\n", n);
+        ArbolGenealogico arbol;
+        const string comun = "Ayllu Quispe Mamani de Ayacucho "; // 32 bytes
+        string nombre;
+        for (long i = 0; i < n; i++) {
+            generador.nombre(i, nombre);
+            arbol.insertarMiembroAVL(comun + nombre, 30, "Femenino", "Hija", "Tejido", "Cusco");
+        }
+        Medicion acierto("buscar_prefijo_comun", n);
+        long encontrados = 0;
+        for (long q = 0; q < consultas; q++) {
+            generador.nombre(azar.menorQue(n), nombre);
+            nombre.insert(0, comun);
+            long long a0 = asignacionesTotales;
+            double t0 = nanosegundosActuales();
+            const Miembro* m = arbol.buscarMiembro(nombre);
+            acierto.agregar(nanosegundosActuales() - t0, a0);
+            acierto.contarComparaciones(arbol.metricasUltimaOperacion());
+            if (m != NULL) encontrados++;
+        }
+        if (encontrados != consultas) fallo("buscar_prefijo_comun", n, consultas, encontrados);
+        reporte.escribir(acierto);
+    }
+
+    /**
+     * Mide todas las operaciones sobre un arbol de n miembros
+     * (el arbol se construye insertando y se vacia eliminando)
+     */
+    void medir(long n) {
+        medirEmplazamiento(n);
+        medirPrefijoComun(n);
+
+        ArbolGenealogico arbol;
+        DatosMiembro d;
+        string nombre;
+
+        fprintf(stderr, "[%ld] insertar\n", n);
+        Medicion insertar("insertar", n);
+        insertar.muestras.reserve(n);
+        long insertados = 0;
+        for (long i = 0; i < n; i++) {
+            generador.miembro(i, d);
+            long long a0 = asignacionesTotales;
+            double t0 = nanosegundosActuales();
+            bool ok = arbol.insertarMiembroAVL(d.nombre, d.edad, d.genero,
+                                               d.relacionFamiliar, d.ocupacion, d.lugarNacimiento);
+            insertar.agregar(nanosegundosActuales() - t0, a0);
+            insertar.contarComparaciones(arbol.metricasUltimaOperacion());
+            if (ok) insertados++;
+        }
+        if (insertados != n) fallo("insertar", n, n, insertados);
+        reporte.escribir(insertar);
+        insertar.muestras.clear();
+
+        Medicion repetido("insertar_repetido", n);
+        long rechazados = 0;
+        for (long q = 0; q < consultas; q++) {
+            generador.miembro(azar.menorQue(n), d);
+            long long a0 = asignacionesTotales;
+            double t0 = nanosegundosActuales();
+            bool ok = arbol.insertarMiembroAVL(d.nombre, d.edad, d.genero,
+                                               d.relacionFamiliar, d.ocupacion, d.lugarNacimiento);
+            repetido.agregar(nanosegundosActuales() - t0, a0);
+            repetido.contarComparaciones(arbol.metricasUltimaOperacion());
+            if (!ok) rechazados++;
+        }
+        if (rechazados != consultas) fallo("insertar_repetido", n, consultas, rechazados);
+        reporte.escribir(repetido);
+
+        fprintf(stderr, "[%ld] buscar\n", n);
+        Medicion acierto("buscar_acierto", n), ausente("buscar_fallo", n);
+        long encontrados = 0, falsos = 0;
+        for (long q = 0; q < consultas; q++) {
+            generador.nombre(azar.menorQue(n), nombre);
+            long long a0 = asignacionesTotales;
+            double t0 = nanosegundosActuales();
+            const Miembro* m = arbol.buscarMiembro(nombre);
+            acierto.agregar(nanosegundosActuales() - t0, a0);
+            acierto.contarComparaciones(arbol.metricasUltimaOperacion());
+            if (m != NULL) encontrados++;
+        }
+        for (long q = 0; q < consultas; q++) {
+            generador.nombre(n + azar.menorQue(n), nombre); // Nunca insertado
+            long long a0 = asignacionesTotales;
+            double t0 = nanosegundosActuales();
+            const Miembro* m = arbol.buscarMiembro(nombre);
+            ausente.agregar(nanosegundosActuales() - t0, a0);
+            ausente.contarComparaciones(arbol.metricasUltimaOperacion());
+            if (m != NULL) falsos++;
+        }
+        if (encontrados != consultas) fallo("buscar_acierto", n, consultas, encontrados);
+        if (falsos != 0) fallo("buscar_fallo", n, 0, falsos);
+        reporte.escribir(acierto);
+        reporte.escribir(ausente);
+        medirCongelado(arbol, n);
+
+        fprintf(stderr, "[%ld] modificar\n", n);
+        Medicion modificar("modificar", n);
+        long modificados = 0;
+        for (long q = 0; q < consultas; q++) {
+            long i = azar.menorQue(n);
+            generador.nombre(i, nombre);
+            generador.miembro(azar.menorQue(n), d); // Valores nuevos
+            long long a0 = asignacionesTotales;
+            double t0 = nanosegundosActuales();
+            bool ok = arbol.modificarMiembro(nombre, d.edad, d.ocupacion, d.relacionFamiliar);
+            modificar.agregar(nanosegundosActuales() - t0, a0);
+            modificar.contarComparaciones(arbol.metricasUltimaOperacion());
+            if (ok) modificados++;
+        }
+        if (modificados != consultas) fallo("modificar", n, consultas, modificados);
+        reporte.escribir(modificar);
+
+        fprintf(stderr, "[%ld] recorridos\n", n);
+        medirRecorrido(arbol, n, 0, "preorden");
+        medirRecorrido(arbol, n, 1, "inorden");
+        medirRecorrido(arbol, n, 2, "postorden");
+        medirRecorrido(arbol, n, 3, "niveles");
+
+        fprintf(stderr, "[%ld] estadisticas y diagramas\n", n);
+        Medicion estadisticas("estadisticas_avanzadas", n);
+        while (seguirRepitiendo(estadisticas)) {
+            long long a0 = asignacionesTotales;
+            double t0 = nanosegundosActuales();
+            arbol.mostrarEstadisticasAvanzadas();
+            fflush(stdout);
+            estadisticas.agregar(nanosegundosActuales() - t0, a0);
+        }
+        reporte.escribir(estadisticas);
+
+        Medicion diagrama("diagrama", n), completo("diagrama_maximo", n), region("diagrama_region", n);
+        while (seguirRepitiendo(diagrama)) {
+            long long a0 = asignacionesTotales;
+            double t0 = nanosegundosActuales();
+            arbol.mostrarDiagramaArbol();
+            fflush(stdout);
+            diagrama.agregar(nanosegundosActuales() - t0, a0);
+        }
+        while (seguirRepitiendo(completo)) {
+            long long a0 = asignacionesTotales;
+            double t0 = nanosegundosActuales();
+            arbol.mostrarDiagramaArbol("", NIVELES_DIAGRAMA_MAXIMO);
+            fflush(stdout);
+            completo.agregar(nanosegundosActuales() - t0, a0);
+        }
+        while (seguirRepitiendo(region)) {
+            generador.nombre(azar.menorQue(n), nombre);
+            long long a0 = asignacionesTotales;
+            double t0 = nanosegundosActuales();
+            bool ok = arbol.mostrarDiagramaArbol(nombre, 0);
+            fflush(stdout);
+            region.agregar(nanosegundosActuales() - t0, a0);
+            if (!ok) fallo("diagrama_region", n, 1, 0);
+        }
+        reporte.escribir(diagrama);
+        reporte.escribir(completo);
+        reporte.escribir(region);
+
+        // Eliminar todos en un orden al azar (Fisher-Yates con el
+        // generador propio); el arbol debe quedar vacio
+        fprintf(stderr, "[%ld] eliminar\n", n);
+        vector<unsigned int> orden(n);
+        for (long i = 0; i < n; i++) orden[i] = (unsigned int)i;
+        for (long i = n - 1; i > 0; i--) swap(orden[i], orden[azar.menorQue(i + 1)]);
+        Medicion eliminar("eliminar", n);
+        eliminar.muestras.reserve(n);
+        long eliminados = 0;
+        for (long i = 0; i < n; i++) {
+            generador.nombre(orden[i], nombre);
+            long long a0 = asignacionesTotales;
+            double t0 = nanosegundosActuales();
+            bool ok = arbol.eliminarMiembro(nombre);
+            eliminar.agregar(nanosegundosActuales() - t0, a0);
+            eliminar.contarComparaciones(arbol.metricasUltimaOperacion());
+            if (ok) eliminados++;
+        }
+        if (eliminados != n || arbol.totalMiembros() != 0) fallo("eliminar", n, n, eliminados);
+        reporte.escribir(eliminar);
+    }
+};
+
+/**
+ * Lee un entero positivo de un argumento
+ * @return false si no es un numero valido
+ */
+bool leerArgumentoPositivo(const char* texto, long long &valor) {
+    char* fin = NULL;
+    valor = strtoll(texto, &fin, 10);
+    return fin != texto && *fin == '\0' && valor > 0;
+}
+
+int main(int argc, char* argv[]) {
+    int desde = 3, hasta = 6;
+    long long consultas = 100000, repeticiones = 5, semilla = 20240601;
+    bool json = true;
+    string rutaSalida, etiqueta;
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool valido = i + 1 < argc;
+        if (valido && arg == "--tamanos") {
+            string valor = argv[++i];
+            size_t guion = valor.find('-');
+            desde = atoi(valor.c_str());
+            hasta = guion == string::npos ? desde : atoi(valor.c_str() + guion + 1);
+            valido = desde >= 1 && hasta >= desde && hasta <= 7;
+        } else if (valido && arg == "--consultas") {
+            valido = leerArgumentoPositivo(argv[++i], consultas);
+        } else if (valido && arg == "--repeticiones") {
+            valido = leerArgumentoPositivo(argv[++i], repeticiones);
+        } else if (valido && arg == "--semilla") {
+            valido = leerArgumentoPositivo(argv[++i], semilla);
+        } else if (valido && arg == "--formato") {
+            string valor = argv[++i];
+            json = valor == "json";
+            valido = json || valor == "csv";
+        } else if (valido && arg == "--salida") {
+            rutaSalida = argv[++i];
+        } else if (valido && arg == "--etiqueta") {
+            etiqueta = argv[++i];
+        } else {
+            valido = false;
+        }
+        if (!valido) {
+            fprintf(stderr, "Uso: %s [--tamanos 3-6] [--consultas N] [--repeticiones N]\n"
+                            "       [--semilla S] [--formato json|csv] [--salida archivo]\n"
+                            "       [--etiqueta texto]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    int original = silenciarSalidaEstandar();
+    if (original < 0) {
+        fprintf(stderr, "ERROR: no se pudo redirigir la salida estandar\n");
+        return 1;
+    }
+    FILE* destino = rutaSalida.empty() ? abrirDescriptor(original) : fopen(rutaSalida.c_str(), "w");
+    if (destino == NULL) {
+        fprintf(stderr, "ERROR: no se pudo abrir %s\n",
+                rutaSalida.empty() ? "la salida estandar" : rutaSalida.c_str());
+        return 1;
+    }
+
+    int errores = 0;
+    {
+        GeneradorGenealogia generador((unsigned long long)semilla);
+        ReporteBenchmark reporte(destino, json, etiqueta, (unsigned long long)semilla, (long)consultas);
+        BancoPruebas banco(generador, reporte, (long)consultas, (long)repeticiones,
+                           (unsigned long long)semilla);
+        long n = 1;
+        for (int e = 0; e < desde; e++) n *= 10;
+        for (int e = desde; e <= hasta; e++, n *= 10) banco.medir(n);
+        errores = banco.totalErrores();
+    }
+    fclose(destino);
+    return errores == 0 ? 0 : 2;
+}
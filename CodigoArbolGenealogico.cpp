@@ -1,9 +1,31 @@
 #include <iostream>
 #include <string>
 #include <queue>
+#include <deque>
 #include <vector>
+#include <map>
 #include <iomanip>
 #include <limits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <io.h>
+#include <sys/timeb.h>
+#else
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+#endif
 using namespace std;
 
 /* ==============================================================
@@ -16,1261 +38,7631 @@ using namespace std;
    - Estadisticas avanzadas y conteo por relaciones
    - Sistema de validaciones completo
    - Menu organizado con submenus
+   - Pool de nodos propio del arbol (sin new/delete por miembro)
+   - Insercion por movimiento (emplazarMiembro): el nodo se crea solo si
+     el nombre no existe y el nombre se mueve sin copiarse
+   - Carga masiva en O(n) a partir de datos ordenados
+   - Posiciones reutilizables: insertar/modificar/eliminar sin volver a buscar
+   - Motor AVL iterativo con pila de camino acotada y metricas por operacion
+   - Indice congelado (orden Eytzinger) para busquedas de solo lectura
+   - Estadistica de orden: rango, seleccion y recorridos paginados
+   - Busqueda por comienzo del nombre y por rango de nombres en
+     O(log n + k), en orden alfabetico
+   - Agregados de edad por subarbol: estadisticas en O(1) y por rango
+   - Indice secundario por relacion familiar (conteo y listado sin recorrer)
+   - Indice secundario por (edad, nombre): rango de edades, los mas
+     longevos y la mediana en O(log n + k)
+   - Linaje real (progenitor e hijos) separado del orden por nombre, con
+     recorrido de Euler y tabla dispersa: ancestro, ancestro comun y
+     distancia de parentesco en O(1)
+   - Tablas de simbolos: genero, relacion, ocupacion y lugar se guardan una vez
+   - Prefijo de 24 bytes de la clave en cada nodo: la mayoria de las
+     comparaciones se resuelven con enteros, sin leer el nombre
+   - Instantanea binaria versionada con suma de verificacion, cargada
+     con mmap al iniciar (arbol_genealogico.bin)
+   - Diario de operaciones con confirmacion en grupo y compactacion
+     (arbol_genealogico.wal): cada cambio sobrevive al cierre
+   - Modo por lotes (--lote): comandos desde archivo o entrada estandar,
+     sin menus ni pausas, con salida en bloques y operaciones por segundo
+   - Importacion CSV/JSONL en paralelo (archivo mapeado, validacion y
+     orden por hilos, una sola construccion balanceada, reporte de rechazos)
+   - Acceso concurrente (ArbolConcurrente): busquedas sin cerrojo
+     (contador de secuencia y liberacion de nodos por epocas), recorridos
+     con cerrojo compartido, escrituras con cerrojo exclusivo
+   - Motor paralelo de recorridos: filtros y reducciones por tramos del
+     arbol repartidos entre hilos, con resultados en el orden del recorrido
+   - Banco de pruebas aparte (BenchmarkArbolGenealogico.cpp): genealogia
+     sintetica determinista y latencias p50/p99 en JSON o CSV
    ============================================================== */
 
+/**
+ * 8 bytes de un nombre como entero big-endian (relleno con 0)
+ * Comparar dos prefijos como enteros da el mismo orden que comparar
+ * esos 8 caracteres del string
+ * @param nombre Nombre completo
+ * @param desde Primer byte tomado (0 = inicio del nombre)
+ * @return Prefijo de 64 bits
+ */
+unsigned long long prefijoClave(const string &nombre, size_t desde = 0) {
+    unsigned long long prefijo = 0;
+    for (size_t i = desde; i < desde + 8; i++) {
+        prefijo <<= 8;
+        if (i < nombre.size()) prefijo |= (unsigned char)nombre[i];
+    }
+    return prefijo;
+}
+
+/* ---------------------------
+   ESTRUCTURA: ClaveBusqueda
+   Nombre buscado con sus tres prefijos calculados una sola vez
+   --------------------------- */
+struct ClaveBusqueda {
+    const string &nombre;
+    unsigned long long alto;     // Bytes 0..7
+    unsigned long long bajo;     // Bytes 8..15
+    unsigned long long resto;    // Bytes 16..23
+
+    explicit ClaveBusqueda(const string &_nombre)
+        : nombre(_nombre), alto(prefijoClave(_nombre)), bajo(prefijoClave(_nombre, 8)),
+          resto(prefijoClave(_nombre, 16)) {}
+};
+
 /* ---------------------------
    ESTRUCTURA DEL NODO: Miembro
    Representa a un miembro de la familia con sus atributos
    --------------------------- */
 struct Miembro {
+    // Lo que se lee al bajar por el arbol va primero: con el pool
+    // (ranuras alineadas a 64 bytes) ocupa una sola linea de cache
+    unsigned long long prefijo; // Bytes 0..7 del nombre (big-endian)
+    unsigned long long prefijo2;// Bytes 8..15 del nombre
+    unsigned long long prefijo3;// Bytes 16..23 del nombre
+    Miembro* izquierdo;      // Puntero al hijo izquierdo
+    Miembro* derecho;        // Puntero al hijo derecho
     string nombre;           // Nombre completo (clave de busqueda)
+
     int edad;                // Edad en anos
-    string genero;           // "Masculino" o "Femenino"
-    string relacionFamiliar; // Tipo de relacion (ej: "Sapa Inca", "Hijo")
-    string ocupacion;        // Profesion u oficio
-    string lugarNacimiento;  // Lugar de origen
 
-    Miembro* izquierdo;      // Puntero al hijo izquierdo
-    Miembro* derecho;        // Puntero al hijo derecho
+    // Atributos repetidos: id en la tabla de simbolos del arbol
+    unsigned int idGenero;   // "Masculino" o "Femenino"
+    unsigned int idRelacion; // Tipo de relacion (ej: "Sapa Inca", "Hijo")
+    unsigned int idOcupacion;// Profesion u oficio
+    unsigned int idLugar;    // Lugar de origen
 
     int altura;              // Altura del nodo (para balanceo AVL)
+    int tamano;              // Miembros en el subarbol (incluye este nodo)
+    long long sumaEdades;    // Suma de edades del subarbol
+    int edadMinima;          // Menor edad del subarbol
+    int edadMaxima;          // Mayor edad del subarbol
+    int posicionRelacion;    // Posicion dentro del indice de su relacion
+
+    // Indice secundario por (edad, nombre): un segundo AVL sobre los
+    // mismos nodos, con su propio enlace, altura y tamano
+    Miembro* edadIzquierdo;
+    Miembro* edadDerecho;
+    int edadAltura;
+    int edadTamano;
+
+    // Linaje real (independiente del orden por nombre): un progenitor y
+    // la lista de hijos como primer hijo + siguiente hermano
+    Miembro* progenitor;
+    Miembro* primerHijo;
+    Miembro* siguienteHermano;
+    int linajeEntrada;       // Primera posicion en el recorrido de Euler (-1 = fuera)
+    int linajeSalida;        // Ultima posicion en el recorrido de Euler
+    int linajeProfundidad;   // Generaciones desde la raiz de su linaje
 
     /**
      * Constructor del nodo Miembro
-     * Inicializa todos los atributos y punteros
+     * Inicializa todos los atributos y punteros. El nombre se construye
+     * directamente como copia (sin crear un string vacio y asignarlo)
      */
     Miembro(const string &_nombre, int _edad,
-            const string &_genero, const string &_relacion,
-            const string &_ocupacion, const string &_lugar)
+            unsigned int _genero, unsigned int _relacion,
+            unsigned int _ocupacion, unsigned int _lugar)
+        : prefijo(prefijoClave(_nombre)), prefijo2(prefijoClave(_nombre, 8)),
+          prefijo3(prefijoClave(_nombre, 16)), nombre(_nombre), edad(_edad), idGenero(_genero), idRelacion(_relacion),
+          idOcupacion(_ocupacion), idLugar(_lugar)
     {
-        nombre = _nombre;
-        edad = _edad;
-        genero = _genero;
-        relacionFamiliar = _relacion;
-        ocupacion = _ocupacion;
-        lugarNacimiento = _lugar;
-
         izquierdo = NULL;
         derecho   = NULL;
         altura = 1;
+        tamano = 1;
+        sumaEdades = _edad;
+        edadMinima = _edad;
+        edadMaxima = _edad;
+        posicionRelacion = -1;
+
+        edadIzquierdo = NULL;
+        edadDerecho = NULL;
+        edadAltura = 1;
+        edadTamano = 1;
+
+        progenitor = NULL;
+        primerHijo = NULL;
+        siguienteHermano = NULL;
+        linajeEntrada = -1;
+        linajeSalida = -1;
+        linajeProfundidad = 0;
     }
 };
 
+/**
+ * Compara un nombre con la clave de un nodo en tres vias
+ * Los 24 bytes de prefijo cacheados deciden casi siempre; el texto solo
+ * se lee cuando empatan, y entonces desde el byte 24. Con 16 bytes
+ * una de cada cuatro comparaciones leia el texto en nombres con
+ * apellidos repetidos (y el texto no esta junto al nodo)
+ * @param clave Nombre buscado con sus prefijos
+ * @param m Nodo a comparar
+ * @param completas Cuenta las comparaciones que tuvieron que leer el texto
+ * @return Negativo, 0 o positivo, igual que string::compare
+ */
+inline int compararClave(const ClaveBusqueda &clave, const Miembro* m, int &completas) {
+    if (clave.alto != m->prefijo) return clave.alto < m->prefijo ? -1 : 1;
+    if (clave.bajo != m->prefijo2) return clave.bajo < m->prefijo2 ? -1 : 1;
+    if (clave.resto != m->prefijo3) return clave.resto < m->prefijo3 ? -1 : 1;
+    completas++;
+    if (clave.nombre.size() >= 24 && m->nombre.size() >= 24)
+        return clave.nombre.compare(24, string::npos, m->nombre, 24, string::npos);
+    return clave.nombre.compare(m->nombre); // Nombre corto: el relleno con 0 es ambiguo
+}
+
 /* ---------------------------
-   CLASE: ArbolGenealogico
-   Implementa un arbol AVL para gestionar miembros familiares
+   ESTRUCTURA: DatosMiembro
+   Registro plano con los datos de un miembro, usado para
+   cargas masivas antes de crear los nodos del arbol
    --------------------------- */
-class ArbolGenealogico {
-private:
-    Miembro* raiz;                  // Nodo raiz del arbol
-    vector<string> historial;       // Registro de operaciones
+struct DatosMiembro {
+    string nombre;
+    int edad;
+    string genero;
+    string relacionFamiliar;
+    string ocupacion;
+    string lugarNacimiento;
+
+    DatosMiembro() : edad(0) {}
+
+    DatosMiembro(const string &_nombre, int _edad,
+                 const string &_genero, const string &_relacion,
+                 const string &_ocupacion, const string &_lugar)
+        : nombre(_nombre), edad(_edad), genero(_genero),
+          relacionFamiliar(_relacion), ocupacion(_ocupacion),
+          lugarNacimiento(_lugar) {}
+};
+
+/* ---------------------------
+   ESTRUCTURA: PosicionMiembro
+   Resultado de localizar un nombre en el arbol: el nodo (si existe)
+   y el camino desde la raiz, para que insertar, modificar o eliminar
+   reutilicen la busqueda sin volver a comparar nombres
+   --------------------------- */
+/**
+ * Limite de niveles del camino. Un AVL de altura 64 necesitaria mas de
+ * 2^44 nodos, asi que la ruta cabe en 64 bits y la pila es de tamano fijo.
+ */
+const int ALTURA_MAXIMA = 64;
+
+struct PosicionMiembro {
+    Miembro* nodo;               // Miembro encontrado o NULL si no existe
+    unsigned long long ruta;     // Bit i = 1: en el nivel i se bajo a la derecha
+    int profundidad;             // Niveles bajados desde la raiz
+    unsigned long version;       // Version estructural del arbol al localizar
+
+    PosicionMiembro() : nodo(NULL), ruta(0), profundidad(0), version(0) {}
+};
+
+/* ---------------------------
+   ESTRUCTURA: MetricasOperacion
+   Trabajo realizado por la ultima operacion del arbol
+   --------------------------- */
+struct MetricasOperacion {
+    int comparaciones;           // Comparaciones de nombres
+    int comparacionesCompletas;  // De ellas, las que leyeron el texto
+    int rotaciones;              // Rotaciones simples (una doble cuenta 2)
+
+    MetricasOperacion() : comparaciones(0), comparacionesCompletas(0), rotaciones(0) {}
+};
+
+/* ---------------------------
+   ESTRUCTURA: ResumenEdades
+   Cantidad, suma, minimo y maximo de edades de un conjunto de miembros
+   --------------------------- */
+struct ResumenEdades {
+    int cantidad;
+    long long suma;
+    int minima;
+    int maxima;
+
+    ResumenEdades() : cantidad(0), suma(0), minima(0), maxima(0) {}
 
     /**
-     * Busca un miembro por nombre de forma recursiva
-     * @param nodo Nodo actual en la recursion
-     * @param nombre Nombre a buscar
-     * @return Puntero al miembro encontrado o NULL
+     * Combina otro resumen con este
      */
-    Miembro* buscarRec(Miembro* nodo, const string &nombre) {
-        if (nodo == NULL) return NULL;
-        if (nombre == nodo->nombre) return nodo;
-        if (nombre < nodo->nombre) return buscarRec(nodo->izquierdo, nombre);
-        return buscarRec(nodo->derecho, nombre);
+    void agregar(const ResumenEdades &otro) {
+        if (otro.cantidad == 0) return;
+        if (cantidad == 0 || otro.minima < minima) minima = otro.minima;
+        if (cantidad == 0 || otro.maxima > maxima) maxima = otro.maxima;
+        cantidad += otro.cantidad;
+        suma += otro.suma;
     }
 
     /**
-     * Recorrido Preorden: Raiz -> Izquierdo -> Derecho
-     * Util para mostrar jerarquia de ancestros a descendientes
+     * Agrega una sola edad
      */
-    void preordenRec(Miembro* nodo, int &contador) {
-        if (nodo == NULL) return;
-        imprimirLineaEnumerada(nodo, contador);
-        contador++;
-        preordenRec(nodo->izquierdo, contador);
-        preordenRec(nodo->derecho, contador);
+    void agregarEdad(int edad) {
+        if (cantidad == 0 || edad < minima) minima = edad;
+        if (cantidad == 0 || edad > maxima) maxima = edad;
+        cantidad++;
+        suma += edad;
     }
 
     /**
-     * Recorrido Inorden: Izquierdo -> Raiz -> Derecho
-     * Muestra los miembros en orden alfabetico
+     * @return Edad promedio (0 si no hay miembros)
      */
-    void inordenRec(Miembro* nodo, int &contador) {
-        if (nodo == NULL) return;
-        inordenRec(nodo->izquierdo, contador);
-        imprimirLineaEnumerada(nodo, contador);
-        contador++;
-        inordenRec(nodo->derecho, contador);
+    double promedio() const {
+        return cantidad == 0 ? 0.0 : (double)suma / cantidad;
     }
+};
+
+/**
+ * Orden de los registros por nombre (clave del arbol)
+ */
+bool menorPorNombre(const DatosMiembro &a, const DatosMiembro &b) {
+    return a.nombre < b.nombre;
+}
+
+/* ---------------------------
+   CLASE: PoolNodos
+   Asignador por bloques (slab) para nodos del arbol.
+   Entrega ranuras contiguas, reutiliza las liberadas mediante
+   una lista libre y devuelve toda la memoria en O(bloques).
+   No construye ni destruye objetos: eso lo hace el dueno.
+   Las ranuras miden un multiplo de 64 bytes y cada bloque empieza en
+   una linea de cache: los primeros 64 bytes de cada objeto (en
+   Miembro, lo que se lee al bajar por el arbol) caen en una sola linea.
+   Con -DARBOL_NODOS_HEAP cada ranura es un new/delete propio (el
+   camino anterior al pool), solo para compararlos en el benchmark.
+   --------------------------- */
+template <class T>
+class PoolNodos {
+private:
+    vector<char*> bloques;          // Bloques reservados (tal como los dio new)
+    char* inicioBloque;             // Primera ranura del ultimo bloque (alineada)
+    char* libre;                    // Cabeza de la lista libre
+    size_t usadasEnBloque;          // Ranuras entregadas del ultimo bloque
+    size_t capacidadBloque;         // Ranuras del ultimo bloque
+    size_t enUso;                   // Ranuras entregadas y no liberadas
+
+    static const size_t BLOQUE_INICIAL = 64;
+    static const size_t BLOQUE_MAXIMO = 65536;
+    static const size_t LINEA_CACHE = 64;
 
     /**
-     * Recorrido Postorden: Izquierdo -> Derecho -> Raiz
-     * Util para mostrar de descendientes hacia ancestros
+     * Tamano de cada ranura: sizeof(T) redondeado a lineas de cache
+     * (Miembro: 184 -> 192 bytes, lo mismo que ocupaba con malloc)
      */
-    void postordenRec(Miembro* nodo, int &contador) {
-        if (nodo == NULL) return;
-        postordenRec(nodo->izquierdo, contador);
-        postordenRec(nodo->derecho, contador);
-        imprimirLineaEnumerada(nodo, contador);
-        contador++;
+    static size_t tamanoRanura() {
+        return (sizeof(T) + LINEA_CACHE - 1) / LINEA_CACHE * LINEA_CACHE;
     }
 
     /**
-     * Calcula la profundidad maxima del arbol
-     * @param nodo Nodo actual
-     * @return Profundidad desde el nodo hasta la hoja mas lejana
+     * Reserva un bloque nuevo del doble del anterior (hasta BLOQUE_MAXIMO)
      */
-    int profundidadRec(Miembro* nodo) {
-        if (nodo == NULL) return 0;
-        int iz = profundidadRec(nodo->izquierdo);
-        int dr = profundidadRec(nodo->derecho);
-        return 1 + ((iz > dr) ? iz : dr);
+    void nuevoBloque() {
+        size_t capacidad = bloques.empty() ? BLOQUE_INICIAL : capacidadBloque * 2;
+        if (capacidad > BLOQUE_MAXIMO) capacidad = BLOQUE_MAXIMO;
+        char* bloque = static_cast<char*>(::operator new(capacidad * tamanoRanura() + LINEA_CACHE - 1));
+        bloques.push_back(bloque);
+        size_t desfase = (size_t)bloque % LINEA_CACHE;
+        inicioBloque = desfase == 0 ? bloque : bloque + (LINEA_CACHE - desfase);
+        capacidadBloque = capacidad;
+        usadasEnBloque = 0;
+    }
+
+    // No copiable: los bloques tienen un unico dueno
+    PoolNodos(const PoolNodos&);
+    PoolNodos& operator=(const PoolNodos&);
+
+public:
+    PoolNodos() : inicioBloque(NULL), libre(NULL), usadasEnBloque(0), capacidadBloque(0), enUso(0) {}
+
+    ~PoolNodos() {
+        liberarTodo();
     }
 
     /**
-     * Cuenta el total de nodos en el arbol
-     * @param nodo Nodo actual
-     * @return Cantidad de nodos desde el nodo actual
+     * Entrega memoria sin inicializar para un objeto T
+     * @return Ranura lista para placement new
      */
-    int contarRec(Miembro* nodo) {
-        if (nodo == NULL) return 0;
-        return 1 + contarRec(nodo->izquierdo) + contarRec(nodo->derecho);
+    void* reservar() {
+        enUso++;
+#ifdef ARBOL_NODOS_HEAP
+        return ::operator new(sizeof(T));
+#else
+        if (libre != NULL) {
+            char* ranura = libre;
+            libre = *reinterpret_cast<char**>(ranura);
+            return ranura;
+        }
+        if (bloques.empty() || usadasEnBloque == capacidadBloque) nuevoBloque();
+        return inicioBloque + (usadasEnBloque++) * tamanoRanura();
+#endif
     }
 
     /**
-     * Imprime la cabecera de las tablas de miembros
+     * Devuelve una ranura a la lista libre (el objeto ya fue destruido)
+     * @param p Ranura entregada antes por reservar()
      */
-    void imprimirCabeceraTabla() {
-        cout << "\n-----------------------------------------------------------------\n";
-        cout << left << setw(4)  << "No."
-             << left << setw(22) << "Nombre"
-             << left << setw(22) << "Relacion"
-             << left << setw(8)  << "Edad"
-             << left << setw(20) << "Ocupacion"
-             << "\n";
-        cout << "-----------------------------------------------------------------\n";
+    void liberar(void* p) {
+        if (p == NULL) return;
+        enUso--;
+#ifdef ARBOL_NODOS_HEAP
+        ::operator delete(p);
+#else
+        char* ranura = static_cast<char*>(p);
+        *reinterpret_cast<char**>(ranura) = libre;
+        libre = ranura;
+#endif
     }
 
     /**
-     * Imprime una fila con los datos de un miembro
-     * @param m Puntero al miembro
-     * @param num Numero de fila
+     * Ranura cuyo objeto ya se destruyo y que liberarTodo devolvera con
+     * su bloque: no hace falta encadenarla a la lista libre
      */
-    void imprimirLineaEnumerada(Miembro* m, int num) {
-        if (m == NULL) return;
-        cout << left << setw(4)  << (toStringNum(num) + ".")
-             << left << setw(22) << m->nombre
-             << left << setw(22) << m->relacionFamiliar
-             << left << setw(8)  << (toStringNum(m->edad) + " anos")
-             << left << setw(20) << m->ocupacion
-             << "\n";
+    void descartar(void* p) {
+#ifdef ARBOL_NODOS_HEAP
+        liberar(p);
+#else
+        (void)p;
+#endif
     }
 
     /**
-     * Convierte un entero a string (compatible con C++98)
-     * @param x Numero a convertir
-     * @return String con el numero
+     * Libera todos los bloques de una vez, O(bloques)
+     * Los objetos deben haberse destruido antes si lo necesitan
      */
-    string toStringNum(int x) {
-        char buffer[20];
-        sprintf(buffer, "%d", x);
-        return string(buffer);
+    void liberarTodo() {
+        for (size_t i = 0; i < bloques.size(); i++)
+            ::operator delete(bloques[i]);
+        bloques.clear();
+        inicioBloque = NULL;
+        libre = NULL;
+        usadasEnBloque = 0;
+        capacidadBloque = 0;
+        enUso = 0;
     }
 
-    /* ========== FUNCIONES AVL ========== */
-
     /**
-     * Obtiene la altura de un nodo
-     * @param nodo Nodo a consultar
-     * @return Altura del nodo (0 si es NULL)
+     * @return Cantidad de ranuras ocupadas
      */
-    int obtenerAltura(Miembro* nodo) {
-        if (nodo == NULL) return 0;
-        return nodo->altura;
-    }
+    size_t ocupadas() const { return enUso; }
 
     /**
-     * Calcula el factor de balance de un nodo
-     * Balance = Altura(izquierdo) - Altura(derecho)
-     * @param nodo Nodo a evaluar
-     * @return Factor de balance (-1, 0, 1 en arbol balanceado)
+     * @return Cantidad de bloques reservados
      */
-    int obtenerBalance(Miembro* nodo) {
-        if (nodo == NULL) return 0;
-        return obtenerAltura(nodo->izquierdo) - obtenerAltura(nodo->derecho);
-    }
+    size_t cantidadBloques() const { return bloques.size(); }
 
     /**
-     * Actualiza la altura de un nodo basandose en sus hijos
-     * @param nodo Nodo a actualizar
+     * @return Bytes reservados en todos los bloques
      */
-    void actualizarAltura(Miembro* nodo) {
-        if (nodo == NULL) return;
-        int altIzq = obtenerAltura(nodo->izquierdo);
-        int altDer = obtenerAltura(nodo->derecho);
-        nodo->altura = 1 + (altIzq > altDer ? altIzq : altDer);
+    size_t bytesReservados() const {
+        size_t total = 0, capacidad = BLOQUE_INICIAL;
+        for (size_t i = 0; i < bloques.size(); i++) {
+            total += capacidad * tamanoRanura() + LINEA_CACHE - 1;
+            if (capacidad < BLOQUE_MAXIMO) capacidad *= 2;
+        }
+        return total;
     }
+};
+
+/**
+ * Bytes que un string ocupa fuera de su propio objeto
+ * Los textos cortos viven dentro del objeto (optimizacion de strings
+ * pequenos) y no usan heap
+ * @param s String a medir
+ * @return Bytes en el heap (0 si el texto esta dentro del objeto)
+ */
+size_t bytesHeapString(const string &s) {
+    const char* objeto = reinterpret_cast<const char*>(&s);
+    const char* datos = s.data();
+    if (datos >= objeto && datos < objeto + sizeof(string)) return 0;
+    return s.capacity() + 1;
+}
+
+/**
+ * Barrera de memoria completa: lo escrito antes queda visible para los
+ * demas hilos antes que lo escrito despues (tampoco lo reordena el
+ * compilador). La usan los escritores que publican datos que un lector
+ * sin cerrojo puede estar leyendo (ver ArbolConcurrente)
+ */
+inline void barreraMemoria() {
+#ifdef _WIN32
+    MemoryBarrier();
+#else
+    __sync_synchronize();
+#endif
+}
+
+/* ---------------------------
+   CLASE: TablaSimbolos
+   Guarda una sola vez cada valor distinto de un atributo de baja
+   cardinalidad; los nodos guardan solo su id (entero compacto).
+   Los textos van por trozos que nunca se mueven y el directorio de
+   trozos, al crecer, se reemplaza sin liberar el anterior (hasta
+   limpiar()): un lector sin cerrojo puede resolver un id mientras el
+   escritor agrega simbolos
+   --------------------------- */
+class TablaSimbolos {
+private:
+    static const unsigned int BITS_TROZO = 6;               // 64 textos por trozo
+    static const unsigned int TEXTOS_POR_TROZO = 1u << BITS_TROZO;
+    static const size_t DIRECTORIO_INICIAL = 4;
+
+    string** volatile directorio;       // Trozo de cada grupo de ids
+    size_t capacidadDirectorio;         // Trozos que caben en el directorio
+    vector<string**> directorios;       // Todos los reservados (el ultimo es el vigente)
+    size_t total;                       // Cantidad de textos
+    map<string, unsigned int> ids;      // Id de cada texto
+
+    TablaSimbolos(const TablaSimbolos&);
+    TablaSimbolos& operator=(const TablaSimbolos&);
 
     /**
-     * Rotacion simple a la derecha (caso LL)
-     * Se usa cuando el subarbol izquierdo esta desbalanceado a la izquierda
-     * @param y Nodo desbalanceado
-     * @return Nueva raiz del subarbol
+     * Reserva el trozo numero k, agrandando el directorio si hace falta
      */
-    Miembro* rotacionDerecha(Miembro* y) {
-        Miembro* x = y->izquierdo;
-        Miembro* T2 = x->derecho;
+    void agregarTrozo(size_t k) {
+        if (k == capacidadDirectorio) {
+            size_t capacidad = capacidadDirectorio == 0 ? DIRECTORIO_INICIAL : 2 * capacidadDirectorio;
+            string** nuevo = new string*[capacidad];
+            for (size_t i = 0; i < k; i++) nuevo[i] = directorio[i];
+            directorios.push_back(nuevo);
+            barreraMemoria();
+            directorio = nuevo;
+            capacidadDirectorio = capacidad;
+        }
+        directorio[k] = new string[TEXTOS_POR_TROZO];
+    }
 
-        x->derecho = y;
-        y->izquierdo = T2;
+public:
+    TablaSimbolos() : directorio(NULL), capacidadDirectorio(0), total(0) {}
 
-        actualizarAltura(y);
-        actualizarAltura(x);
+    ~TablaSimbolos() {
+        limpiar();
+    }
 
-        return x;
+    /**
+     * Devuelve el id de un texto, agregandolo si es nuevo
+     * @param texto Valor del atributo
+     * @return Id estable mientras la tabla exista
+     */
+    unsigned int internar(const string &texto) {
+        map<string, unsigned int>::iterator it = ids.lower_bound(texto);
+        if (it != ids.end() && it->first == texto) return it->second;
+        unsigned int id = (unsigned int)total;
+        if ((id & (TEXTOS_POR_TROZO - 1)) == 0) agregarTrozo(id >> BITS_TROZO);
+        directorio[id >> BITS_TROZO][id & (TEXTOS_POR_TROZO - 1)] = texto;
+        // El texto queda visible antes que cualquier nodo con este id
+        barreraMemoria();
+        total++;
+        ids.insert(it, make_pair(texto, id));
+        return id;
     }
 
     /**
-     * Rotacion simple a la izquierda (caso RR)
-     * Se usa cuando el subarbol derecho esta desbalanceado a la derecha
-     * @param x Nodo desbalanceado
-     * @return Nueva raiz del subarbol
+     * Busca el id de un texto sin agregarlo
+     * @return Id o -1 si el texto no esta en la tabla
      */
-    Miembro* rotacionIzquierda(Miembro* x) {
-        Miembro* y = x->derecho;
-        Miembro* T2 = y->izquierdo;
+    int buscar(const string &texto) const {
+        map<string, unsigned int>::const_iterator it = ids.find(texto);
+        return it == ids.end() ? -1 : (int)it->second;
+    }
 
-        y->izquierdo = x;
-        x->derecho = T2;
+    /**
+     * @param id Id entregado por internar()
+     * @return Texto del simbolo
+     */
+    const string& texto(unsigned int id) const {
+        return directorio[id >> BITS_TROZO][id & (TEXTOS_POR_TROZO - 1)];
+    }
 
-        actualizarAltura(x);
-        actualizarAltura(y);
+    /**
+     * @return Cantidad de simbolos distintos
+     */
+    size_t cantidad() const { return total; }
 
-        return y;
+    /**
+     * @return Ids ordenados alfabeticamente por su texto
+     */
+    vector<unsigned int> idsOrdenados() const {
+        vector<unsigned int> salida;
+        salida.reserve(ids.size());
+        map<string, unsigned int>::const_iterator it;
+        for (it = ids.begin(); it != ids.end(); ++it) salida.push_back(it->second);
+        return salida;
     }
 
     /**
-     * Balancea un nodo aplicando las rotaciones necesarias
-     * Maneja los 4 casos: LL, RR, LR, RL
-     * @param nodo Nodo a balancear
-     * @return Nodo balanceado
+     * Bytes aproximados de la tabla: cada texto se guarda en su trozo
+     * y como clave del mapa (mas el nodo del mapa)
      */
-    Miembro* balancear(Miembro* nodo) {
-        if (nodo == NULL) return nodo;
+    size_t bytesUsados() const {
+        size_t trozos = (total + TEXTOS_POR_TROZO - 1) / TEXTOS_POR_TROZO;
+        size_t bytes = trozos * TEXTOS_POR_TROZO * sizeof(string);
+        for (size_t i = 0, capacidad = DIRECTORIO_INICIAL; i < directorios.size(); i++, capacidad *= 2)
+            bytes += capacidad * sizeof(string*);
+        for (unsigned int id = 0; id < total; id++) {
+            bytes += 2 * bytesHeapString(texto(id));
+            bytes += sizeof(string) + sizeof(unsigned int) + 4 * sizeof(void*);
+        }
+        return bytes;
+    }
 
-        actualizarAltura(nodo);
-        int balance = obtenerBalance(nodo);
+    /**
+     * Intercambia el contenido con otra tabla (sin copiar textos)
+     */
+    void intercambiar(TablaSimbolos &otra) {
+        string** d = directorio;
+        directorio = otra.directorio;
+        otra.directorio = d;
+        swap(capacidadDirectorio, otra.capacidadDirectorio);
+        directorios.swap(otra.directorios);
+        swap(total, otra.total);
+        ids.swap(otra.ids);
+    }
 
-        // Caso LL: Rotacion derecha
-        if (balance > 1 && obtenerBalance(nodo->izquierdo) >= 0)
-            return rotacionDerecha(nodo);
+    void limpiar() {
+        for (size_t k = 0; k * TEXTOS_POR_TROZO < total; k++) delete[] directorio[k];
+        for (size_t i = 0; i < directorios.size(); i++) delete[] directorios[i];
+        directorios.clear();
+        directorio = NULL;
+        capacidadDirectorio = 0;
+        total = 0;
+        ids.clear();
+    }
+};
 
-        // Caso LR: Rotacion izquierda-derecha
-        if (balance > 1 && obtenerBalance(nodo->izquierdo) < 0) {
-            nodo->izquierdo = rotacionIzquierda(nodo->izquierdo);
-            return rotacionDerecha(nodo);
-        }
+/* ---------------------------
+   CLASE: IndiceCongelado
+   Copia de solo lectura de las claves del arbol en orden Eytzinger
+   (el recorrido por niveles de un arbol completo guardado en un
+   arreglo: los hijos de k estan en 2k y 2k+1). Los prefijos de las
+   claves van juntos en un arreglo contiguo y los miembros en otro,
+   asi cada nivel de la busqueda toca 8 bytes en lugar de un nodo
+   disperso en el heap, y se puede precargar varios niveles adelante.
+   --------------------------- */
+class IndiceCongelado {
+private:
+    vector<unsigned long long> claves;  // Prefijos en orden Eytzinger (desde 1)
+    vector<Miembro*> cargas;            // Miembro de cada posicion
+    size_t cantidad;                    // Miembros indexados
+    unsigned long version;              // Version del arbol al congelar
+    bool activo;                        // true si hay un indice construido
 
-        // Caso RR: Rotacion izquierda
-        if (balance < -1 && obtenerBalance(nodo->derecho) <= 0)
-            return rotacionIzquierda(nodo);
+    /**
+     * Reparte los miembros ordenados en las posiciones Eytzinger
+     * El recorrido inorden del arbol implicito visita las posiciones
+     * en orden creciente de clave
+     * @param ordenados Miembros en orden alfabetico
+     * @param siguiente Proximo miembro a colocar
+     * @param k Posicion actual del arbol implicito
+     */
+    void llenar(const vector<Miembro*> &ordenados, size_t &siguiente, size_t k) {
+        if (k > cantidad) return;
+        llenar(ordenados, siguiente, 2 * k);
+        cargas[k] = ordenados[siguiente++];
+        claves[k] = cargas[k]->prefijo;
+        llenar(ordenados, siguiente, 2 * k + 1);
+    }
 
-        // Caso RL: Rotacion derecha-izquierda
-        if (balance < -1 && obtenerBalance(nodo->derecho) > 0) {
-            nodo->derecho = rotacionDerecha(nodo->derecho);
-            return rotacionIzquierda(nodo);
-        }
+public:
+    IndiceCongelado() : cantidad(0), version(0), activo(false) {}
 
-        return nodo;
+    /**
+     * Construye el indice a partir de los miembros en orden alfabetico
+     * @param ordenados Miembros ordenados por nombre
+     * @param versionArbol Version estructural del arbol en este momento
+     */
+    void construir(const vector<Miembro*> &ordenados, unsigned long versionArbol) {
+        cantidad = ordenados.size();
+        claves.assign(cantidad + 1, 0);
+        cargas.assign(cantidad + 1, (Miembro*)NULL);
+        size_t siguiente = 0;
+        llenar(ordenados, siguiente, 1);
+        version = versionArbol;
+        activo = true;
     }
 
     /**
-     * Inserta un nuevo miembro en el arbol con balanceo AVL
-     * @param nodo Nodo actual en la recursion
-     * @param nuevo Nuevo miembro a insertar
-     * @return Raiz del subarbol modificado
+     * Libera la memoria del indice
      */
-    Miembro* insertarRecAVL(Miembro* nodo, Miembro* nuevo) {
-        if (nodo == NULL) return nuevo;
+    void liberar() {
+        vector<unsigned long long>().swap(claves);
+        vector<Miembro*>().swap(cargas);
+        cantidad = 0;
+        activo = false;
+    }
 
-        if (nuevo->nombre < nodo->nombre)
-            nodo->izquierdo = insertarRecAVL(nodo->izquierdo, nuevo);
-        else if (nuevo->nombre > nodo->nombre)
-            nodo->derecho = insertarRecAVL(nodo->derecho, nuevo);
-        else
-            return nodo; // Nombre duplicado, no se inserta
+    /**
+     * @return true si hay un indice construido (vigente o no)
+     */
+    bool estaActivo() const { return activo; }
 
-        return balancear(nodo);
+    /**
+     * @param versionArbol Version estructural actual del arbol
+     * @return true si el indice corresponde a esa version
+     */
+    bool vigente(unsigned long versionArbol) const {
+        return activo && version == versionArbol;
     }
 
     /**
-     * Encuentra el nodo con el valor minimo (mas a la izquierda)
-     * @param nodo Nodo inicial
-     * @return Nodo con el valor minimo
+     * @return Cantidad de miembros indexados
      */
-    Miembro* encontrarMinimo(Miembro* nodo) {
-        while (nodo->izquierdo != NULL) 
-            nodo = nodo->izquierdo;
-        return nodo;
+    size_t tamano() const { return cantidad; }
+
+    /**
+     * @return Bytes ocupados por los arreglos del indice
+     */
+    size_t bytesUsados() const {
+        return claves.capacity() * sizeof(unsigned long long) +
+               cargas.capacity() * sizeof(Miembro*);
     }
 
     /**
-     * Elimina un miembro del arbol y rebalancea
-     * @param nodo Nodo actual
-     * @param nombre Nombre del miembro a eliminar
-     * @param eliminado Bandera que indica si se elimino
-     * @return Raiz del subarbol modificado
+     * Busca un nombre en el indice
+     * El descenso no tiene saltos condicionales por nivel y solo lee el
+     * nombre completo cuando los prefijos empatan
+     * @param nombre Nombre a buscar
+     * @param metricas Acumula las comparaciones de nombres hechas
+     * @return Miembro encontrado o NULL
      */
-    Miembro* eliminarRec(Miembro* nodo, const string &nombre, bool &eliminado) {
-        if (nodo == NULL) {
-            eliminado = false;
-            return NULL;
+    Miembro* buscar(const string &nombre, MetricasOperacion &metricas) const {
+        if (cantidad == 0) return NULL;
+        ClaveBusqueda clave(nombre);
+        const unsigned long long* base = &claves[0];
+        size_t k = 1;
+        while (k <= cantidad) {
+#if defined(__GNUC__)
+            // 16 prefijos = 2 lineas de cache: los descendientes 4 niveles
+            // abajo. En los ultimos niveles 16k pasa del final del arreglo:
+            // se acota a la ultima clave (una seleccion, no un salto)
+            size_t adelante = 16 * k;
+            __builtin_prefetch(base + (adelante <= cantidad ? adelante : cantidad));
+#endif
+            metricas.comparaciones++;
+            bool menor = base[k] < clave.alto ||
+                (base[k] == clave.alto &&
+                 compararClave(clave, cargas[k], metricas.comparacionesCompletas) > 0);
+            k = 2 * k + (menor ? 1 : 0);
         }
+        // Quitar los pasos a la derecha del final: queda la cota inferior
+        while (k & 1) k >>= 1;
+        k >>= 1;
+        if (k == 0) return NULL;
+        metricas.comparaciones++;
+        if (base[k] != clave.alto ||
+            compararClave(clave, cargas[k], metricas.comparacionesCompletas) != 0)
+            return NULL;
+        return cargas[k];
+    }
+};
 
-        if (nombre < nodo->nombre)
-            nodo->izquierdo = eliminarRec(nodo->izquierdo, nombre, eliminado);
-        else if (nombre > nodo->nombre)
-            nodo->derecho = eliminarRec(nodo->derecho, nombre, eliminado);
-        else {
-            eliminado = true;
-
-            // Caso 1: Nodo sin hijo derecho
-            if (nodo->izquierdo == NULL) {
-                Miembro* temp = nodo->derecho;
-                delete nodo;
-                return temp;
-            } 
-            // Caso 2: Nodo sin hijo izquierdo
-            else if (nodo->derecho == NULL) {
-                Miembro* temp = nodo->izquierdo;
-                delete nodo;
-                return temp;
-            }
+/**
+ * Posicion del bit 1 mas alto de un entero (x != 0)
+ * @param x Entero distinto de cero
+ * @return Indice del bit, 0..63
+ */
+inline int bitMasAlto(unsigned long long x) {
+#if defined(__GNUC__)
+    return 63 - __builtin_clzll(x);
+#else
+    int bit = 0;
+    for (int paso = 32; paso > 0; paso >>= 1)
+        if (x >> paso) { x >>= paso; bit += paso; }
+    return bit;
+#endif
+}
 
-            // Caso 3: Nodo con dos hijos
-            Miembro* sucesor = encontrarMinimo(nodo->derecho);
-            nodo->nombre = sucesor->nombre;
-            nodo->edad = sucesor->edad;
-            nodo->genero = sucesor->genero;
-            nodo->relacionFamiliar = sucesor->relacionFamiliar;
-            nodo->ocupacion = sucesor->ocupacion;
-            nodo->lugarNacimiento = sucesor->lugarNacimiento;
+/* ---------------------------
+   ESTRUCTURA: Parentesco
+   Relacion de A respecto de B segun su ancestro comun mas cercano.
+   Con gA y gB = generaciones de cada uno hasta ese ancestro, los
+   colaterales se nombran por grado (min(gA, gB) - 1) y por veces
+   removido (|gA - gB|): hermanos = grado 0, tio = grado 0 removido 1,
+   primos hermanos = grado 1, primos segundos = grado 2...
+   --------------------------- */
+enum TipoParentesco {
+    PARENTESCO_DESCONOCIDO = 0,  // Algun nombre no existe
+    PARENTESCO_NINGUNO,          // Sin ancestro comun registrado
+    PARENTESCO_MISMO,            // A y B son el mismo miembro
+    PARENTESCO_ANCESTRO,         // A es ancestro de B
+    PARENTESCO_DESCENDIENTE,     // A desciende de B
+    PARENTESCO_HERMANO,          // Mismo progenitor
+    PARENTESCO_TIO,              // A es hermano de un ancestro de B
+    PARENTESCO_SOBRINO,          // A desciende de un hermano de B
+    PARENTESCO_PRIMO             // Colaterales de grado 1 o mas
+};
 
-            nodo->derecho = eliminarRec(nodo->derecho, sucesor->nombre, eliminado);
-        }
+/**
+ * Etiquetas de TipoParentesco para la salida por lotes
+ */
+const char* const ETIQUETAS_PARENTESCO[] = {
+    "NO_ENCONTRADO", "NINGUNO", "MISMO", "ANCESTRO", "DESCENDIENTE",
+    "HERMANO", "TIO", "SOBRINO", "PRIMO"
+};
 
-        return balancear(nodo);
-    }
+struct Parentesco {
+    int tipo;                    // TipoParentesco
+    const Miembro* comun;        // Ancestro comun mas cercano (NULL si no hay)
+    int generacionesA;           // De A hasta el ancestro comun (-1 si no hay)
+    int generacionesB;           // De B hasta el ancestro comun (-1 si no hay)
 
-    /* ========== FUNCIONES DE ESTADISTICAS ========== */
+    Parentesco() : tipo(PARENTESCO_DESCONOCIDO), comun(NULL), generacionesA(-1), generacionesB(-1) {}
 
     /**
-     * Suma las edades de todos los miembros
-     * @param nodo Nodo actual
-     * @param suma Acumulador de la suma
-     * @param contador Contador de miembros
+     * Arma el parentesco a partir del ancestro comun y las generaciones
      */
-    void sumarEdades(Miembro* nodo, int &suma, int &contador) {
-        if (nodo == NULL) return;
-        suma += nodo->edad;
-        contador++;
-        sumarEdades(nodo->izquierdo, suma, contador);
-        sumarEdades(nodo->derecho, suma, contador);
+    Parentesco(const Miembro* _comun, int ga, int gb)
+        : comun(_comun), generacionesA(ga), generacionesB(gb) {
+        if (comun == NULL) {
+            tipo = PARENTESCO_NINGUNO;
+            generacionesA = generacionesB = -1;
+        }
+        else if (ga == 0 && gb == 0) tipo = PARENTESCO_MISMO;
+        else if (ga == 0) tipo = PARENTESCO_ANCESTRO;
+        else if (gb == 0) tipo = PARENTESCO_DESCENDIENTE;
+        else if (ga == 1 && gb == 1) tipo = PARENTESCO_HERMANO;
+        else if (ga == 1) tipo = PARENTESCO_TIO;
+        else if (gb == 1) tipo = PARENTESCO_SOBRINO;
+        else tipo = PARENTESCO_PRIMO;
     }
 
     /**
-     * Encuentra la edad maxima en el arbol
-     * @param nodo Nodo actual
-     * @param maxEdad Variable que almacena el maximo
+     * @return Grado colateral (0 = hermanos, tios y sobrinos; 1 = primos
+     *         hermanos...), -1 si uno es ancestro del otro o no hay parentesco
      */
-    void encontrarEdadMaxima(Miembro* nodo, int &maxEdad) {
-        if (nodo == NULL) return;
-        if (nodo->edad > maxEdad) maxEdad = nodo->edad;
-        encontrarEdadMaxima(nodo->izquierdo, maxEdad);
-        encontrarEdadMaxima(nodo->derecho, maxEdad);
+    int grado() const {
+        if (generacionesA <= 0 || generacionesB <= 0) return -1;
+        return min(generacionesA, generacionesB) - 1;
     }
 
     /**
-     * Encuentra la edad minima en el arbol
-     * @param nodo Nodo actual
-     * @param minEdad Variable que almacena el minimo
+     * @return Generaciones de diferencia entre A y B (veces removido)
      */
-    void encontrarEdadMinima(Miembro* nodo, int &minEdad) {
-        if (nodo == NULL) return;
-        if (nodo->edad < minEdad) minEdad = nodo->edad;
-        encontrarEdadMinima(nodo->izquierdo, minEdad);
-        encontrarEdadMinima(nodo->derecho, minEdad);
+    int removido() const {
+        if (comun == NULL) return -1;
+        return generacionesA > generacionesB ? generacionesA - generacionesB
+                                             : generacionesB - generacionesA;
     }
 
     /**
-     * Cuenta miembros con una relacion familiar especifica
-     * @param nodo Nodo actual
-     * @param relacion Relacion a buscar
-     * @param contador Acumulador de coincidencias
+     * @return Cuantas generaciones mas antiguo es A que B (negativo si
+     *         A es de una generacion posterior)
      */
-    void contarPorRelacion(Miembro* nodo, const string &relacion, int &contador) {
-        if (nodo == NULL) return;
-        if (nodo->relacionFamiliar == relacion) contador++;
-        contarPorRelacion(nodo->izquierdo, relacion, contador);
-        contarPorRelacion(nodo->derecho, relacion, contador);
+    int diferenciaGeneraciones() const {
+        return comun == NULL ? 0 : generacionesB - generacionesA;
     }
 
     /**
-     * Verifica si el arbol cumple las propiedades AVL
-     * @param nodo Nodo actual
-     * @return true si esta balanceado, false en caso contrario
+     * @return Enlaces progenitor-hijo entre A y B, -1 si no hay parentesco
      */
-    bool esAVLBalanceado(Miembro* nodo) {
-        if (nodo == NULL) return true;
-        int balance = obtenerBalance(nodo);
-        if (balance < -1 || balance > 1) return false;
-        return esAVLBalanceado(nodo->izquierdo) && esAVLBalanceado(nodo->derecho);
+    int distancia() const {
+        return comun == NULL ? -1 : generacionesA + generacionesB;
     }
+};
 
-/* ========== FUNCIONES DE VISUALIZACION DEL DIAGRAMA ========== */
+/* ---------------------------
+   CLASE: IndiceLinaje
+   Recorrido de Euler de los arboles de linaje (progenitor -> hijos)
+   con una tabla dispersa para el minimo de profundidad en un tramo.
+   Con el recorrido, "A es ancestro de B" es comparar dos intervalos y
+   el ancestro comun mas cercano es la posicion de menor profundidad
+   entre las primeras visitas de A y B: las dos cosas en O(1).
+   La tabla dispersa completa necesitaria log2(2n) enteros por posicion;
+   aqui se arma sobre bloques de 64 posiciones y dentro de cada bloque
+   cada posicion guarda una mascara de 64 bits con la pila de minimos
+   que terminan en ella, asi la consulta sigue siendo O(1) con unos
+   20 bytes por posicion. Solo entran los miembros con algun enlace.
+   --------------------------- */
+class IndiceLinaje {
+private:
+    static const int BLOQUE = 64;       // Posiciones por bloque (bits de la mascara)
+
+    vector<Miembro*> euler;             // Miembro de cada posicion del recorrido
+    vector<int> profundidades;          // Profundidad de cada posicion
+    vector<unsigned long long> mascaras;// Bit k: la posicion i-k es minimo de su sufijo
+    vector<int> tabla;                  // Nivel j, bloque b: minimo de 2^j bloques
+    size_t bloques;                     // Bloques del recorrido
+    bool vigente;                       // false si los enlaces cambiaron
 
     /**
-     * Obtiene el nombre abreviado para el diagrama (primeras letras)
-     * @param nombre Nombre completo
-     * @return Nombre abreviado (max 3 caracteres)
+     * @return La posicion de menor profundidad de las dos
      */
-    string obtenerAbreviatura(const string &nombre) {
-        if (nombre.length() <= 3) return nombre;
-        
-        string abrev = "";
-        bool tomarLetra = true;
-        
-        for (size_t i = 0; i < nombre.length() && abrev.length() < 3; i++) {
-            if (nombre[i] == ' ') {
-                tomarLetra = true;
-            } else if (tomarLetra && nombre[i] != ' ') {
-                abrev += nombre[i];
-                tomarLetra = false;
-            }
-        }
-        
-        if (abrev.length() == 0) abrev = nombre.substr(0, 3);
-        return abrev;
+    int menor(int a, int b) const {
+        return profundidades[b] < profundidades[a] ? b : a;
     }
 
     /**
-     * Imprime el arbol de forma horizontal recursiva
-     * @param nodo Nodo actual
-     * @param espacio Espaciado para la indentacion
-     * @param esIzquierdo Indica si es hijo izquierdo o derecho
+     * Minimo de las ultimas posiciones hasta fin (dentro de una ventana
+     * de a lo sumo BLOQUE), leido de la mascara de fin
+     * @param fin Ultima posicion (incluida)
+     * @param ancho Posiciones de la ventana, 1..BLOQUE
      */
-    void imprimirArbolHorizontal(Miembro* nodo, string espacio, bool esIzquierdo) {
-        if (nodo == NULL) return;
-
-        // Procesar primero el subarbol derecho (arriba en la visualizacion)
-        if (nodo->derecho != NULL) {
-            imprimirArbolHorizontal(nodo->derecho, espacio + "        ", false);
-        }
-
-        // Imprimir el nodo actual
-        cout << espacio;
-        if (espacio != "") {
-            cout << (esIzquierdo ? "\\_____ " : "/_____ ");
-        }
-        cout << "[" << obtenerAbreviatura(nodo->nombre) << "]" << endl;
-
-        // Procesar el subarbol izquierdo (abajo en la visualizacion)
-        if (nodo->izquierdo != NULL) {
-            imprimirArbolHorizontal(nodo->izquierdo, espacio + "        ", true);
-        }
+    int minimoVentana(int fin, int ancho) const {
+        unsigned long long m = mascaras[fin];
+        if (ancho < BLOQUE) m &= (1ULL << ancho) - 1;
+        return fin - bitMasAlto(m);
     }
 
     /**
-     * Estructura para almacenar informacion de posicion de nodos
+     * Posicion de menor profundidad entre desde y hasta (incluidos)
      */
-    struct NodoPosicion {
-        Miembro* nodo;
-        int x, y;
-        NodoPosicion(Miembro* n, int px, int py) : nodo(n), x(px), y(py) {}
-    };
+    int minimoTramo(int desde, int hasta) const {
+        if (hasta - desde + 1 <= BLOQUE) return minimoVentana(hasta, hasta - desde + 1);
+        int mejor = menor(minimoVentana(desde + BLOQUE - 1, BLOQUE), minimoVentana(hasta, BLOQUE));
+        int x = desde / BLOQUE + 1, y = hasta / BLOQUE - 1;
+        if (x <= y) {
+            int j = bitMasAlto((unsigned long long)(y - x + 1));
+            mejor = menor(mejor, menor(tabla[j * bloques + x],
+                                       tabla[j * bloques + y - (1 << j) + 1]));
+        }
+        return mejor;
+    }
 
     /**
-     * Imprime el diagrama del arbol de forma vertical (mejorado)
+     * Agrega un arbol de linaje al recorrido (sin recursion)
+     * @param raiz Miembro sin progenitor
      */
-    void imprimirDiagramaVertical() {
-        if (raiz == NULL) {
-            cout << "\n(Arbol vacio)\n";
-            return;
-        }
-
-        const int ANCHO_CELDA = 8;
-        const int ALTURA_NIVEL = 3;
-        
-        // Calcular dimensiones
-        int profundidad = profundidadRec(raiz);
-        int anchoTotal = (1 << profundidad) * ANCHO_CELDA;
-        int altoTotal = profundidad * ALTURA_NIVEL + 2;
-
-        // Crear matriz de caracteres
-        vector<string> canvas(altoTotal, string(anchoTotal, ' '));
-
-        // Cola para BFS con posiciones
-        queue<NodoPosicion> cola;
-        int posicionInicial = anchoTotal / 2;
-        cola.push(NodoPosicion(raiz, posicionInicial, 0));
-
-        // Procesar nodos por nivel
-        while (!cola.empty()) {
-            NodoPosicion actual = cola.front();
-            cola.pop();
-
-            if (actual.nodo == NULL) continue;
-
-            // Dibujar el nodo
-            string abrev = obtenerAbreviatura(actual.nodo->nombre);
-            int y = actual.y * ALTURA_NIVEL;
-            int x = actual.x;
-
-            // Dibujar el circulo con el nombre
-            if (y < altoTotal && x >= 2 && x + 4 < anchoTotal) {
-                canvas[y][x-2] = '.';
-                canvas[y][x-1] = '-';
-                canvas[y][x] = '-';
-                canvas[y][x+1] = '-';
-                canvas[y][x+2] = '.';
-                
-                if (y+1 < altoTotal) {
-                    canvas[y+1][x-2] = '|';
-                    for (size_t i = 0; i < abrev.length() && i < 3; i++) {
-                        if (x-1+i < anchoTotal) {
-                            canvas[y+1][x-1+i] = abrev[i];
-                        }
-                    }
-                    canvas[y+1][x+2] = '|';
-                }
-                
-                if (y+2 < altoTotal) {
-                    canvas[y+2][x-2] = '\'';
-                    canvas[y+2][x-1] = '-';
-                    canvas[y+2][x] = '-';
-                    canvas[y+2][x+1] = '-';
-                    canvas[y+2][x+2] = '\'';
+    void recorrer(Miembro* raiz) {
+        vector<Miembro*> pila, siguientes;
+        raiz->linajeProfundidad = 0;
+        raiz->linajeEntrada = (int)euler.size();
+        euler.push_back(raiz);
+        profundidades.push_back(0);
+        pila.push_back(raiz);
+        siguientes.push_back(raiz->primerHijo);
+        while (!pila.empty()) {
+            Miembro* hijo = siguientes.back();
+            if (hijo == NULL) {
+                // Sin mas hijos: la ultima posicion escrita es la suya
+                pila.back()->linajeSalida = (int)euler.size() - 1;
+                pila.pop_back();
+                siguientes.pop_back();
+                if (!pila.empty()) {
+                    euler.push_back(pila.back());
+                    profundidades.push_back(pila.back()->linajeProfundidad);
                 }
+                continue;
             }
+            siguientes.back() = hijo->siguienteHermano;
+            hijo->linajeProfundidad = pila.back()->linajeProfundidad + 1;
+            hijo->linajeEntrada = (int)euler.size();
+            euler.push_back(hijo);
+            profundidades.push_back(hijo->linajeProfundidad);
+            pila.push_back(hijo);
+            siguientes.push_back(hijo->primerHijo);
+        }
+    }
 
-            // Calcular posiciones de los hijos
-            int separacion = anchoTotal / (1 << (actual.y + 2));
-            
-            // Dibujar conexiones y agregar hijos a la cola
-            if (actual.nodo->izquierdo != NULL) {
-                int xIzq = x - separacion;
-                int yHijo = (actual.y + 1) * ALTURA_NIVEL;
-                
-                // Dibujar linea diagonal hacia la izquierda
-                if (y+3 < altoTotal && xIzq < anchoTotal) {
-                    int pasos = (xIzq < x) ? (x - xIzq) : (xIzq - x);
-                    for (int i = 1; i <= pasos && y+2+i < altoTotal; i++) {
-                        int posX = x - i;
-                        if (posX >= 0 && posX < anchoTotal) {
-                            canvas[y+2+i][posX] = '/';
-                        }
-                    }
-                }
-                
-                cola.push(NodoPosicion(actual.nodo->izquierdo, xIzq, actual.y + 1));
-            }
+public:
+    IndiceLinaje() : bloques(0), vigente(true) {}
 
-            if (actual.nodo->derecho != NULL) {
-                int xDer = x + separacion;
-                int yHijo = (actual.y + 1) * ALTURA_NIVEL;
-                
-                // Dibujar linea diagonal hacia la derecha
-                if (y+3 < altoTotal && xDer < anchoTotal) {
-                    int pasos = (xDer > x) ? (xDer - x) : (x - xDer);
-                    for (int i = 1; i <= pasos && y+2+i < altoTotal; i++) {
-                        int posX = x + i;
-                        if (posX >= 0 && posX < anchoTotal) {
-                            canvas[y+2+i][posX] = '\\';
-                        }
-                    }
-                }
-                
-                cola.push(NodoPosicion(actual.nodo->derecho, xDer, actual.y + 1));
+    /**
+     * Arma el recorrido y la tabla, O(n)
+     * @param miembros Todos los miembros del arbol: los que no tienen
+     *                 enlaces quedan fuera (linajeEntrada = -1)
+     */
+    void construir(const vector<Miembro*> &miembros) {
+        vector<Miembro*> raices;
+        size_t conProgenitor = 0;
+        for (size_t i = 0; i < miembros.size(); i++) {
+            Miembro* m = miembros[i];
+            m->linajeEntrada = -1;
+            if (m->progenitor != NULL) conProgenitor++;
+            else if (m->primerHijo != NULL) raices.push_back(m);
+        }
+        // Un arbol de k miembros ocupa 2k - 1 posiciones
+        size_t largo = 2 * conProgenitor + raices.size();
+        euler.clear();
+        profundidades.clear();
+        euler.reserve(largo);
+        profundidades.reserve(largo);
+        for (size_t i = 0; i < raices.size(); i++) recorrer(raices[i]);
+
+        // Mascaras: pila de minimos de la ventana de 64 que termina en i
+        size_t n = euler.size();
+        mascaras.assign(n, 0);
+        unsigned long long actual = 0;
+        for (size_t i = 0; i < n; i++) {
+            actual <<= 1;
+            while (actual != 0) {
+                int k = bitMasAlto(actual & (~actual + 1)); // El minimo mas cercano
+                if (profundidades[i - k] < profundidades[i]) break;
+                actual &= actual - 1;
             }
+            actual |= 1;
+            mascaras[i] = actual;
         }
 
-        // Imprimir el canvas
-        for (size_t i = 0; i < canvas.size(); i++) {
-            cout << canvas[i] << endl;
+        bloques = (n + BLOQUE - 1) / BLOQUE;
+        int niveles = bloques > 0 ? bitMasAlto(bloques) + 1 : 0;
+        tabla.assign((size_t)niveles * bloques, 0);
+        for (size_t b = 0; b < bloques; b++) {
+            int fin = (int)min(n, (b + 1) * BLOQUE) - 1;
+            tabla[b] = minimoVentana(fin, fin - (int)(b * BLOQUE) + 1);
         }
+        for (int j = 1; j < niveles; j++)
+            for (size_t b = 0; b + ((size_t)1 << j) <= bloques; b++)
+                tabla[j * bloques + b] = menor(tabla[(j - 1) * bloques + b],
+                                               tabla[(j - 1) * bloques + b + ((size_t)1 << (j - 1))]);
+        vigente = true;
     }
 
-public:
     /**
-     * Constructor: Inicializa el arbol vacio
+     * Marca el indice como desactualizado (se reconstruye al consultar)
      */
-    ArbolGenealogico() {
-        raiz = NULL;
-        historial.clear();
-    }
+    void invalidar() { vigente = false; }
 
     /**
-     * Busca un miembro por nombre
-     * @param nombre Nombre a buscar
-     * @return Puntero al miembro o NULL si no existe
+     * Libera la memoria del indice
      */
-    Miembro* buscarMiembro(const string &nombre) {
-        return buscarRec(raiz, nombre);
+    void liberar() {
+        vector<Miembro*>().swap(euler);
+        vector<int>().swap(profundidades);
+        vector<unsigned long long>().swap(mascaras);
+        vector<int>().swap(tabla);
+        bloques = 0;
+        vigente = true; // Sin miembros no hay enlaces que indexar
     }
 
     /**
-     * Modifica los datos de un miembro existente
-     * @param nombre Nombre del miembro
-     * @param nuevaEdad Nueva edad
-     * @param nuevaOcupacion Nueva ocupacion
-     * @param nuevaRelacion Nueva relacion familiar
-     * @return true si se modifico, false si no existe
+     * @return true si el recorrido refleja los enlaces actuales
      */
-    bool modificarMiembro(const string &nombre, int nuevaEdad,
-                         const string &nuevaOcupacion, const string &nuevaRelacion)
-    {
-        Miembro* m = buscarMiembro(nombre);
-        if (m == NULL) return false;
-        m->edad = nuevaEdad;
-        m->ocupacion = nuevaOcupacion;
-        m->relacionFamiliar = nuevaRelacion;
-        historial.push_back(string("MODIFICAR: ") + nombre);
-        return true;
-    }
+    bool estaVigente() const { return vigente; }
 
     /**
-     * Muestra todos los datos de un miembro
-     * @param m Puntero al miembro
+     * @return Posiciones del recorrido de Euler
      */
-    void imprimirMiembroCompleto(Miembro* m) {
-        if (m == NULL) {
-            cout << "(Miembro nulo)\n";
-            return;
-        }
-        cout << "\n----------------- FICHA DEL MIEMBRO -----------------\n";
-        cout << "Nombre: " << m->nombre << "\n";
-        cout << "Edad: "  << m->edad << " anos\n";
-        cout << "Genero: " << m->genero << "\n";
-        cout << "Relacion familiar: " << m->relacionFamiliar << "\n";
-        cout << "Ocupacion: " << m->ocupacion << "\n";
-        cout << "Lugar de nacimiento: " << m->lugarNacimiento << "\n";
-        cout << "Altura (campo para AVL): " << m->altura << "\n";
-        cout << "----------------------------------------------------\n";
-    }
-
-    /* ========== RECORRIDOS DEL ARBOL ========== */
+    size_t tamano() const { return euler.size(); }
 
     /**
-     * Muestra el recorrido en Preorden
-     * Util para ver la jerarquia de ancestros a descendientes
+     * @return Bytes ocupados por los arreglos del indice
      */
-    void mostrarPreorden() {
-        cout << "\n=== RECORRIDO PREORDEN (Antiguedad: ancestros -> descendientes) ===\n";
-        cout << "Explicacion: Preorden visita la raiz primero, por eso es util\n";
-        cout << "             para presentar la genealogia del ancestro hacia\n";
-        cout << "             sus descendientes en orden temporal.\n";
-        imprimirCabeceraTabla();
-        int contador = 1;
-        preordenRec(raiz, contador);
-        cout << "-----------------------------------------------------------------\n";
+    size_t bytesUsados() const {
+        return euler.capacity() * sizeof(Miembro*) + profundidades.capacity() * sizeof(int) +
+               mascaras.capacity() * sizeof(unsigned long long) + tabla.capacity() * sizeof(int);
     }
 
     /**
-     * Muestra el recorrido Inorden
-     * Muestra los miembros en orden alfabetico
+     * @return true si a es ancestro de b (o el mismo miembro), O(1)
      */
-    void mostrarInorden() {
-        cout << "\n=== RECORRIDO INORDEN (Orden alfabetico) ===\n";
-        cout << "Explicacion: Inorden muestra los miembros ordenados\n";
-        cout << "             alfabeticamente por nombre.\n";
-        imprimirCabeceraTabla();
-        int contador = 1;
-        inordenRec(raiz, contador);
-        cout << "-----------------------------------------------------------------\n";
+    bool esAncestro(const Miembro* a, const Miembro* b) const {
+        if (a == b) return true;
+        if (a->linajeEntrada < 0 || b->linajeEntrada < 0) return false;
+        return a->linajeEntrada <= b->linajeEntrada && b->linajeSalida <= a->linajeSalida;
     }
 
     /**
-     * Muestra el recorrido Postorden
-     * Util para ver de descendientes hacia ancestros
+     * Ancestro comun mas cercano, O(1)
+     * @return El ancestro, o NULL si estan en linajes distintos
      */
-    void mostrarPostorden() {
-        cout << "\n=== RECORRIDO POSTORDEN (Descendientes -> Ancestro) ===\n";
-        cout << "Explicacion: Postorden visita los descendientes antes que el\n";
-        cout << "             ancestro; es util para ver generaciones recientes\n";
-        cout << "             hacia los mas antiguos.\n";
-        imprimirCabeceraTabla();
-        int contador = 1;
-        postordenRec(raiz, contador);
-        cout << "-----------------------------------------------------------------\n";
+    Miembro* ancestroComun(const Miembro* a, const Miembro* b) const {
+        if (a == b) return const_cast<Miembro*>(a);
+        if (a->linajeEntrada < 0 || b->linajeEntrada < 0) return NULL;
+        int desde = min(a->linajeEntrada, b->linajeEntrada);
+        int hasta = max(a->linajeEntrada, b->linajeEntrada);
+        Miembro* c = euler[minimoTramo(desde, hasta)];
+        // Entre dos linajes el minimo es la raiz de uno de ellos, que no
+        // es ancestro de ambos
+        return esAncestro(c, a) && esAncestro(c, b) ? c : NULL;
     }
 
     /**
-     * Muestra el recorrido Por Niveles (BFS)
-     * Muestra miembros por distancia a la raiz
+     * Parentesco de a respecto de b, O(1). Solo lee: varios hilos
+     * pueden consultar a la vez
      */
-    void mostrarPorNiveles() {
-        cout << "\n=== RECORRIDO POR NIVELES (Generaciones aproximadas) ===\n";
-        cout << "Explicacion: Por niveles muestra nodos por distancia a la raiz\n";
-        cout << "             (nivel 0 = raiz, nivel 1 = hijos, etc.).\n";
-        imprimirCabeceraTabla();
-        if (raiz == NULL) {
-            cout << "(arbol vacio)\n";
-            cout << "-----------------------------------------------------------------\n";
-            return;
-        }
-        queue<Miembro*> q;
-        q.push(raiz);
-        int contador = 1;
-        while (!q.empty()) {
-            Miembro* cur = q.front(); 
-            q.pop();
-            imprimirLineaEnumerada(cur, contador);
-            contador++;
-            if (cur->izquierdo) q.push(cur->izquierdo);
-            if (cur->derecho) q.push(cur->derecho);
-        }
-        cout << "-----------------------------------------------------------------\n";
+    Parentesco parentesco(const Miembro* a, const Miembro* b) const {
+        const Miembro* c = ancestroComun(a, b);
+        if (c == NULL) return Parentesco(NULL, -1, -1);
+        if (c->linajeEntrada < 0) return Parentesco(c, 0, 0); // a == b sin enlaces
+        return Parentesco(c, a->linajeProfundidad - c->linajeProfundidad,
+                          b->linajeProfundidad - c->linajeProfundidad);
     }
+};
 
-    /**
-     * Muestra el historial de operaciones realizadas
-     */
-    void mostrarHistorial() {
-        cout << "\n=== HISTORIAL DE OPERACIONES ===\n";
-        if (historial.empty()) {
-            cout << "(vacio)\n";
-        } else {
-            for (size_t i = 0; i < historial.size(); ++i)
-                cout << (i+1) << ". " << historial[i] << "\n";
-        }
-        cout << "=================================\n";
-    }
+/* ---------------------------
+   PERSISTENCIA: formato de instantanea binaria
+   Cabecera fija (40 bytes):
+     magia "AGINCA01" | version u32 | miembros u32 |
+     bytes de contenido u64 | suma FNV-1a 64 del contenido u64 |
+     ultima secuencia del diario incluida u64 (desde la version 2;
+     la version 1 tiene cabecera de 32 bytes y secuencia 0)
+   Contenido:
+     4 tablas de simbolos (genero, relacion, ocupacion, lugar):
+       cantidad u32, y por cada texto: longitud u32 + bytes
+     Nombres: longitud total u32 + bytes concatenados
+     Registros fijos de 28 bytes en orden alfabetico:
+       inicio del nombre u32 | longitud u32 | edad i32 |
+       idGenero u32 | idRelacion u32 | idOcupacion u32 | idLugar u32
+     Linaje (desde la version 3): cantidad u32, y por cada miembro con
+       progenitor: registro del hijo u32 | registro del progenitor u32,
+       en orden creciente de hijo
+   Todos los enteros van en little-endian. El orden alfabetico fija
+   la forma del AVL balanceado, asi la carga no compara ni rota.
+   --------------------------- */
+const char MAGIA_INSTANTANEA[8] = {'A', 'G', 'I', 'N', 'C', 'A', '0', '1'};
+const unsigned int VERSION_INSTANTANEA = 3;
+const size_t BYTES_CABECERA = 40;
+const size_t BYTES_CABECERA_V1 = 32;
+const size_t BYTES_REGISTRO = 28;
+const char* const RUTA_INSTANTANEA = "arbol_genealogico.bin";
+const char* const RUTA_DIARIO = "arbol_genealogico.wal";
+const unsigned long long UMBRAL_COMPACTACION = 4ULL << 20; // Bytes de diario
 
-    /**
-     * Carga datos de ejemplo del Tahuantinsuyo
-     */
-    void cargarDatosEjemplo() {
-        insertarMiembroAVL("Manco Capac", 70, "Masculino", "Fundador", "Sapa Inca legendario", "Titicaca");
-        insertarMiembroAVL("Sinchi Roca", 48, "Masculino", "Sucesor", "Noble", "Cusco");
-        insertarMiembroAVL("Lloque Yupanqui", 45, "Masculino", "Ancestro legendario", "Noble", "Cusco");
-        insertarMiembroAVL("Mayta Capac", 60, "Masculino", "Antepasado", "Sapa Inca", "Cusco");
-        insertarMiembroAVL("Pachacutec", 55, "Masculino", "Sapa Inca", "Emperador - Reformador", "Cusco");
-        insertarMiembroAVL("Tupac Yupanqui", 50, "Masculino", "Hijo", "Emperador", "Cusco");
-        insertarMiembroAVL("Huayna Capac", 45, "Masculino", "Nieto", "Ultimo gran Sapa Inca", "Cusco");
+const unsigned long long FNV_BASE = 14695981039346656037ULL;
+const unsigned long long FNV_PRIMO = 1099511628211ULL;
 
-        insertarmeHistorial("CARGA_INICIAL: Datos del Tahuantinsuyo insertados");
+/**
+ * Suma de verificacion FNV-1a de 64 bits (se puede encadenar)
+ * @param datos Bytes a procesar
+ * @param n Cantidad de bytes
+ * @param suma Valor acumulado hasta ahora
+ * @return Suma actualizada
+ */
+unsigned long long fnv1a(const char* datos, size_t n, unsigned long long suma = FNV_BASE) {
+    for (size_t i = 0; i < n; i++) {
+        suma ^= (unsigned char)datos[i];
+        suma *= FNV_PRIMO;
     }
+    return suma;
+}
 
-    /**
-     * Agrega una entrada al historial
-     * @param s Texto a agregar
-     */
-    void insertarmeHistorial(const string &s) {
-        historial.push_back(s);
-    }
+/**
+ * Escribe un entero de 32 bits en little-endian
+ */
+void escribirU32(char* destino, unsigned int v) {
+    for (int i = 0; i < 4; i++) destino[i] = (char)((v >> (8 * i)) & 0xFF);
+}
 
-    /**
-     * Inserta un nuevo miembro con balanceo AVL
-     * @return true si se inserto, false si ya existe o datos invalidos
-     */
-    bool insertarMiembroAVL(const string &nombre, int edad,
-                            const string &genero, const string &relacion,
-                            const string &ocupacion, const string &lugarNacimiento)
-    {
-        if (nombre.size() == 0) return false;
-        if (buscarMiembro(nombre) != NULL) return false;
+/**
+ * Escribe un entero de 64 bits en little-endian
+ */
+void escribirU64(char* destino, unsigned long long v) {
+    escribirU32(destino, (unsigned int)(v & 0xFFFFFFFFULL));
+    escribirU32(destino + 4, (unsigned int)(v >> 32));
+}
 
-        Miembro* nuevo = new Miembro(nombre, edad, genero, relacion, ocupacion, lugarNacimiento);
-        raiz = insertarRecAVL(raiz, nuevo);
-        historial.push_back(string("INSERTAR AVL: ") + nombre);
-        return true;
+/* ---------------------------
+   CLASE: EscritorBinario
+   Escribe enteros little-endian y bytes a un archivo con buffer
+   propio, acumulando la suma FNV-1a de todo lo escrito
+   --------------------------- */
+class EscritorBinario {
+private:
+    ofstream &salida;
+    vector<char> buffer;
+    unsigned long long suma;
+    unsigned long long escritos;
+
+public:
+    explicit EscritorBinario(ofstream &_salida)
+        : salida(_salida), suma(FNV_BASE), escritos(0) {
+        buffer.reserve(1 << 16);
     }
 
-    /**
-     * Elimina un miembro del arbol
-     * @param nombre Nombre del miembro a eliminar
-     * @return true si se elimino, false si no existe
-     */
-    bool eliminarMiembro(const string &nombre) {
-        if (nombre.empty()) return false;
-        bool eliminado = false;
-        raiz = eliminarRec(raiz, nombre, eliminado);
-        if (eliminado) historial.push_back(string("ELIMINAR: ") + nombre);
-        return eliminado;
+    void bytes(const char* datos, size_t n) {
+        suma = fnv1a(datos, n, suma);
+        escritos += n;
+        if (buffer.size() + n > buffer.capacity()) vaciarBuffer();
+        if (n >= buffer.capacity()) salida.write(datos, n);
+        else buffer.insert(buffer.end(), datos, datos + n);
     }
 
-    /**
-     * Muestra estadisticas avanzadas del arbol
-     */
-    void mostrarEstadisticasAvanzadas() {
-        cout << "\n========== ESTADISTICAS AVANZADAS ==========\n";
+    void u32(unsigned int v) {
+        char b[4];
+        escribirU32(b, v);
+        bytes(b, 4);
+    }
 
-        int total = contarRec(raiz);
-        cout << "Total de miembros: " << total << "\n";
+    void texto(const string &s) {
+        u32((unsigned int)s.size());
+        bytes(s.data(), s.size());
+    }
 
-        if (total == 0) {
-            cout << "No hay miembros en el arbol.\n";
-            cout << "===========================================\n";
-            return;
-        }
+    void vaciarBuffer() {
+        if (!buffer.empty()) salida.write(&buffer[0], buffer.size());
+        buffer.clear();
+    }
 
-        int suma = 0, contador = 0;
-        sumarEdades(raiz, suma, contador);
-        double promedio = (double)suma / contador;
-        cout << "Edad promedio: " << promedio << " anos\n";
+    unsigned long long sumaVerificacion() const { return suma; }
+    unsigned long long totalEscrito() const { return escritos; }
+};
 
-        int maxEdad = 0;
-        encontrarEdadMaxima(raiz, maxEdad);
-        cout << "Edad maxima: " << maxEdad << " anos\n";
+/* ---------------------------
+   CLASE: LectorBinario
+   Cursor sobre un bloque de memoria (el archivo mapeado) que
+   verifica los limites antes de cada lectura
+   --------------------------- */
+class LectorBinario {
+private:
+    const char* actual;
+    const char* fin;
 
-        int minEdad = 999;
-        encontrarEdadMinima(raiz, minEdad);
-        cout << "Edad minima: " << minEdad << " anos\n";
+public:
+    LectorBinario(const char* datos, size_t n) : actual(datos), fin(datos + n) {}
 
-        cout << "Profundidad del arbol: " << profundidadRec(raiz) << " niveles\n";
+    /**
+     * @return Bytes que faltan por leer
+     */
+    size_t restantes() const { return (size_t)(fin - actual); }
 
-        bool balanceado = esAVLBalanceado(raiz);
-        cout << "Estado AVL: " << (balanceado ? "BALANCEADO" : "DESBALANCEADO") << "\n";
+    bool u32(unsigned int &v) {
+        if (restantes() < 4) return false;
+        v = 0;
+        for (int i = 3; i >= 0; i--) v = (v << 8) | (unsigned char)actual[i];
+        actual += 4;
+        return true;
+    }
 
-        cout << "===========================================\n";
+    bool u64(unsigned long long &v) {
+        unsigned int bajo, alto;
+        if (!u32(bajo) || !u32(alto)) return false;
+        v = ((unsigned long long)alto << 32) | bajo;
+        return true;
     }
 
     /**
-     * Muestra conteo de miembros por relacion familiar
+     * Devuelve un puntero a los proximos n bytes sin copiarlos
+     * @return NULL si no quedan n bytes
      */
-    void mostrarConteoRelaciones() {
-        cout << "\n========== CONTEO POR RELACION FAMILIAR ==========\n";
+    const char* bytes(size_t n) {
+        if (restantes() < n) return NULL;
+        const char* p = actual;
+        actual += n;
+        return p;
+    }
 
-        string relaciones[] = {"Sapa Inca", "Fundador", "Sucesor", "Principe",
-                               "Hijo", "Nieto", "Emperador", "Noble", 
-                               "Ancestro legendario", "Antepasado"};
-        int numRelaciones = 10;
-        bool hayResultados = false;
+    bool texto(string &s) {
+        unsigned int n;
+        if (!u32(n)) return false;
+        const char* p = bytes(n);
+        if (p == NULL) return false;
+        s.assign(p, n);
+        return true;
+    }
+};
 
-        for (int i = 0; i < numRelaciones; i++) {
-            int count = 0;
-            contarPorRelacion(raiz, relaciones[i], count);
-            if (count > 0) {
-                cout << relaciones[i] << ": " << count << " miembro(s)\n";
-                hayResultados = true;
-            }
-        }
+/* ---------------------------
+   CLASE: ArchivoMapeado
+   Proyecta un archivo completo en memoria de solo lectura (mmap) y
+   lo libera al destruirse. En Windows se lee a un buffer.
+   --------------------------- */
+class ArchivoMapeado {
+private:
+    const char* datos;
+    size_t bytes;
+#ifdef _WIN32
+    vector<char> copia;
+#endif
 
-        if (!hayResultados) cout << "No se encontraron relaciones registradas.\n";
-        cout << "==================================================\n";
-    }
+    // No copiable: el destructor libera la proyeccion
+    ArchivoMapeado(const ArchivoMapeado&);
+    ArchivoMapeado& operator=(const ArchivoMapeado&);
+
+public:
+    ArchivoMapeado() : datos(NULL), bytes(0) {}
+    ~ArchivoMapeado() { cerrar(); }
 
     /**
-     * Muestra el diagrama visual del arbol
+     * Abre y proyecta un archivo
+     * @param ruta Ruta del archivo
+     * @return false si no existe o no se pudo leer
      */
-    void mostrarDiagramaArbol() {
-        cout << "\n+---------------------------------------------------------------+\n";
-        cout << "¦       DIAGRAMA VISUAL DEL ARBOL GENEALOGICO (AVL)            ¦\n";
-        cout << "+---------------------------------------------------------------+\n\n";
-        
-        if (raiz == NULL) {
-            cout << "  (Arbol vacio - No hay miembros registrados)\n\n";
-            return;
+    bool abrir(const string &ruta) {
+        cerrar();
+#ifdef _WIN32
+        ifstream entrada(ruta.c_str(), ios::binary);
+        if (!entrada) return false;
+        copia.assign(istreambuf_iterator<char>(entrada), istreambuf_iterator<char>());
+        datos = copia.empty() ? NULL : &copia[0];
+        bytes = copia.size();
+        return true;
+#else
+        int fd = open(ruta.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            close(fd);
+            return false;
+        }
+        bytes = (size_t)info.st_size;
+        if (bytes > 0) {
+            void* p = mmap(NULL, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED) {
+                close(fd);
+                bytes = 0;
+                return false;
+            }
+            datos = static_cast<const char*>(p);
         }
+        close(fd); // La proyeccion sigue valida sin el descriptor
+        return true;
+#endif
+    }
 
-        cout << "Leyenda: [Abr] = Abreviatura del nombre\n";
-        cout << "         /     = Rama izquierda (menor alfabeticamente)\n";
-        cout << "         \\     = Rama derecha (mayor alfabeticamente)\n\n";
-        
-        cout << "VISTA HORIZONTAL (izquierda=arriba, derecha=abajo):\n";
-        cout << "---------------------------------------------------\n";
-        imprimirArbolHorizontal(raiz, "", false);
-        
-        cout << "\n\nVISTA VERTICAL (estructura de arbol):\n";
-        cout << "--------------------------------------\n";
-        imprimirDiagramaVertical();
-        
-        cout << "\n---------------------------------------------------------------\n";
-        cout << "Estadisticas: " << contarRec(raiz) << " miembros, ";
-        cout << "Profundidad: " << profundidadRec(raiz) << " niveles\n";
-        cout << "Balance AVL: " << (esAVLBalanceado(raiz) ? "CORRECTO" : "REQUIERE AJUSTE") << "\n";
-        cout << "---------------------------------------------------------------\n";
+    void cerrar() {
+#ifdef _WIN32
+        copia.clear();
+#else
+        if (datos != NULL) munmap(const_cast<char*>(datos), bytes);
+#endif
+        datos = NULL;
+        bytes = 0;
     }
-};
 
-/* ========== FUNCIONES DE VALIDACION ========== */
+    const char* contenido() const { return datos; }
+    size_t tamano() const { return bytes; }
+};
 
 /**
- * Limpia el buffer de entrada
+ * Milisegundos de un reloj de pared (solo para medir intervalos)
  */
-void limpiarEntradas() {
-    cin.clear();
-    cin.ignore(numeric_limits<streamsize>::max(), '\n');
+double milisegundosActuales() {
+#ifdef _WIN32
+    struct _timeb t;
+    _ftime(&t);
+    return (double)t.time * 1000.0 + t.millitm;
+#else
+    struct timeval t;
+    gettimeofday(&t, NULL);
+    return (double)t.tv_sec * 1000.0 + t.tv_usec / 1000.0;
+#endif
 }
 
 /**
- * Valida que una cadena no este vacia
- * @param texto Texto a validar
- * @return true si es valido
+ * Fuerza a disco el contenido de un archivo abierto
  */
-bool validarTextoNoVacio(const string &texto) {
-    if (texto.empty()) {
-        cout << "ERROR: El campo no puede estar vacio.\n";
-        return false;
-    }
-    // Verificar que no sea solo espacios
-    bool soloEspacios = true;
-    for (size_t i = 0; i < texto.length(); i++) {
-        if (texto[i] != ' ' && texto[i] != '\t') {
-            soloEspacios = false;
-            break;
-        }
-    }
-    if (soloEspacios) {
-        cout << "ERROR: El campo no puede contener solo espacios.\n";
-        return false;
-    }
-    return true;
+void sincronizarArchivo(FILE* archivo) {
+    fflush(archivo);
+#ifdef _WIN32
+    _commit(_fileno(archivo));
+#else
+    fsync(fileno(archivo));
+#endif
 }
 
 /**
- * Valida que la edad este en un rango razonable
- * @param edad Edad a validar
- * @return true si es valido
+ * Fuerza a disco un archivo ya cerrado (por ruta)
  */
-bool validarEdad(int edad) {
-    if (edad < 0 || edad > 150) {
-        cout << "ERROR: La edad debe estar entre 0 y 150 anos.\n";
-        return false;
-    }
-    return true;
+void sincronizarRuta(const string &ruta) {
+#ifndef _WIN32
+    int fd = open(ruta.c_str(), O_RDONLY);
+    if (fd < 0) return;
+    fsync(fd);
+    close(fd);
+#else
+    FILE* archivo = fopen(ruta.c_str(), "r+b");
+    if (archivo == NULL) return;
+    sincronizarArchivo(archivo);
+    fclose(archivo);
+#endif
 }
 
-/**
- * Valida que el genero sea Masculino o Femenino
- * @param genero Genero a validar
- * @return true si es valido
- */
-bool validarGenero(const string &genero) {
-    if (genero != "Masculino" && genero != "Femenino") {
+/* ---------------------------
+   CLASE: TareaParalela
+   Trabajo que corre en un hilo propio con ejecutarEnParalelo()
+   --------------------------- */
+class TareaParalela {
+public:
+    virtual ~TareaParalela() {}
+    virtual void ejecutar() = 0;
+};
+
+/* ---------------------------
+   CLASE: GrupoHilos
+   Hilos de trabajo que duran todo el programa. ejecutarEnParalelo les
+   entrega las tareas en lugar de crear y esperar un hilo por tarea en
+   cada llamada: crear un hilo cuesta decenas de microsegundos, mas que
+   muchos de los bloques que se reparten (parentescos por lotes,
+   filtros y reducciones sobre arboles chicos, rondas de mezcla).
+   Los hilos se crean al primer uso y el grupo crece hasta tener un
+   hilo libre por tarea en espera, asi todas las tareas de una llamada
+   siguen corriendo a la vez (algunas esperan a otras, como el escritor
+   y los lectores de medirConcurrencia). Los hilos de mas quedan
+   dormidos hasta la siguiente llamada.
+   --------------------------- */
+class GrupoHilos {
+private:
+    struct Pendiente {
+        TareaParalela* tarea;
+        long* restantes;           // Tareas sin terminar de su llamada
+        Pendiente(TareaParalela* _tarea, long* _restantes) : tarea(_tarea), restantes(_restantes) {}
+    };
+
+    deque<Pendiente> cola;         // Tareas que todavia no tomo ningun hilo
+    int libres;                    // Hilos que no estan ejecutando una tarea
+    bool terminar;                 // El grupo se destruye: los hilos salen
+    bool sinHilos;                 // No se pudo crear un hilo: el que llama ayuda
+#ifdef _WIN32
+    CRITICAL_SECTION mutex;
+    CONDITION_VARIABLE hayTrabajo, terminadas;
+    vector<HANDLE> hilos;
+#else
+    pthread_mutex_t mutex;
+    pthread_cond_t hayTrabajo, terminadas;
+    vector<pthread_t> hilos;
+#endif
+
+    GrupoHilos(const GrupoHilos&);
+    GrupoHilos& operator=(const GrupoHilos&);
+
+#ifdef _WIN32
+    void bloquear() { EnterCriticalSection(&mutex); }
+    void desbloquear() { LeaveCriticalSection(&mutex); }
+    void esperar(CONDITION_VARIABLE &c) { SleepConditionVariableCS(&c, &mutex, INFINITE); }
+    void despertarTodos(CONDITION_VARIABLE &c) { WakeAllConditionVariable(&c); }
+
+    static DWORD WINAPI arrancar(LPVOID grupo) {
+        static_cast<GrupoHilos*>(grupo)->trabajar();
+        return 0;
+    }
+
+    bool crearHilo() {
+        HANDLE h = CreateThread(NULL, 0, arrancar, this, 0, NULL);
+        if (h == NULL) return false;
+        hilos.push_back(h);
+        return true;
+    }
+#else
+    void bloquear() { pthread_mutex_lock(&mutex); }
+    void desbloquear() { pthread_mutex_unlock(&mutex); }
+    void esperar(pthread_cond_t &c) { pthread_cond_wait(&c, &mutex); }
+    void despertarTodos(pthread_cond_t &c) { pthread_cond_broadcast(&c); }
+
+    static void* arrancar(void* grupo) {
+        static_cast<GrupoHilos*>(grupo)->trabajar();
+        return NULL;
+    }
+
+    bool crearHilo() {
+        pthread_t h;
+        if (pthread_create(&h, NULL, arrancar, this) != 0) return false;
+        hilos.push_back(h);
+        return true;
+    }
+#endif
+
+    /**
+     * Ejecuta la primera tarea de la cola y avisa si su llamada termino
+     * Se entra y se sale con el mutex tomado
+     */
+    void ejecutarPrimera() {
+        Pendiente p = cola.front();
+        cola.pop_front();
+        desbloquear();
+        p.tarea->ejecutar();
+        bloquear();
+        if (--*p.restantes == 0) despertarTodos(terminadas);
+    }
+
+    /**
+     * Ciclo de cada hilo: toma tareas de la cola hasta que el grupo termina
+     */
+    void trabajar() {
+        bloquear();
+        for (;;) {
+            while (cola.empty() && !terminar) esperar(hayTrabajo);
+            if (cola.empty()) break;
+            libres--;
+            ejecutarPrimera();
+            libres++;
+        }
+        desbloquear();
+    }
+
+public:
+    GrupoHilos() : libres(0), terminar(false), sinHilos(false) {
+#ifdef _WIN32
+        InitializeCriticalSection(&mutex);
+        InitializeConditionVariable(&hayTrabajo);
+        InitializeConditionVariable(&terminadas);
+#else
+        pthread_mutex_init(&mutex, NULL);
+        pthread_cond_init(&hayTrabajo, NULL);
+        pthread_cond_init(&terminadas, NULL);
+#endif
+    }
+
+    /**
+     * Despierta a los hilos para que salgan y los espera
+     */
+    ~GrupoHilos() {
+        bloquear();
+        terminar = true;
+        despertarTodos(hayTrabajo);
+        desbloquear();
+#ifdef _WIN32
+        for (size_t i = 0; i < hilos.size(); i++) {
+            WaitForSingleObject(hilos[i], INFINITE);
+            CloseHandle(hilos[i]);
+        }
+        DeleteCriticalSection(&mutex);
+#else
+        for (size_t i = 0; i < hilos.size(); i++) pthread_join(hilos[i], NULL);
+        pthread_cond_destroy(&hayTrabajo);
+        pthread_cond_destroy(&terminadas);
+        pthread_mutex_destroy(&mutex);
+#endif
+    }
+
+    /**
+     * Ejecuta las tareas y espera a que terminen todas: la primera en
+     * el hilo que llama, las demas en hilos del grupo
+     */
+    void ejecutar(const vector<TareaParalela*> &tareas) {
+        if (tareas.empty()) return;
+        long restantes = (long)tareas.size() - 1;
+        bloquear();
+        for (size_t i = 1; i < tareas.size(); i++) cola.push_back(Pendiente(tareas[i], &restantes));
+        while (libres < (int)cola.size() && !sinHilos) {
+            if (crearHilo()) libres++;
+            else sinHilos = true;
+        }
+        if (restantes > 0) despertarTodos(hayTrabajo);
+        desbloquear();
+
+        tareas[0]->ejecutar();
+
+        bloquear();
+        while (restantes > 0) {
+            // Sin hilos para todas: las que quedan en la cola corren aqui
+            if (sinHilos && libres < (int)cola.size()) ejecutarPrimera();
+            else esperar(terminadas);
+        }
+        desbloquear();
+    }
+
+    /**
+     * @return Hilos creados hasta ahora
+     */
+    int cantidadHilos() {
+        bloquear();
+        int n = (int)hilos.size();
+        desbloquear();
+        return n;
+    }
+};
+
+/**
+ * Grupo de hilos del programa (se crea en la primera llamada)
+ */
+GrupoHilos& grupoHilos() {
+    static GrupoHilos grupo;
+    return grupo;
+}
+
+/**
+ * Ejecuta cada tarea en un hilo y espera a que terminen todas
+ * La primera corre en el hilo que llama y las demas en el grupo de
+ * hilos del programa; si no se pudo crear un hilo, las que no tienen
+ * hilo tambien corren en el que llama
+ * @param tareas Tareas a ejecutar (independientes entre si)
+ */
+void ejecutarEnParalelo(const vector<TareaParalela*> &tareas) {
+    grupoHilos().ejecutar(tareas);
+}
+
+/* ---------------------------
+   CLASE: CerrojoLectoresEscritor
+   Muchos lectores a la vez o un solo escritor (pthread_rwlock en
+   POSIX, SRWLOCK en Windows). En glibc se da preferencia al escritor:
+   con una mayoria de lecturas, la cola de lectores nuevos no debe
+   dejarlo esperando indefinidamente.
+   --------------------------- */
+class CerrojoLectoresEscritor {
+private:
+#ifdef _WIN32
+    SRWLOCK cerrojo;
+#else
+    pthread_rwlock_t cerrojo;
+#endif
+
+    // No copiable: el cerrojo del sistema no se puede copiar
+    CerrojoLectoresEscritor(const CerrojoLectoresEscritor&);
+    CerrojoLectoresEscritor& operator=(const CerrojoLectoresEscritor&);
+
+public:
+    CerrojoLectoresEscritor() {
+#ifdef _WIN32
+        InitializeSRWLock(&cerrojo);
+#else
+        pthread_rwlockattr_t atributos;
+        pthread_rwlockattr_init(&atributos);
+#if defined(__GLIBC__)
+        pthread_rwlockattr_setkind_np(&atributos, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+#endif
+        pthread_rwlock_init(&cerrojo, &atributos);
+        pthread_rwlockattr_destroy(&atributos);
+#endif
+    }
+
+    ~CerrojoLectoresEscritor() {
+#ifndef _WIN32
+        pthread_rwlock_destroy(&cerrojo);
+#endif
+    }
+
+#ifdef _WIN32
+    void leer() { AcquireSRWLockShared(&cerrojo); }
+    void terminarLectura() { ReleaseSRWLockShared(&cerrojo); }
+    void escribir() { AcquireSRWLockExclusive(&cerrojo); }
+    void terminarEscritura() { ReleaseSRWLockExclusive(&cerrojo); }
+#else
+    void leer() { pthread_rwlock_rdlock(&cerrojo); }
+    void terminarLectura() { pthread_rwlock_unlock(&cerrojo); }
+    void escribir() { pthread_rwlock_wrlock(&cerrojo); }
+    void terminarEscritura() { pthread_rwlock_unlock(&cerrojo); }
+#endif
+};
+
+/**
+ * Lectura compartida mientras el objeto exista
+ */
+class SeccionLectura {
+private:
+    CerrojoLectoresEscritor &cerrojo;
+    SeccionLectura(const SeccionLectura&);
+    SeccionLectura& operator=(const SeccionLectura&);
+public:
+    explicit SeccionLectura(CerrojoLectoresEscritor &_cerrojo) : cerrojo(_cerrojo) { cerrojo.leer(); }
+    ~SeccionLectura() { cerrojo.terminarLectura(); }
+};
+
+/**
+ * Escritura exclusiva mientras el objeto exista
+ */
+class SeccionEscritura {
+private:
+    CerrojoLectoresEscritor &cerrojo;
+    SeccionEscritura(const SeccionEscritura&);
+    SeccionEscritura& operator=(const SeccionEscritura&);
+public:
+    explicit SeccionEscritura(CerrojoLectoresEscritor &_cerrojo) : cerrojo(_cerrojo) { cerrojo.escribir(); }
+    ~SeccionEscritura() { cerrojo.terminarEscritura(); }
+};
+
+/**
+ * @return Procesadores disponibles (al menos 1)
+ */
+int hilosDisponibles() {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    int n = (int)info.dwNumberOfProcessors;
+#else
+    int n = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    return n < 1 ? 1 : n;
+}
+
+/**
+ * Toma el siguiente numero de un contador compartido entre hilos
+ * @param contador Contador (empieza en 0)
+ * @return Valor antes de incrementar: cada hilo recibe uno distinto
+ */
+inline long tomarTurno(volatile long* contador) {
+#ifdef _WIN32
+    return InterlockedIncrement(contador) - 1;
+#else
+    return __sync_fetch_and_add(contador, 1L);
+#endif
+}
+
+/**
+ * Cambia un valor compartido solo si todavia tiene el esperado
+ * (comparar e intercambiar atomico, con barrera completa)
+ * @return true si lo cambio este hilo
+ */
+inline bool cambiarSiIgual(volatile long* destino, long esperado, long nuevo) {
+#ifdef _WIN32
+    return InterlockedCompareExchange(destino, nuevo, esperado) == esperado;
+#else
+    return __sync_bool_compare_and_swap(destino, esperado, nuevo);
+#endif
+}
+
+#ifdef MEDIR_ASIGNACIONES
+/* ---------------------------
+   Contador de asignaciones de memoria, solo para medir (compilar con
+   -DMEDIR_ASIGNACIONES). Reemplaza new/delete globales; el modo por
+   lotes informa el total y el promedio por comando al terminar
+   --------------------------- */
+volatile long asignacionesTotales = 0;
+
+#ifdef __GNUC__
+#pragma GCC diagnostic ignored "-Wpragmas"
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete" // new se implementa con malloc
+#endif
+
+void* operator new(size_t n) {
+    tomarTurno(&asignacionesTotales);
+    void* p = malloc(n == 0 ? 1 : n);
+    if (p == NULL) throw bad_alloc();
+    return p;
+}
+
+void* operator new[](size_t n) {
+    tomarTurno(&asignacionesTotales);
+    void* p = malloc(n == 0 ? 1 : n);
+    if (p == NULL) throw bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) throw() { free(p); }
+void operator delete[](void* p) throw() { free(p); }
+#endif
+
+/* ---------------------------
+   ESTRUCTURA: OperacionDiario
+   Una operacion leida del diario, con todos sus argumentos
+   --------------------------- */
+enum TipoOperacion {
+    OP_INSERTAR = 1,         // Todos los campos
+    OP_MODIFICAR = 2,        // nombre, edad, ocupacion y relacion
+    OP_ELIMINAR = 3,         // Solo el nombre
+    OP_PROGENITOR = 4        // nombre = hijo, relacion = progenitor ("" = quitarlo)
+};
+
+struct OperacionDiario {
+    unsigned long long secuencia;
+    int tipo;
+    DatosMiembro datos;
+};
+
+/* ---------------------------
+   CLASE: DiarioOperaciones
+   Diario binario de solo agregado (write-ahead log). Cada registro es:
+     longitud u32 | secuencia u64 | tipo u32 |
+     nombre, edad, genero, relacion, ocupacion, lugar | suma FNV-1a u64
+   (longitud = bytes desde la secuencia hasta el lugar, que es lo que
+   cubre la suma). Los registros se acumulan en memoria y se escriben
+   con un solo fsync cuando hay maxPendientes o cuando el primero lleva
+   esperando latenciaMaxima ms (confirmacion en grupo). La latencia se
+   revisa al agregar y al llamar a revisarLatencia().
+   --------------------------- */
+class DiarioOperaciones {
+private:
+    FILE* archivo;
+    string ruta;
+    vector<char> pendiente;          // Registros aun no escritos
+    size_t registrosPendientes;
+    double inicioPendientes;         // Momento del primer registro pendiente
+    unsigned long long secuencia;    // Ultima secuencia asignada
+    unsigned long long bytes;        // Tamano del archivo incluyendo pendientes
+    unsigned long long sincronizaciones;
+
+    size_t maxPendientes;            // 1 = cada operacion se sincroniza sola
+    double latenciaMaxima;           // ms que puede esperar un registro
+
+    // No copiable: el destructor cierra el archivo
+    DiarioOperaciones(const DiarioOperaciones&);
+    DiarioOperaciones& operator=(const DiarioOperaciones&);
+
+    static void agregarU32(vector<char> &destino, unsigned int v) {
+        char b[4];
+        escribirU32(b, v);
+        destino.insert(destino.end(), b, b + 4);
+    }
+
+    static void agregarTexto(vector<char> &destino, const string &s) {
+        agregarU32(destino, (unsigned int)s.size());
+        destino.insert(destino.end(), s.begin(), s.end());
+    }
+
+public:
+    DiarioOperaciones()
+        : archivo(NULL), registrosPendientes(0), inicioPendientes(0), secuencia(0),
+          bytes(0), sincronizaciones(0), maxPendientes(1), latenciaMaxima(0) {}
+
+    ~DiarioOperaciones() { cerrar(); }
+
+    /**
+     * Lee los registros validos de un diario
+     * Se detiene en el primer registro incompleto o con suma incorrecta
+     * (una escritura cortada por una caida): lo que sigue se descarta
+     * @param ruta Archivo del diario
+     * @param salida Recibe las operaciones en orden
+     * @param bytesValidos Recibe los bytes hasta el ultimo registro valido
+     * @return false si el archivo no existe
+     */
+    static bool leer(const string &ruta, vector<OperacionDiario> &salida,
+                     unsigned long long &bytesValidos) {
+        bytesValidos = 0;
+        ArchivoMapeado archivo;
+        if (!archivo.abrir(ruta)) return false;
+        LectorBinario lector(archivo.contenido(), archivo.tamano());
+        while (true) {
+            unsigned int longitud;
+            if (!lector.u32(longitud)) break;
+            const char* cuerpo = lector.bytes(longitud);
+            unsigned long long suma;
+            if (cuerpo == NULL || !lector.u64(suma) || fnv1a(cuerpo, longitud) != suma) break;
+
+            LectorBinario campos(cuerpo, longitud);
+            OperacionDiario op;
+            unsigned int tipo, edad;
+            DatosMiembro &d = op.datos;
+            if (!campos.u64(op.secuencia) || !campos.u32(tipo) || !campos.texto(d.nombre) ||
+                !campos.u32(edad) || !campos.texto(d.genero) || !campos.texto(d.relacionFamiliar) ||
+                !campos.texto(d.ocupacion) || !campos.texto(d.lugarNacimiento) ||
+                tipo < OP_INSERTAR || tipo > OP_PROGENITOR)
+                break;
+            op.tipo = (int)tipo;
+            d.edad = (int)edad;
+            salida.push_back(op);
+            bytesValidos += 4 + longitud + 8;
+        }
+        return true;
+    }
+
+    /**
+     * Abre el diario para agregar, descartando lo que haya despues de
+     * bytesValidos (la cola de una escritura interrumpida)
+     * @param _ruta Archivo del diario (se crea si no existe)
+     * @param bytesValidos Bytes a conservar, segun leer()
+     * @param ultimaSecuencia Secuencia ya usada; la siguiente es +1
+     * @return false si no se pudo abrir
+     */
+    bool abrir(const string &_ruta, unsigned long long bytesValidos,
+               unsigned long long ultimaSecuencia) {
+        cerrar();
+        ruta = _ruta;
+        if (bytesValidos == 0) {
+            archivo = fopen(ruta.c_str(), "wb");
+        } else {
+#ifdef _WIN32
+            archivo = fopen(ruta.c_str(), "r+b");
+            if (archivo != NULL) {
+                _chsize(_fileno(archivo), (long)bytesValidos);
+                fseek(archivo, 0, SEEK_END);
+            }
+#else
+            if (truncate(ruta.c_str(), (off_t)bytesValidos) == 0)
+                archivo = fopen(ruta.c_str(), "ab");
+#endif
+        }
+        if (archivo == NULL) return false;
+        bytes = bytesValidos;
+        secuencia = ultimaSecuencia;
+        return true;
+    }
+
+    /**
+     * Escribe los pendientes y cierra el archivo
+     */
+    void cerrar() {
+        if (archivo == NULL) return;
+        sincronizar();
+        fclose(archivo);
+        archivo = NULL;
+    }
+
+    /**
+     * Ajusta la confirmacion en grupo
+     * @param _maxPendientes Registros que se juntan antes de un fsync (1 = sincrono)
+     * @param _latenciaMaxima Milisegundos que puede esperar un registro
+     */
+    void configurarGrupo(size_t _maxPendientes, double _latenciaMaxima) {
+        maxPendientes = _maxPendientes < 1 ? 1 : _maxPendientes;
+        latenciaMaxima = _latenciaMaxima;
+        revisarLatencia();
+    }
+
+    /**
+     * Agrega una operacion al diario
+     * Queda en disco cuando el grupo se sincroniza
+     * @param tipo Tipo de operacion
+     * @param d Argumentos completos de la operacion
+     */
+    void agregar(TipoOperacion tipo, const DatosMiembro &d) {
+        agregar(tipo, d.nombre, d);
+    }
+
+    /**
+     * Igual que agregar(tipo, d), con el nombre aparte (d.nombre no se
+     * lee): sirve cuando el nombre ya se movio al nodo
+     */
+    void agregar(TipoOperacion tipo, const string &nombre, const DatosMiembro &d) {
+        if (archivo == NULL) return;
+        size_t inicio = pendiente.size();
+        agregarU32(pendiente, 0); // Longitud, se completa abajo
+        char b[8];
+        escribirU64(b, ++secuencia);
+        pendiente.insert(pendiente.end(), b, b + 8);
+        agregarU32(pendiente, (unsigned int)tipo);
+        agregarTexto(pendiente, nombre);
+        agregarU32(pendiente, (unsigned int)d.edad);
+        agregarTexto(pendiente, d.genero);
+        agregarTexto(pendiente, d.relacionFamiliar);
+        agregarTexto(pendiente, d.ocupacion);
+        agregarTexto(pendiente, d.lugarNacimiento);
+
+        size_t longitud = pendiente.size() - inicio - 4;
+        escribirU32(&pendiente[inicio], (unsigned int)longitud);
+        escribirU64(b, fnv1a(&pendiente[inicio + 4], longitud));
+        pendiente.insert(pendiente.end(), b, b + 8);
+        bytes += pendiente.size() - inicio;
+
+        if (registrosPendientes++ == 0) inicioPendientes = milisegundosActuales();
+        if (registrosPendientes >= maxPendientes) sincronizar();
+        else revisarLatencia();
+    }
+
+    /**
+     * Sincroniza el grupo si su primer registro ya espero demasiado
+     */
+    void revisarLatencia() {
+        if (registrosPendientes > 0 &&
+            milisegundosActuales() - inicioPendientes >= latenciaMaxima)
+            sincronizar();
+    }
+
+    /**
+     * Escribe y fuerza a disco todos los registros pendientes
+     */
+    void sincronizar() {
+        if (archivo == NULL || registrosPendientes == 0) return;
+        fwrite(&pendiente[0], 1, pendiente.size(), archivo);
+        sincronizarArchivo(archivo);
+        pendiente.clear();
+        registrosPendientes = 0;
+        sincronizaciones++;
+    }
+
+    /**
+     * Vacia el diario despues de una compactacion
+     * La secuencia continua: la instantanea recuerda la ultima aplicada
+     */
+    void truncar() {
+        if (archivo == NULL) return;
+        sincronizar();
+        fclose(archivo);
+        archivo = fopen(ruta.c_str(), "wb");
+        if (archivo != NULL) sincronizarArchivo(archivo);
+        bytes = 0;
+    }
+
+    bool estaAbierto() const { return archivo != NULL; }
+    unsigned long long ultimaSecuencia() const { return secuencia; }
+    unsigned long long tamano() const { return bytes; }
+    unsigned long long totalSincronizaciones() const { return sincronizaciones; }
+};
+
+/* ---------------------------
+   CLASE: BufferSalida
+   Acumula texto en un bloque propio y lo escribe con una sola
+   llamada por bloque (sin endl ni flush por linea). Los enteros se
+   formatean a mano, sin sprintf ni strings temporales, y las columnas
+   se rellenan a un ancho fijo como left << setw(ancho). Va por el
+   mismo FILE* que usa cout, asi el orden con lo que se escribe por
+   cout se mantiene si el buffer se vacia antes.
+   --------------------------- */
+class BufferSalida {
+private:
+    FILE* destino;
+    char* datos;
+    size_t usados;
+
+    static const size_t CAPACIDAD = 1 << 16;
+
+    // No copiable: el destructor escribe y libera el bloque
+    BufferSalida(const BufferSalida&);
+    BufferSalida& operator=(const BufferSalida&);
+
+    /**
+     * Asegura lugar para n bytes mas, escribiendo el bloque si hace falta
+     */
+    void reservar(size_t n) {
+        if (usados + n > CAPACIDAD) vaciar();
+    }
+
+    /**
+     * Escribe los digitos de v al final de un arreglo
+     * @return Puntero al primer caracter escrito (termina en fin)
+     */
+    static char* digitos(long long v, char* fin) {
+        unsigned long long u = v < 0 ? 0ULL - (unsigned long long)v : (unsigned long long)v;
+        char* p = fin;
+        do {
+            *--p = (char)('0' + u % 10);
+            u /= 10;
+        } while (u != 0);
+        if (v < 0) *--p = '-';
+        return p;
+    }
+
+public:
+    explicit BufferSalida(FILE* _destino = stdout)
+        : destino(_destino), datos(new char[CAPACIDAD]), usados(0) {}
+
+    ~BufferSalida() {
+        vaciar();
+        delete[] datos;
+    }
+
+    BufferSalida& texto(const char* s, size_t n) {
+        if (n > CAPACIDAD) {
+            vaciar();
+            fwrite(s, 1, n, destino);
+            return *this;
+        }
+        reservar(n);
+        memcpy(datos + usados, s, n);
+        usados += n;
+        return *this;
+    }
+
+    BufferSalida& texto(const string &s) { return texto(s.data(), s.size()); }
+    BufferSalida& texto(const char* s) { return texto(s, strlen(s)); }
+
+    BufferSalida& caracter(char c) {
+        reservar(1);
+        datos[usados++] = c;
+        return *this;
+    }
+
+    /**
+     * Repite un caracter n veces
+     */
+    BufferSalida& relleno(char c, size_t n) {
+        while (n > 0) {
+            reservar(1);
+            size_t tramo = CAPACIDAD - usados < n ? CAPACIDAD - usados : n;
+            memset(datos + usados, c, tramo);
+            usados += tramo;
+            n -= tramo;
+        }
+        return *this;
+    }
+
+    BufferSalida& entero(long long v) {
+        char tmp[24];
+        char* inicio = digitos(v, tmp + sizeof(tmp));
+        return texto(inicio, (size_t)(tmp + sizeof(tmp) - inicio));
+    }
+
+    /**
+     * Numero con decimales fijos (reportes, no filas masivas)
+     */
+    BufferSalida& decimal(double v, int decimales) {
+        char tmp[64];
+        int n = sprintf(tmp, "%.*f", decimales, v);
+        return texto(tmp, (size_t)n);
+    }
+
+    /**
+     * Texto alineado a la izquierda en una columna de ancho fijo
+     * Igual que left << setw(ancho): si el texto es mas largo no se corta
+     */
+    BufferSalida& columna(const char* s, size_t n, size_t ancho) {
+        texto(s, n);
+        if (n < ancho) relleno(' ', ancho - n);
+        return *this;
+    }
+
+    BufferSalida& columna(const string &s, size_t ancho) {
+        return columna(s.data(), s.size(), ancho);
+    }
+
+    /**
+     * Entero seguido de un sufijo, en una columna de ancho fijo
+     * (por ejemplo "7." o "45 anos")
+     */
+    BufferSalida& columnaEntero(long long v, const char* sufijo, size_t ancho) {
+        char tmp[64];
+        char* fin = tmp + 24;
+        char* inicio = digitos(v, fin);
+        size_t largoSufijo = strlen(sufijo);
+        if (largoSufijo > sizeof(tmp) - 24) largoSufijo = sizeof(tmp) - 24;
+        memcpy(fin, sufijo, largoSufijo);
+        return columna(inicio, (size_t)(fin - inicio) + largoSufijo, ancho);
+    }
+
+    /**
+     * Cierra la linea; el bloque se escribe cuando se llena
+     */
+    BufferSalida& finLinea() {
+        return caracter('\n');
+    }
+
+    /**
+     * Escribe todo lo acumulado con una sola llamada
+     */
+    void vaciar() {
+        if (usados > 0) fwrite(datos, 1, usados, destino);
+        usados = 0;
+        fflush(destino);
+    }
+};
+
+/**
+ * Niveles del diagrama: la vista vertical ocupa 2^(niveles-1) * 8
+ * columnas, asi que el maximo fija el ancho (y la memoria) de cada fila
+ */
+const int NIVELES_DIAGRAMA_DEFECTO = 6;
+const int NIVELES_DIAGRAMA_MAXIMO = 10;
+
+/**
+ * Atributos repetidos de un miembro (los que van en tablas de simbolos)
+ */
+enum CampoAtributo {
+    CAMPO_GENERO = 0,
+    CAMPO_RELACION = 1,
+    CAMPO_OCUPACION = 2,
+    CAMPO_LUGAR = 3
+};
+
+/**
+ * Funcion objeto para ArbolGenealogico::recorrerTramo: agrega cada
+ * miembro visitado al final de un vector
+ */
+struct AgregarMiembro {
+    vector<Miembro*> &destino;
+    explicit AgregarMiembro(vector<Miembro*> &_destino) : destino(_destino) {}
+    void operator()(Miembro* m) { destino.push_back(m); }
+};
+
+/* ---------------------------
+   ESTRUCTURA: NombreOrdenado
+   Un nombre de una consulta por lotes con su posicion en la consulta,
+   para ordenarlos y resolverlos juntos con un solo recorrido inorden
+   --------------------------- */
+struct NombreOrdenado {
+    unsigned long long alto;     // Bytes 0..7 del nombre
+    unsigned long long bajo;     // Bytes 8..15
+    unsigned long long resto;    // Bytes 16..23
+    const string* nombre;
+    size_t posicion;             // Casilla del resultado en la consulta
+};
+
+/**
+ * Orden alfabetico de NombreOrdenado: los prefijos dan el mismo orden
+ * que comparar los textos, que solo se leen cuando empatan (los mismos
+ * 24 bytes que compararClave)
+ */
+bool nombreOrdenadoAntes(const NombreOrdenado &a, const NombreOrdenado &b) {
+    if (a.alto != b.alto) return a.alto < b.alto;
+    if (a.bajo != b.bajo) return a.bajo < b.bajo;
+    if (a.resto != b.resto) return a.resto < b.resto;
+    return *a.nombre < *b.nombre;
+}
+
+/**
+ * Pares que toma un hilo por turno al calcular parentescos
+ */
+const long PARES_POR_TURNO = 4096;
+
+/* ---------------------------
+   CLASE: TareaParentescos
+   Un hilo del calculo de parentescos por lotes: toma bloques de pares
+   de un contador compartido. Solo lee el indice de linaje (vigente) y
+   escribe en las casillas de sus propios pares
+   --------------------------- */
+class TareaParentescos : public TareaParalela {
+public:
+    const IndiceLinaje* linaje;
+    const vector<Miembro*>* miembros;  // Pares resueltos: A en 2i, B en 2i + 1
+    vector<Parentesco>* resultados;
+    volatile long* siguiente;
+
+    TareaParentescos(const IndiceLinaje* _linaje, const vector<Miembro*>* _miembros,
+                     vector<Parentesco>* _resultados, volatile long* _siguiente)
+        : linaje(_linaje), miembros(_miembros), resultados(_resultados), siguiente(_siguiente) {}
+
+    void ejecutar() {
+        long pares = (long)resultados->size();
+        for (;;) {
+            long desde = tomarTurno(siguiente) * PARES_POR_TURNO;
+            if (desde >= pares) break;
+            long hasta = min(pares, desde + PARES_POR_TURNO);
+            for (long i = desde; i < hasta; i++) {
+                const Miembro* a = (*miembros)[2 * i];
+                const Miembro* b = (*miembros)[2 * i + 1];
+                (*resultados)[i] = a == NULL || b == NULL ? Parentesco() : linaje->parentesco(a, b);
+            }
+        }
+    }
+};
+
+/* ---------------------------
+   CLASE: ArbolGenealogico
+   Implementa un arbol AVL para gestionar miembros familiares
+   --------------------------- */
+class ArbolGenealogico {
+private:
+    Miembro* raiz;                  // Nodo raiz del arbol
+    deque<string> historial;        // Registro de operaciones (crecer no copia las entradas)
+    PoolNodos<Miembro> pool;        // Memoria de los nodos del arbol
+    unsigned long version;          // Cambia con cada insercion o eliminacion
+    MetricasOperacion metricas;     // Trabajo de la ultima operacion
+    IndiceCongelado congelado;      // Indice de solo lectura (ver congelar())
+    TablaSimbolos generos;          // Valores distintos de cada atributo
+    TablaSimbolos relaciones;
+    TablaSimbolos ocupaciones;
+    TablaSimbolos lugares;
+    vector< vector<Miembro*> > porRelacion; // Miembros de cada id de relacion
+    Miembro* raizEdad;              // Raiz del indice por (edad, nombre)
+    IndiceLinaje linaje;            // Euler + tabla dispersa de los enlaces de linaje
+    int enlacesLinaje;              // Miembros con progenitor
+    vector<Miembro*>* retenidos;    // No NULL: los eliminados esperan aqui (ver retenerEliminados)
+
+    DiarioOperaciones diario;       // Abierto solo con persistencia activa
+    string rutaPersistencia;        // Instantanea que acompana al diario
+    unsigned long long secuenciaInstantanea; // Ultima operacion incluida en ella
+
+    // No copiable: los nodos pertenecen al pool de este arbol
+    ArbolGenealogico(const ArbolGenealogico&);
+    ArbolGenealogico& operator=(const ArbolGenealogico&);
+
+    /**
+     * Crea un nodo dentro del pool del arbol y lo registra en los indices
+     * @return Nuevo miembro con altura 1 y sin hijos
+     */
+    Miembro* crearMiembro(const string &nombre, int edad,
+                          const string &genero, const string &relacion,
+                          const string &ocupacion, const string &lugar)
+    {
+        Miembro* m = new (pool.reservar()) Miembro(nombre, edad,
+            generos.internar(genero), relaciones.internar(relacion),
+            ocupaciones.internar(ocupacion), lugares.internar(lugar));
+        indexarMiembro(m);
+        return m;
+    }
+
+    /**
+     * Crea un nodo tomando el nombre por intercambio, sin copiarlo
+     * Los atributos se internan: si el valor ya existe no se copia nada
+     * @param nombre Nombre que pasa al nodo; queda vacio
+     */
+    Miembro* crearMiembroMoviendo(string &nombre, int edad,
+                                  const string &genero, const string &relacion,
+                                  const string &ocupacion, const string &lugar)
+    {
+        Miembro* m = crearMiembro(string(), edad, genero, relacion, ocupacion, lugar);
+        m->nombre.swap(nombre);
+        m->prefijo = prefijoClave(m->nombre);
+        m->prefijo2 = prefijoClave(m->nombre, 8);
+        m->prefijo3 = prefijoClave(m->nombre, 16);
+        return m;
+    }
+
+    /**
+     * Registra un miembro en el indice de su relacion, O(1)
+     * @param m Miembro a registrar
+     */
+    void indexarMiembro(Miembro* m) {
+        if (m->idRelacion >= porRelacion.size()) porRelacion.resize(m->idRelacion + 1);
+        vector<Miembro*> &lista = porRelacion[m->idRelacion];
+        m->posicionRelacion = (int)lista.size();
+        lista.push_back(m);
+    }
+
+    /**
+     * Quita un miembro del indice de su relacion, O(1)
+     * El ultimo de la lista ocupa su lugar (el orden no importa)
+     * @param m Miembro a quitar
+     */
+    void desindexarMiembro(Miembro* m) {
+        if (m->posicionRelacion < 0) return;
+        vector<Miembro*> &lista = porRelacion[m->idRelacion];
+        Miembro* ultimo = lista.back();
+        lista[m->posicionRelacion] = ultimo;
+        ultimo->posicionRelacion = m->posicionRelacion;
+        lista.pop_back();
+        m->posicionRelacion = -1;
+    }
+
+    /* ========== INDICE POR EDAD ========== */
+
+    /**
+     * Compara dos miembros por (edad, nombre) en tres vias
+     * A igual edad decide el nombre, con los prefijos cacheados primero
+     */
+    static int compararEdadNombre(const Miembro* a, const Miembro* b) {
+        if (a->edad != b->edad) return a->edad < b->edad ? -1 : 1;
+        if (a->prefijo != b->prefijo) return a->prefijo < b->prefijo ? -1 : 1;
+        if (a->prefijo2 != b->prefijo2) return a->prefijo2 < b->prefijo2 ? -1 : 1;
+        if (a->prefijo3 != b->prefijo3) return a->prefijo3 < b->prefijo3 ? -1 : 1;
+        return a->nombre.compare(b->nombre);
+    }
+
+    static int alturaEdad(const Miembro* m) { return m == NULL ? 0 : m->edadAltura; }
+    static int tamanoEdad(const Miembro* m) { return m == NULL ? 0 : m->edadTamano; }
+
+    static void actualizarEdad(Miembro* m) {
+        int altIzq = alturaEdad(m->edadIzquierdo);
+        int altDer = alturaEdad(m->edadDerecho);
+        m->edadAltura = 1 + (altIzq > altDer ? altIzq : altDer);
+        m->edadTamano = 1 + tamanoEdad(m->edadIzquierdo) + tamanoEdad(m->edadDerecho);
+    }
+
+    static Miembro* rotarEdadDerecha(Miembro* y) {
+        Miembro* x = y->edadIzquierdo;
+        y->edadIzquierdo = x->edadDerecho;
+        x->edadDerecho = y;
+        actualizarEdad(y);
+        actualizarEdad(x);
+        return x;
+    }
+
+    static Miembro* rotarEdadIzquierda(Miembro* x) {
+        Miembro* y = x->edadDerecho;
+        x->edadDerecho = y->edadIzquierdo;
+        y->edadIzquierdo = x;
+        actualizarEdad(x);
+        actualizarEdad(y);
+        return y;
+    }
+
+    /**
+     * Recalcula un nodo del indice por edad y lo rota si quedo
+     * desbalanceado (los mismos 4 casos que balancear)
+     * @return Nueva raiz del subarbol
+     */
+    static Miembro* balancearEdad(Miembro* m) {
+        actualizarEdad(m);
+        int balance = alturaEdad(m->edadIzquierdo) - alturaEdad(m->edadDerecho);
+        if (balance > 1) {
+            Miembro* iz = m->edadIzquierdo;
+            if (alturaEdad(iz->edadIzquierdo) < alturaEdad(iz->edadDerecho))
+                m->edadIzquierdo = rotarEdadIzquierda(iz);
+            return rotarEdadDerecha(m);
+        }
+        if (balance < -1) {
+            Miembro* dr = m->edadDerecho;
+            if (alturaEdad(dr->edadDerecho) < alturaEdad(dr->edadIzquierdo))
+                m->edadDerecho = rotarEdadDerecha(dr);
+            return rotarEdadIzquierda(m);
+        }
+        return m;
+    }
+
+    /**
+     * Agrega un miembro al indice por edad, O(log n)
+     * Misma tecnica que el arbol principal: pila de enlaces del camino
+     * y rebalanceo de abajo hacia arriba
+     */
+    void insertarEnIndiceEdad(Miembro* m) {
+        Miembro** pila[ALTURA_MAXIMA];
+        int tope = 0;
+        Miembro** enlace = &raizEdad;
+        while (*enlace != NULL) {
+            pila[tope++] = enlace;
+            enlace = compararEdadNombre(m, *enlace) < 0 ? &(*enlace)->edadIzquierdo
+                                                         : &(*enlace)->edadDerecho;
+        }
+        m->edadIzquierdo = NULL;
+        m->edadDerecho = NULL;
+        m->edadAltura = 1;
+        m->edadTamano = 1;
+        *enlace = m;
+        while (tope > 0) {
+            --tope;
+            *pila[tope] = balancearEdad(*pila[tope]);
+        }
+    }
+
+    /**
+     * Quita un miembro del indice por edad, O(log n)
+     * Se busca por su (edad, nombre) actual: hay que quitarlo antes de
+     * cambiarle la edad. Con dos hijos, su sucesor se reenlaza en su
+     * lugar (los nodos son los del arbol principal, no se copian datos)
+     */
+    void quitarDeIndiceEdad(Miembro* m) {
+        Miembro** pila[ALTURA_MAXIMA];
+        int tope = 0;
+        Miembro** enlace = &raizEdad;
+        while (*enlace != NULL && *enlace != m) {
+            pila[tope++] = enlace;
+            enlace = compararEdadNombre(m, *enlace) < 0 ? &(*enlace)->edadIzquierdo
+                                                         : &(*enlace)->edadDerecho;
+        }
+        if (*enlace == NULL) return;
+
+        if (m->edadIzquierdo == NULL) {
+            *enlace = m->edadDerecho;
+        } else if (m->edadDerecho == NULL) {
+            *enlace = m->edadIzquierdo;
+        } else {
+            int lugarSucesor = tope;
+            pila[tope++] = enlace;
+            Miembro** enlaceSucesor = &m->edadDerecho;
+            while ((*enlaceSucesor)->edadIzquierdo != NULL) {
+                pila[tope++] = enlaceSucesor;
+                enlaceSucesor = &(*enlaceSucesor)->edadIzquierdo;
+            }
+            Miembro* sucesor = *enlaceSucesor;
+            *enlaceSucesor = sucesor->edadDerecho;
+            sucesor->edadIzquierdo = m->edadIzquierdo;
+            sucesor->edadDerecho = m->edadDerecho;
+            *enlace = sucesor;
+            // El camino bajaba por el enlace derecho de m: ahora es el del sucesor
+            if (tope > lugarSucesor + 1) pila[lugarSucesor + 1] = &sucesor->edadDerecho;
+        }
+        while (tope > 0) {
+            --tope;
+            *pila[tope] = balancearEdad(*pila[tope]);
+        }
+        m->edadIzquierdo = NULL;
+        m->edadDerecho = NULL;
+    }
+
+    /**
+     * Enlaza nodos ordenados por (edad, nombre) en un indice balanceado
+     */
+    static Miembro* enlazarIndiceEdad(vector<Miembro*> &nodos, int inicio, int fin) {
+        if (inicio >= fin) return NULL;
+        int medio = inicio + (fin - inicio) / 2;
+        Miembro* m = nodos[medio];
+        m->edadIzquierdo = enlazarIndiceEdad(nodos, inicio, medio);
+        m->edadDerecho = enlazarIndiceEdad(nodos, medio + 1, fin);
+        actualizarEdad(m);
+        return m;
+    }
+
+    /**
+     * Reconstruye el indice por edad despues de una carga masiva, O(n)
+     * Los nodos llegan en orden alfabetico: un ordenamiento por conteo
+     * estable sobre la edad deja el orden (edad, nombre)
+     * @param porNombre Todos los miembros del arbol en orden alfabetico
+     */
+    void construirIndiceEdad(const vector<Miembro*> &porNombre) {
+        raizEdad = NULL;
+        if (porNombre.empty()) return;
+        int minima = porNombre[0]->edad, maxima = minima;
+        for (size_t i = 1; i < porNombre.size(); i++) {
+            if (porNombre[i]->edad < minima) minima = porNombre[i]->edad;
+            if (porNombre[i]->edad > maxima) maxima = porNombre[i]->edad;
+        }
+        vector<Miembro*> ordenados(porNombre.size());
+        if ((long long)maxima - minima <= 4096) {
+            vector<int> inicio(maxima - minima + 2, 0);
+            for (size_t i = 0; i < porNombre.size(); i++) inicio[porNombre[i]->edad - minima + 1]++;
+            for (size_t e = 1; e < inicio.size(); e++) inicio[e] += inicio[e - 1];
+            for (size_t i = 0; i < porNombre.size(); i++)
+                ordenados[inicio[porNombre[i]->edad - minima]++] = porNombre[i];
+        } else {
+            ordenados = porNombre;
+            stable_sort(ordenados.begin(), ordenados.end(), edadMenor);
+        }
+        raizEdad = enlazarIndiceEdad(ordenados, 0, (int)ordenados.size());
+    }
+
+    static bool edadMenor(const Miembro* a, const Miembro* b) {
+        return a->edad < b->edad;
+    }
+
+    /**
+     * Destruye un nodo y devuelve su ranura al pool (o lo retiene, si
+     * hay lectores sin cerrojo que todavia pueden estar en el)
+     * No toca los indices: el llamador debe desindexarlo antes
+     * @param m Miembro a destruir
+     */
+    void destruirMiembro(Miembro* m) {
+        if (retenidos != NULL) {
+            retenidos->push_back(m);
+            return;
+        }
+        m->~Miembro();
+        pool.liberar(m);
+    }
+
+    /**
+     * Destruye todos los nodos de un subarbol (sin recursion)
+     * Los strings deben destruirse uno por uno; la memoria de los
+     * nodos se devuelve despues en bloque con pool.liberarTodo()
+     * @param nodo Raiz del subarbol
+     */
+    void destruirSubarbol(Miembro* nodo) {
+        vector<Miembro*> pendientes;
+        if (nodo != NULL) pendientes.push_back(nodo);
+        while (!pendientes.empty()) {
+            Miembro* actual = pendientes.back();
+            pendientes.pop_back();
+            if (actual->izquierdo) pendientes.push_back(actual->izquierdo);
+            if (actual->derecho) pendientes.push_back(actual->derecho);
+            actual->~Miembro();
+            pool.descartar(actual);
+        }
+    }
+
+    /**
+     * Tramo inorden: baja directamente al primer miembro usando los
+     * tamanos y luego avanza por sucesores con una pila acotada
+     */
+    template <class Visita>
+    int tramoInorden(int desplazamiento, int limite, Visita &visita) const {
+        Miembro* pila[ALTURA_MAXIMA + 1];
+        int tope = 0, visitados = 0;
+        Miembro* actual = raiz;
+        int saltar = desplazamiento;
+        while (actual != NULL) {
+            int izq = obtenerTamano(actual->izquierdo);
+            if (saltar < izq) {
+                pila[tope++] = actual;          // Pendiente: mayor que el tramo
+                actual = actual->izquierdo;
+            } else if (saltar == izq) {
+                pila[tope++] = actual;          // Primer miembro del tramo
+                break;
+            } else {
+                saltar -= izq + 1;
+                actual = actual->derecho;
+            }
+        }
+
+        while (tope > 0 && visitados < limite) {
+            Miembro* nodo = pila[--tope];
+            visita(nodo);
+            visitados++;
+            for (Miembro* c = nodo->derecho; c != NULL; c = c->izquierdo)
+                pila[tope++] = c;
+        }
+        return visitados;
+    }
+
+    /**
+     * Tramo preorden: un subarbol es contiguo en preorden, si cabe
+     * entero en el desplazamiento pendiente se salta sin visitarlo
+     */
+    template <class Visita>
+    int tramoPreorden(int desplazamiento, int limite, Visita &visita) const {
+        Miembro* pila[ALTURA_MAXIMA + 1];
+        int tope = 0, visitados = 0;
+        int saltar = desplazamiento;
+        if (raiz != NULL) pila[tope++] = raiz;
+        while (tope > 0 && visitados < limite) {
+            Miembro* nodo = pila[--tope];
+            if (saltar >= nodo->tamano) {
+                saltar -= nodo->tamano;
+                continue;
+            }
+            if (saltar > 0) saltar--;
+            else {
+                visita(nodo);
+                visitados++;
+            }
+            if (nodo->derecho) pila[tope++] = nodo->derecho;
+            if (nodo->izquierdo) pila[tope++] = nodo->izquierdo;
+        }
+        return visitados;
+    }
+
+    /**
+     * Tramo postorden: igual que en preorden, los subarboles completos
+     * se saltan
+     */
+    template <class Visita>
+    int tramoPostorden(int desplazamiento, int limite, Visita &visita) const {
+        // Cada entrada es un nodo y si sus hijos ya fueron apilados
+        Miembro* pila[2 * ALTURA_MAXIMA + 1];
+        bool expandido[2 * ALTURA_MAXIMA + 1];
+        int tope = 0, visitados = 0;
+        int saltar = desplazamiento;
+        if (raiz != NULL) {
+            pila[tope] = raiz;
+            expandido[tope++] = false;
+        }
+        while (tope > 0 && visitados < limite) {
+            --tope;
+            Miembro* nodo = pila[tope];
+            if (expandido[tope]) {
+                if (saltar > 0) saltar--;
+                else {
+                    visita(nodo);
+                    visitados++;
+                }
+                continue;
+            }
+            if (saltar >= nodo->tamano) {
+                saltar -= nodo->tamano;
+                continue;
+            }
+            pila[tope] = nodo;
+            expandido[tope++] = true;
+            if (nodo->derecho) {
+                pila[tope] = nodo->derecho;
+                expandido[tope++] = false;
+            }
+            if (nodo->izquierdo) {
+                pila[tope] = nodo->izquierdo;
+                expandido[tope++] = false;
+            }
+        }
+        return visitados;
+    }
+
+    /**
+     * Recorrido Preorden: Raiz -> Izquierdo -> Derecho
+     * Util para mostrar jerarquia de ancestros a descendientes
+     */
+    void preordenRec(BufferSalida &salida, Miembro* nodo, int &contador) {
+        if (nodo == NULL) return;
+        imprimirLineaEnumerada(salida, nodo, contador);
+        contador++;
+        preordenRec(salida, nodo->izquierdo, contador);
+        preordenRec(salida, nodo->derecho, contador);
+    }
+
+    /**
+     * Recorrido Inorden: Izquierdo -> Raiz -> Derecho
+     * Muestra los miembros en orden alfabetico
+     */
+    void inordenRec(BufferSalida &salida, Miembro* nodo, int &contador) {
+        if (nodo == NULL) return;
+        inordenRec(salida, nodo->izquierdo, contador);
+        imprimirLineaEnumerada(salida, nodo, contador);
+        contador++;
+        inordenRec(salida, nodo->derecho, contador);
+    }
+
+    /**
+     * Recorrido Postorden: Izquierdo -> Derecho -> Raiz
+     * Util para mostrar de descendientes hacia ancestros
+     */
+    void postordenRec(BufferSalida &salida, Miembro* nodo, int &contador) {
+        if (nodo == NULL) return;
+        postordenRec(salida, nodo->izquierdo, contador);
+        postordenRec(salida, nodo->derecho, contador);
+        imprimirLineaEnumerada(salida, nodo, contador);
+        contador++;
+    }
+
+    /**
+     * Imprime la cabecera de las tablas de miembros
+     */
+    void imprimirCabeceraTabla(BufferSalida &salida) {
+        salida.texto("\n-----------------------------------------------------------------\n");
+        salida.columna("No.", 3, 4)
+              .columna("Nombre", 6, 22)
+              .columna("Relacion", 8, 22)
+              .columna("Edad", 4, 8)
+              .columna("Ocupacion", 9, 20)
+              .finLinea();
+        salida.texto("-----------------------------------------------------------------\n");
+    }
+
+    /**
+     * Imprime una fila con los datos de un miembro
+     * Mismas columnas que la cabecera, sin strings temporales
+     * @param salida Buffer donde se escribe la fila
+     * @param m Puntero al miembro
+     * @param num Numero de fila
+     */
+    void imprimirLineaEnumerada(BufferSalida &salida, Miembro* m, int num) {
+        if (m == NULL) return;
+        salida.columnaEntero(num, ".", 4)
+              .columna(m->nombre, 22)
+              .columna(relaciones.texto(m->idRelacion), 22)
+              .columnaEntero(m->edad, " anos", 8)
+              .columna(ocupaciones.texto(m->idOcupacion), 20)
+              .finLinea();
+    }
+
+    /**
+     * Convierte un entero a string (compatible con C++98)
+     * @param x Numero a convertir
+     * @return String con el numero
+     */
+    string toStringNum(int x) {
+        char buffer[20];
+        sprintf(buffer, "%d", x);
+        return string(buffer);
+    }
+
+    /* ========== FUNCIONES AVL ========== */
+
+    /**
+     * Obtiene la altura de un nodo
+     * @param nodo Nodo a consultar
+     * @return Altura del nodo (0 si es NULL)
+     */
+    int obtenerAltura(Miembro* nodo) {
+        if (nodo == NULL) return 0;
+        return nodo->altura;
+    }
+
+    /**
+     * Calcula el factor de balance de un nodo
+     * Balance = Altura(izquierdo) - Altura(derecho)
+     * @param nodo Nodo a evaluar
+     * @return Factor de balance (-1, 0, 1 en arbol balanceado)
+     */
+    int obtenerBalance(Miembro* nodo) {
+        if (nodo == NULL) return 0;
+        return obtenerAltura(nodo->izquierdo) - obtenerAltura(nodo->derecho);
+    }
+
+    /**
+     * Obtiene la cantidad de miembros de un subarbol
+     * @param nodo Raiz del subarbol
+     * @return Tamano del subarbol (0 si es NULL)
+     */
+    int obtenerTamano(Miembro* nodo) const {
+        if (nodo == NULL) return 0;
+        return nodo->tamano;
+    }
+
+    /**
+     * Actualiza altura, tamano y agregados de edad de un nodo
+     * basandose en sus hijos (O(1))
+     * @param nodo Nodo a actualizar
+     */
+    void actualizarNodo(Miembro* nodo) {
+        if (nodo == NULL) return;
+        Miembro* iz = nodo->izquierdo;
+        Miembro* dr = nodo->derecho;
+        int altIzq = obtenerAltura(iz);
+        int altDer = obtenerAltura(dr);
+        nodo->altura = 1 + (altIzq > altDer ? altIzq : altDer);
+        nodo->tamano = 1 + obtenerTamano(iz) + obtenerTamano(dr);
+        nodo->sumaEdades = nodo->edad;
+        nodo->edadMinima = nodo->edad;
+        nodo->edadMaxima = nodo->edad;
+        if (iz != NULL) {
+            nodo->sumaEdades += iz->sumaEdades;
+            if (iz->edadMinima < nodo->edadMinima) nodo->edadMinima = iz->edadMinima;
+            if (iz->edadMaxima > nodo->edadMaxima) nodo->edadMaxima = iz->edadMaxima;
+        }
+        if (dr != NULL) {
+            nodo->sumaEdades += dr->sumaEdades;
+            if (dr->edadMinima < nodo->edadMinima) nodo->edadMinima = dr->edadMinima;
+            if (dr->edadMaxima > nodo->edadMaxima) nodo->edadMaxima = dr->edadMaxima;
+        }
+    }
+
+    /**
+     * Resumen de edades de un subarbol completo, O(1)
+     * @param nodo Raiz del subarbol
+     */
+    ResumenEdades resumenSubarbol(Miembro* nodo) const {
+        ResumenEdades r;
+        if (nodo == NULL) return r;
+        r.cantidad = nodo->tamano;
+        r.suma = nodo->sumaEdades;
+        r.minima = nodo->edadMinima;
+        r.maxima = nodo->edadMaxima;
+        return r;
+    }
+
+    /**
+     * Resumen de los miembros de un subarbol con nombre >= desde
+     * Baja por un solo camino sumando subarboles completos: O(log n)
+     */
+    ResumenEdades resumenDesde(Miembro* nodo, const string &desde) const {
+        ResumenEdades r;
+        while (nodo != NULL) {
+            if (nodo->nombre.compare(desde) >= 0) {
+                r.agregarEdad(nodo->edad);
+                r.agregar(resumenSubarbol(nodo->derecho));
+                nodo = nodo->izquierdo;
+            } else {
+                nodo = nodo->derecho;
+            }
+        }
+        return r;
+    }
+
+    /**
+     * Resumen de los miembros de un subarbol con nombre <= hasta, O(log n)
+     */
+    ResumenEdades resumenHasta(Miembro* nodo, const string &hasta) const {
+        ResumenEdades r;
+        while (nodo != NULL) {
+            if (nodo->nombre.compare(hasta) <= 0) {
+                r.agregarEdad(nodo->edad);
+                r.agregar(resumenSubarbol(nodo->izquierdo));
+                nodo = nodo->derecho;
+            } else {
+                nodo = nodo->izquierdo;
+            }
+        }
+        return r;
+    }
+
+    /**
+     * Rotacion simple a la derecha (caso LL)
+     * Se usa cuando el subarbol izquierdo esta desbalanceado a la izquierda
+     * @param y Nodo desbalanceado
+     * @return Nueva raiz del subarbol
+     */
+    Miembro* rotacionDerecha(Miembro* y) {
+        metricas.rotaciones++;
+        Miembro* x = y->izquierdo;
+        Miembro* T2 = x->derecho;
+
+        x->derecho = y;
+        y->izquierdo = T2;
+
+        actualizarNodo(y);
+        actualizarNodo(x);
+
+        return x;
+    }
+
+    /**
+     * Rotacion simple a la izquierda (caso RR)
+     * Se usa cuando el subarbol derecho esta desbalanceado a la derecha
+     * @param x Nodo desbalanceado
+     * @return Nueva raiz del subarbol
+     */
+    Miembro* rotacionIzquierda(Miembro* x) {
+        metricas.rotaciones++;
+        Miembro* y = x->derecho;
+        Miembro* T2 = y->izquierdo;
+
+        y->izquierdo = x;
+        x->derecho = T2;
+
+        actualizarNodo(x);
+        actualizarNodo(y);
+
+        return y;
+    }
+
+    /**
+     * Balancea un nodo aplicando las rotaciones necesarias
+     * Maneja los 4 casos: LL, RR, LR, RL
+     * @param nodo Nodo a balancear
+     * @return Nodo balanceado
+     */
+    Miembro* balancear(Miembro* nodo) {
+        if (nodo == NULL) return nodo;
+
+        actualizarNodo(nodo);
+        int balance = obtenerBalance(nodo);
+
+        // Caso LL: Rotacion derecha
+        if (balance > 1 && obtenerBalance(nodo->izquierdo) >= 0)
+            return rotacionDerecha(nodo);
+
+        // Caso LR: Rotacion izquierda-derecha
+        if (balance > 1 && obtenerBalance(nodo->izquierdo) < 0) {
+            nodo->izquierdo = rotacionIzquierda(nodo->izquierdo);
+            return rotacionDerecha(nodo);
+        }
+
+        // Caso RR: Rotacion izquierda
+        if (balance < -1 && obtenerBalance(nodo->derecho) <= 0)
+            return rotacionIzquierda(nodo);
+
+        // Caso RL: Rotacion derecha-izquierda
+        if (balance < -1 && obtenerBalance(nodo->derecho) > 0) {
+            nodo->derecho = rotacionDerecha(nodo->derecho);
+            return rotacionIzquierda(nodo);
+        }
+
+        return nodo;
+    }
+
+    /**
+     * Busca un nombre y recuerda el camino recorrido (sin recursion)
+     * Una sola comparacion de tres vias por nivel, casi siempre resuelta
+     * con el prefijo cacheado del nodo
+     * @param nombre Nombre a localizar
+     * @return Posicion del miembro, o del hueco donde iria si no existe
+     */
+    PosicionMiembro descender(const string &nombre) {
+        PosicionMiembro pos;
+        pos.version = version;
+        ClaveBusqueda clave(nombre);
+        Miembro* actual = raiz;
+        while (actual != NULL) {
+            metricas.comparaciones++;
+            int c = compararClave(clave, actual, metricas.comparacionesCompletas);
+            if (c == 0) break;
+            if (c > 0) {
+                pos.ruta |= (1ULL << pos.profundidad);
+                actual = actual->derecho;
+            } else {
+                actual = actual->izquierdo;
+            }
+            pos.profundidad++;
+        }
+        pos.nodo = actual;
+        return pos;
+    }
+
+    /**
+     * Recorre la ruta de una posicion guardando los enlaces visitados
+     * No compara nombres: solo sigue los bits de la ruta
+     * @param pos Posicion vigente
+     * @param pila Recibe la direccion de cada enlace padre -> hijo
+     * @return Enlace final (al nodo de la posicion o al hueco)
+     */
+    Miembro** seguirRuta(const PosicionMiembro &pos, Miembro** pila[]) {
+        Miembro** enlace = &raiz;
+        for (int nivel = 0; nivel < pos.profundidad; nivel++) {
+            pila[nivel] = enlace;
+            Miembro* nodo = *enlace;
+            enlace = ((pos.ruta >> nivel) & 1ULL) ? &nodo->derecho : &nodo->izquierdo;
+        }
+        return enlace;
+    }
+
+    /**
+     * Rebalancea de abajo hacia arriba los nodos de la pila
+     * Deja de revisar el balance en cuanto un subarbol conserva su
+     * altura: a partir de ahi ningun ancestro puede desbalancearse y
+     * solo se actualiza su tamano
+     * @param pila Enlaces desde la raiz hasta el punto modificado
+     * @param tope Cantidad de enlaces en la pila
+     */
+    void rebalancearCamino(Miembro** pila[], int tope) {
+        bool balanceando = true;
+        while (tope > 0) {
+            Miembro** enlace = pila[--tope];
+            if (balanceando) {
+                int alturaPrevia = (*enlace)->altura;
+                *enlace = balancear(*enlace);
+                if ((*enlace)->altura == alturaPrevia) balanceando = false;
+            } else {
+                actualizarNodo(*enlace);
+            }
+        }
+    }
+
+    /**
+     * Inserta un nodo nuevo en el hueco de una posicion y rebalancea
+     * @param nuevo Nuevo miembro a insertar
+     * @param pos Posicion vigente con nodo == NULL
+     */
+    void insertarNodo(Miembro* nuevo, const PosicionMiembro &pos) {
+        Miembro** pila[ALTURA_MAXIMA];
+        Miembro** enlace = seguirRuta(pos, pila);
+        // Un lector sin cerrojo que llegue al nodo lo ve ya construido
+        barreraMemoria();
+        *enlace = nuevo;
+        rebalancearCamino(pila, pos.profundidad);
+        insertarEnIndiceEdad(nuevo);
+        version++;
+    }
+
+    /**
+     * Elimina el nodo de una posicion y rebalancea
+     * @param pos Posicion vigente con nodo != NULL
+     */
+    void eliminarNodo(const PosicionMiembro &pos) {
+        Miembro** pila[ALTURA_MAXIMA];
+        Miembro** enlace = seguirRuta(pos, pila);
+        int tope = pos.profundidad;
+        Miembro* nodo = *enlace;
+
+        desindexarMiembro(nodo);
+        quitarDeIndiceEdad(nodo);
+        soltarLinaje(nodo);
+
+        // Caso 1: Nodo sin hijo izquierdo
+        if (nodo->izquierdo == NULL) {
+            *enlace = nodo->derecho;
+            destruirMiembro(nodo);
+        }
+        // Caso 2: Nodo sin hijo derecho
+        else if (nodo->derecho == NULL) {
+            *enlace = nodo->izquierdo;
+            destruirMiembro(nodo);
+        }
+        // Caso 3: Nodo con dos hijos: el sucesor inorden se reenlaza en
+        // su lugar. No se copian datos, asi los punteros a los demas
+        // miembros (y sus lugares en los indices) siguen valiendo
+        else {
+            int lugarNodo = tope;
+            pila[tope++] = enlace;
+            Miembro** enlaceSucesor = &nodo->derecho;
+            while ((*enlaceSucesor)->izquierdo != NULL) {
+                pila[tope++] = enlaceSucesor;
+                enlaceSucesor = &(*enlaceSucesor)->izquierdo;
+            }
+            Miembro* sucesor = *enlaceSucesor;
+            *enlaceSucesor = sucesor->derecho;
+            sucesor->izquierdo = nodo->izquierdo;
+            sucesor->derecho = nodo->derecho;
+            // rebalancearCamino corta cuando un subarbol conserva su
+            // altura: la referencia en este lugar es la del nodo que se va
+            sucesor->altura = nodo->altura;
+            *enlace = sucesor;
+            // El camino bajaba por el enlace derecho del nodo: ahora es el del sucesor
+            if (tope > lugarNodo + 1) pila[lugarNodo + 1] = &sucesor->derecho;
+            destruirMiembro(nodo);
+        }
+
+        rebalancearCamino(pila, tope);
+        version++;
+    }
+
+    /* ========== LINAJE ========== */
+
+    /**
+     * Agrega un hijo al comienzo de la lista de su progenitor, O(1)
+     * @param hijo Miembro sin progenitor
+     * @param nuevo Progenitor
+     */
+    void enlazarHijo(Miembro* hijo, Miembro* nuevo) {
+        hijo->progenitor = nuevo;
+        hijo->siguienteHermano = nuevo->primerHijo;
+        nuevo->primerHijo = hijo;
+        enlacesLinaje++;
+        linaje.invalidar();
+    }
+
+    /**
+     * Quita a un miembro de la lista de hijos de su progenitor
+     * O(hermanos)
+     * @param hijo Miembro con progenitor
+     */
+    void desenlazarHijo(Miembro* hijo) {
+        Miembro** enlace = &hijo->progenitor->primerHijo;
+        while (*enlace != hijo) enlace = &(*enlace)->siguienteHermano;
+        *enlace = hijo->siguienteHermano;
+        hijo->progenitor = NULL;
+        hijo->siguienteHermano = NULL;
+        enlacesLinaje--;
+        linaje.invalidar();
+    }
+
+    /**
+     * Corta todos los enlaces de linaje de un miembro que se elimina:
+     * sale de la lista de su progenitor y sus hijos quedan sin progenitor
+     * (cada uno pasa a ser raiz de su propio linaje)
+     * @param m Miembro a eliminar
+     */
+    void soltarLinaje(Miembro* m) {
+        if (m->progenitor != NULL) desenlazarHijo(m);
+        while (m->primerHijo != NULL) desenlazarHijo(m->primerHijo);
+    }
+
+    /**
+     * Comprueba si a es ancestro de b siguiendo los progenitores de b
+     * Se usa cuando el indice no esta vigente, O(generaciones)
+     */
+    static bool esAncestroSubiendo(const Miembro* a, const Miembro* b) {
+        for (; b != NULL; b = b->progenitor)
+            if (b == a) return true;
+        return false;
+    }
+
+    /**
+     * Generaciones desde un miembro hasta la raiz de su linaje
+     * siguiendo los progenitores, O(generaciones)
+     */
+    static int generacionesSubiendo(const Miembro* m) {
+        int g = 0;
+        for (m = m->progenitor; m != NULL; m = m->progenitor) g++;
+        return g;
+    }
+
+    /* ========== DIARIO DE OPERACIONES ========== */
+
+    /**
+     * Agrega una operacion al diario (si la persistencia esta activa)
+     * y compacta cuando el diario pasa el umbral
+     * @param tipo Tipo de operacion
+     * @param d Argumentos completos
+     */
+    void registrar(TipoOperacion tipo, const DatosMiembro &d) {
+        registrar(tipo, d.nombre, d);
+    }
+
+    /**
+     * Igual que registrar(tipo, d), con el nombre aparte (d.nombre no
+     * se lee). Se llama despues de aplicar el cambio al arbol: si el
+     * registro dispara la compactacion, la instantanea ya lo incluye
+     */
+    void registrar(TipoOperacion tipo, const string &nombre, const DatosMiembro &d) {
+        if (!diario.estaAbierto()) return;
+        diario.agregar(tipo, nombre, d);
+        if (diario.tamano() >= UMBRAL_COMPACTACION) compactarDiario();
+    }
+
+    /**
+     * Libera todos los miembros, indices y tablas (sin tocar el diario)
+     */
+    void descartarMiembros() {
+        destruirSubarbol(raiz);
+        raiz = NULL;
+        pool.liberarTodo();
+        congelado.liberar();
+        porRelacion.clear();
+        raizEdad = NULL;
+        linaje.liberar();
+        enlacesLinaje = 0;
+        generos.limpiar();
+        relaciones.limpiar();
+        ocupaciones.limpiar();
+        lugares.limpiar();
+        version++;
+    }
+
+    /* ========== CARGA MASIVA ========== */
+
+    /**
+     * Enlaza nodos ya ordenados en un subarbol perfectamente balanceado
+     * Cada nodo se visita una vez: O(n), sin comparaciones ni rotaciones
+     * @param nodos Nodos ordenados por nombre
+     * @param inicio Primer indice (incluido)
+     * @param fin Ultimo indice (excluido)
+     * @return Raiz del subarbol construido
+     */
+    Miembro* construirBalanceado(vector<Miembro*> &nodos, int inicio, int fin) {
+        if (inicio >= fin) return NULL;
+        int medio = inicio + (fin - inicio) / 2;
+        Miembro* nodo = nodos[medio];
+        nodo->izquierdo = construirBalanceado(nodos, inicio, medio);
+        nodo->derecho = construirBalanceado(nodos, medio + 1, fin);
+        actualizarNodo(nodo);
+        return nodo;
+    }
+
+    /**
+     * Guarda los nodos del arbol en orden alfabetico (sin recursion)
+     * @param salida Vector donde se agregan los nodos
+     */
+    void aplanarInorden(vector<Miembro*> &salida) {
+        vector<Miembro*> pila;
+        Miembro* actual = raiz;
+        while (actual != NULL || !pila.empty()) {
+            while (actual != NULL) {
+                pila.push_back(actual);
+                actual = actual->izquierdo;
+            }
+            actual = pila.back();
+            pila.pop_back();
+            salida.push_back(actual);
+            actual = actual->derecho;
+        }
+    }
+
+    /**
+     * Deja un lote ordenado por nombre, sin nombres vacios ni repetidos
+     * Si ya viene ordenado solo se verifica en O(n)
+     * Ante repetidos se conserva la primera aparicion del lote
+     * @param lote Registros a preparar (se modifica en el lugar)
+     */
+    void prepararLote(vector<DatosMiembro> &lote) {
+        bool ordenado = true;
+        for (size_t i = 0; i < lote.size() && ordenado; i++) {
+            if (lote[i].nombre.empty()) ordenado = false;
+            else if (i > 0 && !(lote[i-1].nombre < lote[i].nombre)) ordenado = false;
+        }
+        if (ordenado) return;
+
+        stable_sort(lote.begin(), lote.end(), menorPorNombre);
+        size_t destino = 0;
+        for (size_t i = 0; i < lote.size(); i++) {
+            if (lote[i].nombre.empty()) continue;
+            if (destino > 0 && lote[destino-1].nombre == lote[i].nombre) continue;
+            if (destino != i) lote[destino] = lote[i];
+            destino++;
+        }
+        lote.resize(destino);
+    }
+
+    /**
+     * Crea el nodo de un registro del lote
+     */
+    Miembro* crearDesdeDatos(const DatosMiembro &d) {
+        return crearMiembro(d.nombre, d.edad, d.genero, d.relacionFamiliar,
+                            d.ocupacion, d.lugarNacimiento);
+    }
+
+    /**
+     * Crea el nodo de un registro que ya no se usara: el nombre se
+     * mueve al nodo (d.nombre queda vacio)
+     */
+    Miembro* crearDesdeDatos(DatosMiembro &d) {
+        return crearMiembroMoviendo(d.nombre, d.edad, d.genero, d.relacionFamiliar,
+                                    d.ocupacion, d.lugarNacimiento);
+    }
+
+    /**
+     * Construccion O(n) comun a las dos versiones publicas de
+     * construirDesdeRegistros: con punteros a const los nombres se
+     * copian, sin const se mueven (ver crearDesdeDatos)
+     */
+    template <class Registro>
+    int construirDesdePunteros(const vector<Registro*> &ordenados) {
+        for (size_t i = 0; i < ordenados.size(); i++) {
+            if (ordenados[i]->nombre.empty()) return -1;
+            if (i > 0 && !(ordenados[i-1]->nombre < ordenados[i]->nombre)) return -1;
+        }
+        descartarMiembros();
+
+        vector<Miembro*> nodos;
+        nodos.reserve(ordenados.size());
+        for (size_t i = 0; i < ordenados.size(); i++)
+            nodos.push_back(crearDesdeDatos(*ordenados[i]));
+        raiz = construirBalanceado(nodos, 0, (int)nodos.size());
+        construirIndiceEdad(nodos);
+
+        historial.push_back(string("CONSTRUIR LOTE: ") + toStringNum((int)nodos.size()) + " miembros");
+        compactarDiario(); // Reemplazo total: mas barato guardar que registrar n operaciones
+        return (int)nodos.size();
+    }
+
+    /**
+     * Mezcla un lote ordenado con el arbol actual y reconstruye
+     * Costo O(n + k): aplanar, mezclar por nombre y volver a enlazar
+     * Ante nombres repetidos se conserva el miembro ya existente
+     * @param lote Registros ordenados y sin repetidos
+     * @return Cantidad de miembros nuevos
+     */
+    int mezclarYReconstruir(const vector<DatosMiembro> &lote) {
+        vector<Miembro*> existentes;
+        aplanarInorden(existentes);
+
+        vector<Miembro*> mezcla;
+        mezcla.reserve(existentes.size() + lote.size());
+        size_t i = 0, j = 0;
+        int nuevos = 0;
+        while (i < existentes.size() || j < lote.size()) {
+            if (j == lote.size()) {
+                mezcla.push_back(existentes[i++]);
+            } else if (i == existentes.size() || lote[j].nombre < existentes[i]->nombre) {
+                mezcla.push_back(crearDesdeDatos(lote[j++]));
+                nuevos++;
+            } else {
+                if (lote[j].nombre == existentes[i]->nombre) j++; // Ya existe
+                mezcla.push_back(existentes[i++]);
+            }
+        }
+
+        raiz = construirBalanceado(mezcla, 0, (int)mezcla.size());
+        construirIndiceEdad(mezcla);
+        version++;
+        return nuevos;
+    }
+
+    /* ========== FUNCIONES DE ESTADISTICAS ========== */
+
+    /**
+     * Verifica si el arbol cumple las propiedades AVL (sin recursion)
+     * @param nodo Nodo inicial
+     * @return true si esta balanceado, false en caso contrario
+     */
+    bool esAVLBalanceado(Miembro* nodo) {
+        Miembro* pila[ALTURA_MAXIMA + 1];
+        int tope = 0;
+        if (nodo != NULL) pila[tope++] = nodo;
+        while (tope > 0) {
+            Miembro* actual = pila[--tope];
+            int balance = obtenerBalance(actual);
+            if (balance < -1 || balance > 1) return false;
+            if (actual->derecho) pila[tope++] = actual->derecho;
+            if (actual->izquierdo) pila[tope++] = actual->izquierdo;
+        }
+        return true;
+    }
+
+/* ========== FUNCIONES DE VISUALIZACION DEL DIAGRAMA ========== */
+
+    /**
+     * Obtiene el nombre abreviado para el diagrama (primeras letras)
+     * @param nombre Nombre completo
+     * @return Nombre abreviado (max 3 caracteres)
+     */
+    string obtenerAbreviatura(const string &nombre) {
+        if (nombre.length() <= 3) return nombre;
+        
+        string abrev = "";
+        bool tomarLetra = true;
+        
+        for (size_t i = 0; i < nombre.length() && abrev.length() < 3; i++) {
+            if (nombre[i] == ' ') {
+                tomarLetra = true;
+            } else if (tomarLetra && nombre[i] != ' ') {
+                abrev += nombre[i];
+                tomarLetra = false;
+            }
+        }
+        
+        if (abrev.length() == 0) abrev = nombre.substr(0, 3);
+        return abrev;
+    }
+
+    /**
+     * Texto corto con la cantidad de miembros que no entran en la vista
+     * ("+37", "+12k", "+3M"): cabe en una celda del diagrama
+     */
+    string textoOcultos(int cantidad) {
+        if (cantidad < 10000) return "+" + toStringNum(cantidad);
+        if (cantidad < 10000000) return "+" + toStringNum(cantidad / 1000) + "k";
+        return "+" + toStringNum(cantidad / 1000000) + "M";
+    }
+
+    /**
+     * Imprime el arbol de forma horizontal (derecha arriba, izquierda abajo)
+     * Recorrido inorden inverso con pila acotada: la sangria se escribe
+     * como relleno, sin construir un string por nivel
+     * @param salida Buffer donde se escribe el diagrama
+     * @param inicio Raiz de la vista
+     * @param niveles Niveles a mostrar desde inicio
+     */
+    void imprimirArbolHorizontal(BufferSalida &salida, Miembro* inicio, int niveles) {
+        Miembro* pila[ALTURA_MAXIMA + 1];
+        int nivelPila[ALTURA_MAXIMA + 1];
+        bool izquierdoPila[ALTURA_MAXIMA + 1];
+        int tope = 0;
+        Miembro* actual = inicio;
+        int nivel = 0;
+        bool esIzquierdo = false;
+        while ((actual != NULL && nivel < niveles) || tope > 0) {
+            // Procesar primero el subarbol derecho (arriba en la visualizacion)
+            while (actual != NULL && nivel < niveles) {
+                pila[tope] = actual;
+                nivelPila[tope] = nivel;
+                izquierdoPila[tope++] = esIzquierdo;
+                actual = actual->derecho;
+                nivel++;
+                esIzquierdo = false;
+            }
+            --tope;
+            Miembro* nodo = pila[tope];
+
+            // Imprimir el nodo actual
+            salida.relleno(' ', 8 * nivelPila[tope]);
+            if (nivelPila[tope] > 0) {
+                salida.texto(izquierdoPila[tope] ? "\\_____ " : "/_____ ");
+            }
+            salida.caracter('[').texto(obtenerAbreviatura(nodo->nombre)).caracter(']');
+            if (nivelPila[tope] == niveles - 1 && nodo->tamano > 1)
+                salida.caracter(' ').texto(textoOcultos(nodo->tamano - 1));
+            salida.finLinea();
+
+            // Procesar el subarbol izquierdo (abajo en la visualizacion)
+            actual = nodo->izquierdo;
+            nivel = nivelPila[tope] + 1;
+            esIzquierdo = true;
+        }
+    }
+
+    /**
+     * Estructura para almacenar informacion de posicion de nodos
+     */
+    struct NodoPosicion {
+        Miembro* nodo;
+        int x;
+        NodoPosicion(Miembro* n, int px) : nodo(n), x(px) {}
+    };
+
+    /**
+     * Escribe una fila del diagrama (sin los espacios del final) y la
+     * deja en blanco para reutilizarla
+     */
+    void emitirFila(BufferSalida &salida, string &fila) {
+        size_t ultimo = fila.find_last_not_of(' ');
+        if (ultimo != string::npos) {
+            salida.texto(fila.data(), ultimo + 1);
+            fila.replace(0, ultimo + 1, ultimo + 1, ' ');
+        }
+        salida.finLinea();
+    }
+
+    /**
+     * Imprime el diagrama del arbol de forma vertical, una fila a la vez
+     * Solo se guardan la fila actual y los nodos de un nivel, asi la
+     * memoria depende del ancho de la vista y no del tamano del arbol.
+     * Debajo del ultimo nivel se indica cuantos miembros quedan fuera.
+     * @param salida Buffer donde se escribe el diagrama
+     * @param inicio Raiz de la vista
+     * @param niveles Niveles a mostrar desde inicio (1..NIVELES_DIAGRAMA_MAXIMO)
+     */
+    void imprimirDiagramaVertical(BufferSalida &salida, Miembro* inicio, int niveles) {
+        if (inicio == NULL) {
+            salida.texto("\n(Arbol vacio)\n");
+            return;
+        }
+
+        const int ANCHO_CELDA = 8;
+        int anchoTotal = (1 << (niveles - 1)) * ANCHO_CELDA;
+        string fila(anchoTotal, ' ');
+
+        vector<NodoPosicion> nivel, siguiente;
+        nivel.push_back(NodoPosicion(inicio, anchoTotal / 2));
+        for (int y = 0; y < niveles && !nivel.empty(); y++) {
+            // Circulo con el nombre: tres filas
+            for (size_t i = 0; i < nivel.size(); i++)
+                fila.replace(nivel[i].x - 2, 5, ".---.");
+            emitirFila(salida, fila);
+            for (size_t i = 0; i < nivel.size(); i++) {
+                string abrev = obtenerAbreviatura(nivel[i].nodo->nombre);
+                int x = nivel[i].x;
+                fila[x-2] = '|';
+                for (size_t k = 0; k < abrev.length() && k < 3; k++) fila[x-1+k] = abrev[k];
+                fila[x+2] = '|';
+            }
+            emitirFila(salida, fila);
+            for (size_t i = 0; i < nivel.size(); i++)
+                fila.replace(nivel[i].x - 2, 5, "'---'");
+            emitirFila(salida, fila);
+
+            if (y == niveles - 1) {
+                // Ultimo nivel visible: miembros que quedan debajo
+                bool hayOcultos = false;
+                for (size_t i = 0; i < nivel.size(); i++) {
+                    if (nivel[i].nodo->tamano <= 1) continue;
+                    string texto = textoOcultos(nivel[i].nodo->tamano - 1);
+                    size_t desde = nivel[i].x - 2;
+                    size_t largo = min(texto.size(), fila.size() - desde);
+                    fila.replace(desde, largo, texto, 0, largo);
+                    hayOcultos = true;
+                }
+                if (hayOcultos) emitirFila(salida, fila);
+                break;
+            }
+
+            // Conexiones hacia los hijos y posiciones del siguiente nivel
+            int separacion = anchoTotal >> (y + 2);
+            siguiente.clear();
+            for (size_t i = 0; i < nivel.size(); i++) {
+                Miembro* nodo = nivel[i].nodo;
+                int x = nivel[i].x;
+                if (nodo->izquierdo != NULL) {
+                    fila[x - separacion] = '.';
+                    for (int c = x - separacion + 1; c < x; c++) fila[c] = '-';
+                    siguiente.push_back(NodoPosicion(nodo->izquierdo, x - separacion));
+                }
+                if (nodo->derecho != NULL) {
+                    for (int c = x + 1; c < x + separacion; c++) fila[c] = '-';
+                    fila[x + separacion] = '.';
+                    siguiente.push_back(NodoPosicion(nodo->derecho, x + separacion));
+                }
+                if (nodo->izquierdo != NULL || nodo->derecho != NULL) fila[x] = '+';
+            }
+            emitirFila(salida, fila);
+            nivel.swap(siguiente);
+        }
+    }
+
+public:
+    /**
+     * Constructor: Inicializa el arbol vacio
+     */
+    ArbolGenealogico() {
+        raiz = NULL;
+        raizEdad = NULL;
+        enlacesLinaje = 0;
+        retenidos = NULL;
+        version = 0;
+        secuenciaInstantanea = 0;
+        historial.clear();
+    }
+
+    /**
+     * Destructor: destruye los miembros y libera los bloques del pool
+     */
+    ~ArbolGenealogico() {
+        destruirSubarbol(raiz);
+        raiz = NULL;
+        pool.liberarTodo();
+    }
+
+    /**
+     * Busca un miembro por nombre
+     * @param nombre Nombre a buscar
+     * @return Puntero al miembro o NULL si no existe
+     */
+    Miembro* buscarMiembro(const string &nombre) {
+        if (congelado.estaActivo()) {
+            if (congelado.vigente(version)) {
+                metricas = MetricasOperacion();
+                return congelado.buscar(nombre, metricas);
+            }
+            congelado.liberar(); // Vencido por una insercion o eliminacion
+        }
+        return localizarMiembro(nombre).nodo;
+    }
+
+    /**
+     * Busca un miembro sin modificar nada del arbol (ni las metricas
+     * ni el indice congelado vencido), asi varios hilos pueden buscar
+     * a la vez mientras nadie escribe
+     * @param nombre Nombre a buscar
+     * @return Puntero al miembro o NULL si no existe
+     */
+    const Miembro* buscarMiembroLectura(const string &nombre) const {
+        if (congelado.vigente(version)) {
+            MetricasOperacion local;
+            return congelado.buscar(nombre, local);
+        }
+        ClaveBusqueda clave(nombre);
+        int completas = 0;
+        const Miembro* actual = raiz;
+        while (actual != NULL) {
+            int c = compararClave(clave, actual, completas);
+            if (c == 0) return actual;
+            actual = c > 0 ? actual->derecho : actual->izquierdo;
+        }
+        return NULL;
+    }
+
+    /**
+     * Busqueda para lectores sin cerrojo (ArbolConcurrente): la misma
+     * que buscarMiembroLectura, pero el descenso se corta a los
+     * ALTURA_MAXIMA pasos. Un escritor a mitad de una rotacion puede
+     * dejar un ciclo momentaneo entre dos nodos; el resultado solo vale
+     * si el llamador comprueba despues que ningun escritor paso
+     * @param terminado Recibe false si el descenso se corto
+     * @return Puntero al miembro o NULL si no existe
+     */
+    const Miembro* buscarMiembroOptimista(const string &nombre, bool &terminado) const {
+        terminado = true;
+        if (congelado.vigente(version)) {
+            MetricasOperacion local;
+            return congelado.buscar(nombre, local);
+        }
+        ClaveBusqueda clave(nombre);
+        int completas = 0;
+        const Miembro* actual = raiz;
+        for (int paso = 0; actual != NULL; paso++) {
+            if (paso == ALTURA_MAXIMA) {
+                terminado = false;
+                return NULL;
+            }
+            int c = compararClave(clave, actual, completas);
+            if (c == 0) return actual;
+            actual = c > 0 ? actual->derecho : actual->izquierdo;
+        }
+        return NULL;
+    }
+
+    /**
+     * Retiene los nodos que se eliminen en lugar de devolverlos al pool:
+     * el que lo pidio los libera con liberarRetenido cuando ningun
+     * lector sin cerrojo puede estar en ellos
+     * @param destino Lista donde se agregan (NULL: liberarlos en el acto)
+     */
+    void retenerEliminados(vector<Miembro*>* destino) {
+        retenidos = destino;
+    }
+
+    /**
+     * Destruye un nodo retenido y devuelve su ranura al pool
+     */
+    void liberarRetenido(Miembro* m) {
+        m->~Miembro();
+        pool.liberar(m);
+    }
+
+    /**
+     * Congela las claves actuales en un indice de solo lectura
+     * buscarMiembro lo usa hasta la siguiente insercion o eliminacion
+     * (modificar datos de un miembro no lo invalida)
+     * @return Cantidad de miembros indexados
+     */
+    int congelar() {
+        vector<Miembro*> ordenados;
+        aplanarInorden(ordenados);
+        congelado.construir(ordenados, version);
+        historial.push_back(string("CONGELAR: ") + toStringNum((int)ordenados.size()) + " miembros");
+        return (int)ordenados.size();
+    }
+
+    /**
+     * @return true si buscarMiembro esta usando el indice congelado
+     */
+    bool estaCongelado() const {
+        return congelado.vigente(version);
+    }
+
+    /**
+     * @return Bytes del indice congelado (0 si no existe)
+     */
+    size_t bytesIndiceCongelado() const {
+        return congelado.bytesUsados();
+    }
+
+    /**
+     * Busca un nombre y recuerda el camino recorrido
+     * Hace una sola comparacion de tres vias por nivel. La posicion
+     * sirve para insertar, modificar o eliminar sin volver a buscar
+     * mientras el arbol no cambie de estructura.
+     * @param nombre Nombre a localizar
+     * @return Posicion del miembro, o del hueco donde iria si no existe
+     */
+    PosicionMiembro localizarMiembro(const string &nombre) {
+        metricas = MetricasOperacion();
+        return descender(nombre);
+    }
+
+    /**
+     * Comparaciones y rotaciones hechas por la ultima operacion
+     * (busqueda, insercion, modificacion o eliminacion)
+     */
+    MetricasOperacion metricasUltimaOperacion() const {
+        return metricas;
+    }
+
+    /**
+     * Indica si una posicion sigue describiendo el arbol actual
+     * @param pos Posicion obtenida con localizarMiembro
+     * @return false si hubo inserciones o eliminaciones despues
+     */
+    bool posicionVigente(const PosicionMiembro &pos) const {
+        return pos.version == version;
+    }
+
+    /**
+     * Modifica los datos de un miembro existente
+     * @param nombre Nombre del miembro
+     * @param nuevaEdad Nueva edad
+     * @param nuevaOcupacion Nueva ocupacion
+     * @param nuevaRelacion Nueva relacion familiar
+     * @return true si se modifico, false si no existe
+     */
+    bool modificarMiembro(const string &nombre, int nuevaEdad,
+                         const string &nuevaOcupacion, const string &nuevaRelacion)
+    {
+        return modificarMiembro(localizarMiembro(nombre), nuevaEdad,
+                                nuevaOcupacion, nuevaRelacion);
+    }
+
+    /**
+     * Modifica un miembro ya localizado (sin volver a buscarlo)
+     * @param pos Posicion vigente obtenida con localizarMiembro
+     * @return true si se modifico, false si no existe o la posicion vencio
+     */
+    bool modificarMiembro(const PosicionMiembro &pos, int nuevaEdad,
+                         const string &nuevaOcupacion, const string &nuevaRelacion)
+    {
+        if (pos.nodo == NULL || !posicionVigente(pos)) return false;
+        Miembro* m = pos.nodo;
+        m->idOcupacion = ocupaciones.internar(nuevaOcupacion);
+        unsigned int idRelacion = relaciones.internar(nuevaRelacion);
+        if (m->idRelacion != idRelacion) {
+            desindexarMiembro(m);
+            m->idRelacion = idRelacion;
+            indexarMiembro(m);
+        }
+        if (m->edad != nuevaEdad) {
+            // Los agregados de edad cambian en el nodo y sus ancestros;
+            // en el indice por edad el miembro cambia de lugar
+            quitarDeIndiceEdad(m);
+            m->edad = nuevaEdad;
+            insertarEnIndiceEdad(m);
+            Miembro** pila[ALTURA_MAXIMA];
+            seguirRuta(pos, pila);
+            actualizarNodo(m);
+            for (int nivel = pos.profundidad - 1; nivel >= 0; nivel--)
+                actualizarNodo(*pila[nivel]);
+        }
+        historial.push_back(string("MODIFICAR: ") + m->nombre);
+        registrar(OP_MODIFICAR, DatosMiembro(m->nombre, nuevaEdad, "", nuevaRelacion, nuevaOcupacion, ""));
+        return true;
+    }
+
+    /**
+     * Copia los datos de un miembro con sus textos resueltos
+     * @param m Puntero al miembro (no nulo)
+     * @return Registro con los atributos como strings
+     */
+    DatosMiembro datosDe(const Miembro* m) const {
+        return DatosMiembro(m->nombre, m->edad, generos.texto(m->idGenero),
+                            relaciones.texto(m->idRelacion),
+                            ocupaciones.texto(m->idOcupacion),
+                            lugares.texto(m->idLugar));
+    }
+
+    /**
+     * Muestra todos los datos de un miembro
+     * @param m Puntero al miembro
+     */
+    void imprimirMiembroCompleto(Miembro* m) {
+        if (m == NULL) {
+            cout << "(Miembro nulo)\n";
+            return;
+        }
+        cout << "\n----------------- FICHA DEL MIEMBRO -----------------\n";
+        cout << "Nombre: " << m->nombre << "\n";
+        cout << "Edad: "  << m->edad << " anos\n";
+        cout << "Genero: " << generos.texto(m->idGenero) << "\n";
+        cout << "Relacion familiar: " << relaciones.texto(m->idRelacion) << "\n";
+        cout << "Ocupacion: " << ocupaciones.texto(m->idOcupacion) << "\n";
+        cout << "Lugar de nacimiento: " << lugares.texto(m->idLugar) << "\n";
+        cout << "Altura (campo para AVL): " << m->altura << "\n";
+        cout << "----------------------------------------------------\n";
+    }
+
+    /* ========== RECORRIDOS DEL ARBOL ========== */
+
+    /**
+     * Muestra el recorrido en Preorden
+     * Recorre el AVL por nombre: no sigue el parentesco (ver mostrarLinaje)
+     */
+    void mostrarPreorden() {
+        BufferSalida salida;
+        salida.texto("\n=== RECORRIDO PREORDEN (Estructura del indice por nombre) ===\n");
+        salida.texto("Explicacion: Preorden visita cada nodo antes que sus subarboles.\n");
+        salida.texto("             El arbol AVL ordena por nombre, asi que esto\n");
+        salida.texto("             muestra la forma del indice, no el parentesco:\n");
+        salida.texto("             ancestros y descendientes estan en el menu Linaje.\n");
+        imprimirCabeceraTabla(salida);
+        int contador = 1;
+        preordenRec(salida, raiz, contador);
+        salida.texto("-----------------------------------------------------------------\n");
+    }
+
+    /**
+     * Muestra el recorrido Inorden
+     * Muestra los miembros en orden alfabetico
+     */
+    void mostrarInorden() {
+        BufferSalida salida;
+        salida.texto("\n=== RECORRIDO INORDEN (Orden alfabetico) ===\n");
+        salida.texto("Explicacion: Inorden muestra los miembros ordenados\n");
+        salida.texto("             alfabeticamente por nombre.\n");
+        imprimirCabeceraTabla(salida);
+        int contador = 1;
+        inordenRec(salida, raiz, contador);
+        salida.texto("-----------------------------------------------------------------\n");
+    }
+
+    /**
+     * Muestra el recorrido Postorden
+     * Util para ver de descendientes hacia ancestros
+     */
+    void mostrarPostorden() {
+        BufferSalida salida;
+        salida.texto("\n=== RECORRIDO POSTORDEN (Descendientes -> Ancestro) ===\n");
+        salida.texto("Explicacion: Postorden visita los descendientes antes que el\n");
+        salida.texto("             ancestro; es util para ver generaciones recientes\n");
+        salida.texto("             hacia los mas antiguos.\n");
+        imprimirCabeceraTabla(salida);
+        int contador = 1;
+        postordenRec(salida, raiz, contador);
+        salida.texto("-----------------------------------------------------------------\n");
+    }
+
+    /**
+     * Muestra el recorrido Por Niveles (BFS)
+     * Muestra miembros por distancia a la raiz
+     */
+    void mostrarPorNiveles() {
+        BufferSalida salida;
+        salida.texto("\n=== RECORRIDO POR NIVELES (Generaciones aproximadas) ===\n");
+        salida.texto("Explicacion: Por niveles muestra nodos por distancia a la raiz\n");
+        salida.texto("             (nivel 0 = raiz, nivel 1 = hijos, etc.).\n");
+        imprimirCabeceraTabla(salida);
+        if (raiz == NULL) {
+            salida.texto("(arbol vacio)\n");
+            salida.texto("-----------------------------------------------------------------\n");
+            return;
+        }
+        queue<Miembro*> q;
+        q.push(raiz);
+        int contador = 1;
+        while (!q.empty()) {
+            Miembro* cur = q.front(); 
+            q.pop();
+            imprimirLineaEnumerada(salida, cur, contador);
+            contador++;
+            if (cur->izquierdo) q.push(cur->izquierdo);
+            if (cur->derecho) q.push(cur->derecho);
+        }
+        salida.texto("-----------------------------------------------------------------\n");
+    }
+
+    /* ========== ESTADISTICA DE ORDEN ========== */
+
+    /**
+     * Total de miembros del arbol, O(1)
+     */
+    int totalMiembros() const {
+        return obtenerTamano(raiz);
+    }
+
+    /**
+     * Cantidad de miembros con nombre alfabeticamente menor, O(log n)
+     * Si el nombre existe, su numero en el recorrido inorden es rango + 1
+     * @param nombre Nombre de referencia (no necesita existir)
+     * @return Miembros con nombre < nombre
+     */
+    int rango(const string &nombre) const {
+        return contarHasta(nombre, false);
+    }
+
+    /**
+     * Cantidad de miembros con nombre menor (o menor o igual), O(log n)
+     * @param nombre Nombre de referencia (no necesita existir)
+     * @param incluido true para contar tambien el nombre si existe
+     */
+    int contarHasta(const string &nombre, bool incluido) const {
+        int menores = 0, completas = 0;
+        ClaveBusqueda clave(nombre);
+        Miembro* actual = raiz;
+        while (actual != NULL) {
+            int c = compararClave(clave, actual, completas);
+            if (c < 0 || (c == 0 && !incluido)) {
+                actual = actual->izquierdo;
+            } else {
+                menores += obtenerTamano(actual->izquierdo) + 1;
+                actual = actual->derecho;
+            }
+        }
+        return menores;
+    }
+
+    /**
+     * Miembro numero k en orden alfabetico, O(log n)
+     * @param k Posicion desde 1 (como en los recorridos)
+     * @return Miembro en esa posicion o NULL si k esta fuera de rango
+     */
+    Miembro* seleccionar(int k) const {
+        if (k < 1 || k > totalMiembros()) return NULL;
+        Miembro* actual = raiz;
+        while (actual != NULL) {
+            int izq = obtenerTamano(actual->izquierdo);
+            if (k <= izq) {
+                actual = actual->izquierdo;
+            } else if (k == izq + 1) {
+                return actual;
+            } else {
+                k -= izq + 1;
+                actual = actual->derecho;
+            }
+        }
+        return NULL;
+    }
+
+    /**
+     * Visita un tramo de un recorrido sin copiar los miembros,
+     * O(log n + limite). Un tramo de cualquiera de los tres ordenes se
+     * ubica con los tamanos de subarbol, asi que tramos distintos se
+     * pueden recorrer a la vez desde hilos distintos
+     * @param tipo 1 = Preorden, 2 = Inorden, 3 = Postorden
+     * @param desplazamiento Miembros a saltar desde el inicio
+     * @param limite Maximo de miembros a visitar
+     * @param visita Funcion objeto llamada con cada Miembro* en orden
+     * @return Miembros visitados
+     */
+    template <class Visita>
+    int recorrerTramo(int tipo, int desplazamiento, int limite, Visita &visita) const {
+        if (desplazamiento < 0 || limite <= 0) return 0;
+        if (tipo == 1) return tramoPreorden(desplazamiento, limite, visita);
+        if (tipo == 3) return tramoPostorden(desplazamiento, limite, visita);
+        return tramoInorden(desplazamiento, limite, visita);
+    }
+
+    /* ========== BUSQUEDAS POR PREFIJO Y RANGO ========== */
+
+    /**
+     * Tramo inorden de los nombres que empiezan con un prefijo, O(log n)
+     * El tramo termina antes del menor nombre mayor que todos los del
+     * prefijo: el prefijo sin sus bytes 0xFF finales y con el ultimo
+     * byte incrementado
+     * @param prefijo Comienzo del nombre ("" = todos)
+     * @param inicio Recibe la posicion inorden (desde 0) del primero
+     * @return Cantidad de nombres con ese prefijo
+     */
+    int tramoPrefijo(const string &prefijo, int &inicio) const {
+        inicio = rango(prefijo);
+        string fin = prefijo;
+        while (!fin.empty() && (unsigned char)fin[fin.size() - 1] == 0xFF)
+            fin.erase(fin.size() - 1);
+        if (fin.empty()) return totalMiembros() - inicio;
+        fin[fin.size() - 1] = (char)((unsigned char)fin[fin.size() - 1] + 1);
+        return rango(fin) - inicio;
+    }
+
+    /**
+     * Tramo inorden de los nombres en [desde, hasta], O(log n)
+     * @param inicio Recibe la posicion inorden (desde 0) del primero
+     * @return Cantidad de nombres en el rango (0 si hasta < desde)
+     */
+    int tramoRango(const string &desde, const string &hasta, int &inicio) const {
+        inicio = rango(desde);
+        int fin = contarHasta(hasta, true);
+        return fin > inicio ? fin - inicio : 0;
+    }
+
+    /**
+     * Miembros cuyo nombre empieza con un prefijo, en orden alfabetico,
+     * O(log n + limite): baja al primero y avanza por sucesores sin
+     * visitar subarboles ajenos
+     * @param prefijo Comienzo del nombre
+     * @param limite Maximo de miembros a devolver
+     */
+    vector<Miembro*> buscarPorPrefijo(const string &prefijo, int limite) const {
+        int inicio = 0;
+        int cantidad = tramoPrefijo(prefijo, inicio);
+        return paginaInorden(inicio, cantidad < limite ? cantidad : limite);
+    }
+
+    /**
+     * Miembros con nombre en [desde, hasta] (ambos incluidos), en orden
+     * alfabetico, O(log n + k)
+     */
+    vector<Miembro*> buscarRango(const string &desde, const string &hasta) const {
+        int inicio = 0;
+        int cantidad = tramoRango(desde, hasta, inicio);
+        return paginaInorden(inicio, cantidad);
+    }
+
+    /* ========== CONSULTAS POR EDAD ========== */
+
+    /**
+     * Miembros con edad menor que una dada, O(log n)
+     */
+    int contarMenoresDeEdad(int edad) const {
+        int menores = 0;
+        Miembro* actual = raizEdad;
+        while (actual != NULL) {
+            if (actual->edad < edad) {
+                menores += tamanoEdad(actual->edadIzquierdo) + 1;
+                actual = actual->edadDerecho;
+            } else {
+                actual = actual->edadIzquierdo;
+            }
+        }
+        return menores;
+    }
+
+    /**
+     * Miembro numero k en orden (edad, nombre), O(log n)
+     * @param k Posicion desde 1
+     * @return Miembro o NULL si k esta fuera de rango
+     */
+    Miembro* seleccionarPorEdad(int k) const {
+        Miembro* actual = raizEdad;
+        while (actual != NULL) {
+            int izq = tamanoEdad(actual->edadIzquierdo);
+            if (k <= izq) {
+                actual = actual->edadIzquierdo;
+            } else if (k == izq + 1) {
+                return actual;
+            } else {
+                k -= izq + 1;
+                actual = actual->edadDerecho;
+            }
+        }
+        return NULL;
+    }
+
+    /**
+     * Visita un tramo del orden (edad, nombre), O(log n + limite)
+     * @param desplazamiento Miembros a saltar desde el mas joven
+     * @param limite Maximo de miembros a visitar
+     * @param visita Funcion objeto llamada con cada Miembro* en orden
+     * @return Miembros visitados
+     */
+    template <class Visita>
+    int recorrerTramoEdad(int desplazamiento, int limite, Visita &visita) const {
+        if (desplazamiento < 0 || limite <= 0) return 0;
+        Miembro* pila[ALTURA_MAXIMA + 1];
+        int tope = 0, visitados = 0;
+        Miembro* actual = raizEdad;
+        int saltar = desplazamiento;
+        while (actual != NULL) {
+            int izq = tamanoEdad(actual->edadIzquierdo);
+            if (saltar < izq) {
+                pila[tope++] = actual;
+                actual = actual->edadIzquierdo;
+            } else if (saltar == izq) {
+                pila[tope++] = actual;
+                break;
+            } else {
+                saltar -= izq + 1;
+                actual = actual->edadDerecho;
+            }
+        }
+        while (tope > 0 && visitados < limite) {
+            Miembro* nodo = pila[--tope];
+            visita(nodo);
+            visitados++;
+            for (Miembro* c = nodo->edadDerecho; c != NULL; c = c->edadIzquierdo)
+                pila[tope++] = c;
+        }
+        return visitados;
+    }
+
+    /**
+     * Tramo del orden (edad, nombre) con edades en [desde, hasta], O(log n)
+     * @param inicio Recibe la posicion (desde 0) del primero
+     * @return Cantidad de miembros en el rango de edades
+     */
+    int tramoEdades(int desde, int hasta, int &inicio) const {
+        inicio = contarMenoresDeEdad(desde);
+        if (hasta < desde) return 0;
+        int fin = hasta == numeric_limits<int>::max() ? totalMiembros()
+                                                      : contarMenoresDeEdad(hasta + 1);
+        return fin - inicio;
+    }
+
+    /**
+     * Miembros con edad en [desde, hasta], de menor a mayor edad y a
+     * igual edad por nombre, O(log n + limite)
+     */
+    vector<Miembro*> miembrosPorEdad(int desde, int hasta, int limite) const {
+        vector<Miembro*> encontrados;
+        int inicio = 0;
+        int cantidad = tramoEdades(desde, hasta, inicio);
+        AgregarMiembro agregar(encontrados);
+        recorrerTramoEdad(inicio, cantidad < limite ? cantidad : limite, agregar);
+        return encontrados;
+    }
+
+    /**
+     * Los k miembros de mayor edad, del mayor al menor (a igual edad
+     * por nombre), O(log n + k)
+     */
+    vector<Miembro*> masLongevos(int k) const {
+        vector<Miembro*> encontrados;
+        int total = totalMiembros();
+        if (k > total) k = total;
+        if (k <= 0) return encontrados;
+        AgregarMiembro agregar(encontrados);
+        recorrerTramoEdad(total - k, k, agregar);
+        // Del mayor al menor, pero cada grupo de igual edad sigue alfabetico
+        reverse(encontrados.begin(), encontrados.end());
+        for (size_t i = 0; i < encontrados.size(); ) {
+            size_t j = i + 1;
+            while (j < encontrados.size() && encontrados[j]->edad == encontrados[i]->edad) j++;
+            reverse(encontrados.begin() + i, encontrados.begin() + j);
+            i = j;
+        }
+        return encontrados;
+    }
+
+    /**
+     * Mediana de las edades, O(log n)
+     * @return Edad del medio (promedio de las dos del medio si la
+     *         cantidad es par), 0 si el arbol esta vacio
+     */
+    double medianaEdad() const {
+        int total = totalMiembros();
+        if (total == 0) return 0.0;
+        Miembro* alto = seleccionarPorEdad(total / 2 + 1);
+        if (total % 2 == 1) return alto->edad;
+        return (seleccionarPorEdad(total / 2)->edad + alto->edad) / 2.0;
+    }
+
+    /**
+     * Muestra los miembros de un rango de edades
+     */
+    void mostrarMiembrosPorEdad(int desde, int hasta, int limite) {
+        int inicio = 0;
+        int cantidad = tramoEdades(desde, hasta, inicio);
+        mostrarListado("MIEMBROS DE " + toStringNum(desde) + " A " + toStringNum(hasta) + " ANOS",
+                       cantidad, miembrosPorEdad(desde, hasta, limite));
+    }
+
+    /**
+     * Muestra los k miembros de mayor edad
+     */
+    void mostrarMasLongevos(int k) {
+        vector<Miembro*> longevos = masLongevos(k);
+        mostrarListado("LOS " + toStringNum((int)longevos.size()) + " MIEMBROS MAS LONGEVOS",
+                       (int)longevos.size(), longevos);
+    }
+
+    /**
+     * Muestra un tramo inorden como resultado de una busqueda
+     * @param titulo Descripcion de la busqueda
+     * @param inicio Posicion inorden del primero (de tramoPrefijo o tramoRango)
+     * @param cantidad Miembros del tramo
+     * @param limite Maximo de filas a mostrar
+     */
+    void mostrarCoincidencias(const string &titulo, int inicio, int cantidad, int limite) {
+        mostrarListado(titulo, cantidad, paginaInorden(inicio, cantidad < limite ? cantidad : limite));
+    }
+
+    /**
+     * Muestra una lista de miembros como resultado de una busqueda
+     * @param titulo Descripcion de la busqueda
+     * @param cantidad Miembros encontrados (puede ser mas que los mostrados)
+     * @param pagina Miembros a mostrar, en orden
+     */
+    void mostrarListado(const string &titulo, int cantidad, const vector<Miembro*> &pagina) {
+        BufferSalida salida;
+        salida.texto("\n=== ").texto(titulo).texto(" ===\n");
+        salida.entero(cantidad).texto(" miembro(s) encontrado(s)");
+        if (cantidad > (int)pagina.size()) salida.texto(", se muestran los primeros ").entero((long long)pagina.size());
+        salida.finLinea();
+        if (pagina.empty()) return;
+        imprimirCabeceraTabla(salida);
+        for (size_t i = 0; i < pagina.size(); i++)
+            imprimirLineaEnumerada(salida, pagina[i], (int)i + 1);
+        salida.texto("-----------------------------------------------------------------\n");
+    }
+
+    /**
+     * Pagina del recorrido inorden, O(log n + limite)
+     * @param desplazamiento Miembros a saltar desde el inicio
+     * @param limite Maximo de miembros de la pagina
+     * @return Miembros de la pagina en orden alfabetico
+     */
+    vector<Miembro*> paginaInorden(int desplazamiento, int limite) const {
+        vector<Miembro*> pagina;
+        AgregarMiembro agregar(pagina);
+        recorrerTramo(2, desplazamiento, limite, agregar);
+        return pagina;
+    }
+
+    /**
+     * Pagina del recorrido preorden, O(log n + limite)
+     * @param desplazamiento Miembros a saltar desde el inicio
+     * @param limite Maximo de miembros de la pagina
+     * @return Miembros de la pagina en preorden
+     */
+    vector<Miembro*> paginaPreorden(int desplazamiento, int limite) const {
+        vector<Miembro*> pagina;
+        AgregarMiembro agregar(pagina);
+        recorrerTramo(1, desplazamiento, limite, agregar);
+        return pagina;
+    }
+
+    /**
+     * Pagina del recorrido postorden, O(log n + limite)
+     * @param desplazamiento Miembros a saltar desde el inicio
+     * @param limite Maximo de miembros de la pagina
+     * @return Miembros de la pagina en postorden
+     */
+    vector<Miembro*> paginaPostorden(int desplazamiento, int limite) const {
+        vector<Miembro*> pagina;
+        AgregarMiembro agregar(pagina);
+        recorrerTramo(3, desplazamiento, limite, agregar);
+        return pagina;
+    }
+
+    /**
+     * Pagina del recorrido por niveles, O(desplazamiento + limite)
+     * Los niveles no son contiguos por subarbol: los miembros saltados
+     * se recorren igual, pero no se copian
+     * @param desplazamiento Miembros a saltar desde el inicio
+     * @param limite Maximo de miembros de la pagina
+     * @return Miembros de la pagina por niveles
+     */
+    vector<Miembro*> paginaPorNiveles(int desplazamiento, int limite) const {
+        vector<Miembro*> pagina;
+        if (desplazamiento < 0 || limite <= 0 || raiz == NULL) return pagina;
+        queue<Miembro*> q;
+        q.push(raiz);
+        int saltar = desplazamiento;
+        while (!q.empty() && (int)pagina.size() < limite) {
+            Miembro* cur = q.front();
+            q.pop();
+            if (saltar > 0) saltar--;
+            else pagina.push_back(cur);
+            if (cur->izquierdo) q.push(cur->izquierdo);
+            if (cur->derecho) q.push(cur->derecho);
+        }
+        return pagina;
+    }
+
+    /**
+     * Muestra una pagina de un recorrido
+     * @param tipo 1 = Preorden, 2 = Inorden, 3 = Postorden
+     * @param numeroPagina Pagina a mostrar (desde 1)
+     * @param tamanoPagina Miembros por pagina
+     */
+    void mostrarPaginaRecorrido(int tipo, int numeroPagina, int tamanoPagina) {
+        if (numeroPagina < 1 || tamanoPagina < 1) {
+            cout << "ERROR: Pagina y tamano deben ser mayores que cero.\n";
+            return;
+        }
+        int total = totalMiembros();
+        int paginas = (total + tamanoPagina - 1) / tamanoPagina;
+        int desplazamiento = (numeroPagina - 1) * tamanoPagina;
+
+        vector<Miembro*> pagina;
+        string nombreRecorrido;
+        if (tipo == 1) {
+            pagina = paginaPreorden(desplazamiento, tamanoPagina);
+            nombreRecorrido = "PREORDEN";
+        } else if (tipo == 3) {
+            pagina = paginaPostorden(desplazamiento, tamanoPagina);
+            nombreRecorrido = "POSTORDEN";
+        } else {
+            pagina = paginaInorden(desplazamiento, tamanoPagina);
+            nombreRecorrido = "INORDEN";
+        }
+
+        BufferSalida salida;
+        salida.texto("\n=== RECORRIDO ").texto(nombreRecorrido).texto(" - PAGINA ").entero(numeroPagina)
+              .texto(" DE ").entero(paginas).texto(" (").entero(total).texto(" miembros) ===\n");
+        imprimirCabeceraTabla(salida);
+        if (pagina.empty()) salida.texto("(pagina vacia)\n");
+        for (size_t i = 0; i < pagina.size(); i++)
+            imprimirLineaEnumerada(salida, pagina[i], desplazamiento + (int)i + 1);
+        salida.texto("-----------------------------------------------------------------\n");
+    }
+
+    /**
+     * Muestra el historial de operaciones realizadas
+     */
+    void mostrarHistorial() {
+        BufferSalida salida;
+        salida.texto("\n=== HISTORIAL DE OPERACIONES ===\n");
+        if (historial.empty()) {
+            salida.texto("(vacio)\n");
+        } else {
+            for (size_t i = 0; i < historial.size(); ++i)
+                salida.entero((long long)i + 1).texto(". ").texto(historial[i]).finLinea();
+        }
+        salida.texto("=================================\n");
+    }
+
+    /**
+     * Carga datos de ejemplo del Tahuantinsuyo
+     */
+    void cargarDatosEjemplo() {
+        vector<DatosMiembro> datos;
+        datos.push_back(DatosMiembro("Manco Capac", 70, "Masculino", "Fundador", "Sapa Inca legendario", "Titicaca"));
+        datos.push_back(DatosMiembro("Sinchi Roca", 48, "Masculino", "Sucesor", "Noble", "Cusco"));
+        datos.push_back(DatosMiembro("Lloque Yupanqui", 45, "Masculino", "Ancestro legendario", "Noble", "Cusco"));
+        datos.push_back(DatosMiembro("Mayta Capac", 60, "Masculino", "Antepasado", "Sapa Inca", "Cusco"));
+        datos.push_back(DatosMiembro("Pachacutec", 55, "Masculino", "Sapa Inca", "Emperador - Reformador", "Cusco"));
+        datos.push_back(DatosMiembro("Tupac Yupanqui", 50, "Masculino", "Hijo", "Emperador", "Cusco"));
+        datos.push_back(DatosMiembro("Huayna Capac", 45, "Masculino", "Nieto", "Ultimo gran Sapa Inca", "Cusco"));
+        insertarLote(datos);
+
+        // Dos tramos de la sucesion (entre Mayta Capac y Pachacutec faltan
+        // cuatro generaciones que no estan en los datos)
+        const char* const sucesion[][2] = {
+            { "Sinchi Roca", "Manco Capac" },
+            { "Lloque Yupanqui", "Sinchi Roca" },
+            { "Mayta Capac", "Lloque Yupanqui" },
+            { "Tupac Yupanqui", "Pachacutec" },
+            { "Huayna Capac", "Tupac Yupanqui" }
+        };
+        string error;
+        for (size_t i = 0; i < sizeof(sucesion) / sizeof(sucesion[0]); i++)
+            asignarProgenitor(sucesion[i][0], sucesion[i][1], error);
+
+        insertarmeHistorial("CARGA_INICIAL: Datos del Tahuantinsuyo insertados");
+    }
+
+    /**
+     * Elimina todos los miembros y libera la memoria del pool
+     * Con persistencia activa el diario se compacta (queda vacio)
+     */
+    void vaciar() {
+        descartarMiembros();
+        historial.push_back("VACIAR");
+        compactarDiario();
+    }
+
+    /**
+     * Reemplaza el contenido del arbol por un lote de registros
+     * Si el lote esta ordenado por nombre la construccion es O(n);
+     * si no, se ordena antes (O(n log n)). Repetidos y nombres vacios
+     * se descartan. El resultado es un AVL perfectamente balanceado.
+     * @param lote Registros a cargar (se ordena en el lugar)
+     * @return Cantidad de miembros cargados
+     */
+    int construirDesdeOrdenados(vector<DatosMiembro> &lote) {
+        prepararLote(lote);
+        vector<const DatosMiembro*> ordenados;
+        ordenados.reserve(lote.size());
+        for (size_t i = 0; i < lote.size(); i++) ordenados.push_back(&lote[i]);
+        return construirDesdeRegistros(ordenados);
+    }
+
+    /**
+     * Reemplaza el contenido del arbol por registros que ya vienen
+     * ordenados por nombre y sin repetidos (por ejemplo, los de un
+     * importador que ordeno en paralelo). Solo se verifica el orden,
+     * O(n); los registros no se copian antes de crear los nodos.
+     * @param ordenados Registros en orden estrictamente creciente
+     * @return Cantidad de miembros cargados, o -1 si el orden no es
+     *         valido (el arbol queda como estaba)
+     */
+    int construirDesdeRegistros(const vector<const DatosMiembro*> &ordenados) {
+        return construirDesdePunteros(ordenados);
+    }
+
+    /**
+     * Igual que la version anterior, pero los nombres se mueven a los
+     * nodos en vez de copiarse: para registros que se descartan despues
+     * (los nombres quedan vacios si la carga se hizo)
+     */
+    int construirDesdeRegistros(const vector<DatosMiembro*> &ordenados) {
+        return construirDesdePunteros(ordenados);
+    }
+
+    /**
+     * Inserta un lote de registros en el arbol actual
+     * Si el lote es grande respecto al arbol (k * log2(n + k) >= n) se
+     * aplana el arbol, se mezcla con el lote y se reconstruye en O(n + k);
+     * si es pequeno se inserta uno por uno con balanceo AVL.
+     * Los nombres ya existentes en el arbol no se modifican.
+     * @param lote Registros a insertar (se ordena en el lugar)
+     * @return Cantidad de miembros nuevos
+     */
+    int insertarLote(vector<DatosMiembro> &lote) {
+        prepararLote(lote);
+        if (lote.empty()) return 0;
+
+        int nuevos = 0;
+        size_t n = (size_t)totalMiembros();
+        size_t log2Total = 1;
+        while (((size_t)1 << log2Total) < n + lote.size()) log2Total++;
+
+        if (lote.size() * log2Total >= n) {
+            nuevos = mezclarYReconstruir(lote);
+            compactarDiario(); // El lote es comparable al arbol: se guarda completo
+        } else {
+            for (size_t i = 0; i < lote.size(); i++) {
+                const DatosMiembro &d = lote[i];
+                PosicionMiembro pos = descender(d.nombre);
+                if (pos.nodo != NULL) continue;
+                insertarNodo(crearDesdeDatos(d), pos);
+                registrar(OP_INSERTAR, d);
+                nuevos++;
+            }
+        }
+
+        historial.push_back(string("INSERTAR LOTE: ") + toStringNum(nuevos) + " miembros");
+        return nuevos;
+    }
+
+    /* ========== PERSISTENCIA ========== */
+
+    /**
+     * Guarda el arbol completo en una instantanea binaria
+     * Se escribe a un archivo temporal que reemplaza al destino solo al
+     * final, asi una falla a mitad de camino no deja el archivo corrupto
+     * @param ruta Archivo destino
+     * @return true si se guardo completo
+     */
+    bool guardarInstantanea(const string &ruta) {
+        vector<Miembro*> ordenados;
+        aplanarInorden(ordenados);
+
+        unsigned long long bytesNombres = 0;
+        for (size_t i = 0; i < ordenados.size(); i++) bytesNombres += ordenados[i]->nombre.size();
+        if (bytesNombres > 0xFFFFFFFFULL) return false; // Los registros usan inicios de 32 bits
+
+        // Todo lo registrado hasta aqui queda incluido en la instantanea
+        diario.sincronizar();
+        unsigned long long secuencia = diario.estaAbierto() ? diario.ultimaSecuencia()
+                                                           : secuenciaInstantanea;
+
+        string temporal = ruta + ".tmp";
+        ofstream salida(temporal.c_str(), ios::binary | ios::trunc);
+        if (!salida) return false;
+
+        // Cabecera provisional: la suma se conoce al terminar
+        char cabecera[BYTES_CABECERA];
+        memset(cabecera, 0, sizeof(cabecera));
+        salida.write(cabecera, BYTES_CABECERA);
+
+        EscritorBinario escritor(salida);
+        const TablaSimbolos* tablas[4] = { &generos, &relaciones, &ocupaciones, &lugares };
+        for (int t = 0; t < 4; t++) {
+            escritor.u32((unsigned int)tablas[t]->cantidad());
+            for (size_t i = 0; i < tablas[t]->cantidad(); i++)
+                escritor.texto(tablas[t]->texto((unsigned int)i));
+        }
+
+        escritor.u32((unsigned int)bytesNombres);
+        for (size_t i = 0; i < ordenados.size(); i++)
+            escritor.bytes(ordenados[i]->nombre.data(), ordenados[i]->nombre.size());
+
+        unsigned int inicio = 0;
+        for (size_t i = 0; i < ordenados.size(); i++) {
+            const Miembro* m = ordenados[i];
+            escritor.u32(inicio);
+            escritor.u32((unsigned int)m->nombre.size());
+            escritor.u32((unsigned int)m->edad);
+            escritor.u32(m->idGenero);
+            escritor.u32(m->idRelacion);
+            escritor.u32(m->idOcupacion);
+            escritor.u32(m->idLugar);
+            inicio += (unsigned int)m->nombre.size();
+        }
+
+        escritor.u32((unsigned int)enlacesLinaje);
+        for (size_t i = 0; i < ordenados.size(); i++) {
+            const Miembro* p = ordenados[i]->progenitor;
+            if (p == NULL) continue;
+            escritor.u32((unsigned int)i);
+            escritor.u32((unsigned int)rango(p->nombre)); // Su posicion alfabetica
+        }
+        escritor.vaciarBuffer();
+
+        memcpy(cabecera, MAGIA_INSTANTANEA, 8);
+        escribirU32(cabecera + 8, VERSION_INSTANTANEA);
+        escribirU32(cabecera + 12, (unsigned int)ordenados.size());
+        escribirU64(cabecera + 16, escritor.totalEscrito());
+        escribirU64(cabecera + 24, escritor.sumaVerificacion());
+        escribirU64(cabecera + 32, secuencia);
+        salida.seekp(0);
+        salida.write(cabecera, BYTES_CABECERA);
+        salida.close();
+        if (salida.fail()) {
+            remove(temporal.c_str());
+            return false;
+        }
+        sincronizarRuta(temporal); // En disco antes de reemplazar la anterior
+#ifdef _WIN32
+        remove(ruta.c_str()); // rename no reemplaza archivos existentes en Windows
+#endif
+        if (rename(temporal.c_str(), ruta.c_str()) != 0) return false;
+        secuenciaInstantanea = secuencia;
+        // El diario solo sobra si esta es la instantanea que lo acompana
+        if (diario.estaAbierto() && ruta == rutaPersistencia) diario.truncar();
+
+        historial.push_back(string("GUARDAR: ") + toStringNum((int)ordenados.size()) + " miembros");
+        return true;
+    }
+
+    /**
+     * Reemplaza el arbol por el contenido de una instantanea
+     * El archivo se proyecta en memoria y se valida completo (cabecera,
+     * suma, limites, ids y orden) antes de tocar el arbol actual; si algo
+     * falla el arbol queda como estaba. Los nodos se crean directo desde
+     * el archivo y se enlazan en O(n) sin comparaciones ni rotaciones.
+     * @param ruta Archivo a cargar
+     * @param error Recibe la causa si la carga falla
+     * @return true si se cargo
+     */
+    bool cargarInstantanea(const string &ruta, string &error) {
+        ArchivoMapeado archivo;
+        if (!archivo.abrir(ruta)) {
+            error = "no se pudo abrir " + ruta;
+            return false;
+        }
+        if (archivo.tamano() < BYTES_CABECERA_V1 ||
+            memcmp(archivo.contenido(), MAGIA_INSTANTANEA, 8) != 0) {
+            error = "el archivo no es una instantanea del arbol";
+            return false;
+        }
+
+        LectorBinario cabecera(archivo.contenido() + 8, archivo.tamano() - 8);
+        unsigned int versionArchivo = 0, cantidad = 0;
+        unsigned long long bytesContenido = 0, suma = 0, secuencia = 0;
+        cabecera.u32(versionArchivo);
+        cabecera.u32(cantidad);
+        cabecera.u64(bytesContenido);
+        cabecera.u64(suma);
+        if (versionArchivo < 1 || versionArchivo > VERSION_INSTANTANEA) {
+            error = "version " + toStringNum((int)versionArchivo) + " no soportada";
+            return false;
+        }
+        size_t bytesCabecera = BYTES_CABECERA_V1;
+        if (versionArchivo >= 2) {
+            bytesCabecera = BYTES_CABECERA;
+            if (!cabecera.u64(secuencia)) {
+                error = "archivo truncado";
+                return false;
+            }
+        }
+        if (bytesContenido != archivo.tamano() - bytesCabecera) {
+            error = "archivo truncado";
+            return false;
+        }
+        const char* contenido = archivo.contenido() + bytesCabecera;
+        if (fnv1a(contenido, (size_t)bytesContenido) != suma) {
+            error = "la suma de verificacion no coincide";
+            return false;
+        }
+
+        LectorBinario lector(contenido, (size_t)bytesContenido);
+        TablaSimbolos tablas[4];
+        for (int t = 0; t < 4; t++) {
+            unsigned int n;
+            if (!lector.u32(n)) {
+                error = "tabla de simbolos incompleta";
+                return false;
+            }
+            for (unsigned int i = 0; i < n; i++) {
+                string texto;
+                if (!lector.texto(texto) || tablas[t].internar(texto) != i) {
+                    error = "tabla de simbolos invalida";
+                    return false;
+                }
+            }
+        }
+
+        unsigned int bytesNombres = 0;
+        const char* nombres = NULL;
+        const char* registros = NULL;
+        if (lector.u32(bytesNombres)) nombres = lector.bytes(bytesNombres);
+        if (nombres != NULL) registros = lector.bytes((size_t)cantidad * BYTES_REGISTRO);
+        unsigned int enlaces = 0;
+        const char* linajeArchivo = NULL;
+        if (registros != NULL && versionArchivo >= 3 && lector.u32(enlaces))
+            linajeArchivo = lector.bytes((size_t)enlaces * 8);
+        if (registros == NULL || (versionArchivo >= 3 && linajeArchivo == NULL) ||
+            lector.restantes() != 0) {
+            error = "tamano de nombres o registros invalido";
+            return false;
+        }
+
+        // Validar todos los registros antes de modificar el arbol
+        vector<unsigned int> campos((size_t)cantidad * 7);
+        for (size_t k = 0; k < cantidad; k++) {
+            LectorBinario registro(registros + k * BYTES_REGISTRO, BYTES_REGISTRO);
+            unsigned int* c = &campos[k * 7];
+            for (int j = 0; j < 7; j++) registro.u32(c[j]);
+            bool valido = c[1] > 0 && c[0] <= bytesNombres && c[1] <= bytesNombres - c[0];
+            for (int t = 0; t < 4 && valido; t++) valido = c[3 + t] < tablas[t].cantidad();
+            if (valido && k > 0) {
+                // Estrictamente creciente: la forma del arbol depende del orden
+                const unsigned int* p = c - 7;
+                int cmp = memcmp(nombres + p[0], nombres + c[0], min(p[1], c[1]));
+                valido = cmp < 0 || (cmp == 0 && p[1] < c[1]);
+            }
+            if (!valido) {
+                error = "registro " + toStringNum((int)k + 1) + " invalido";
+                return false;
+            }
+        }
+
+        // Linaje: un solo progenitor por hijo y sin ciclos
+        vector<int> progenitorDe(cantidad, -1);
+        LectorBinario pares(linajeArchivo, (size_t)enlaces * 8);
+        for (unsigned int e = 0; e < enlaces; e++) {
+            unsigned int hijo = 0, p = 0;
+            pares.u32(hijo);
+            pares.u32(p);
+            if (hijo >= cantidad || p >= cantidad || hijo == p || progenitorDe[hijo] != -1) {
+                error = "enlace de linaje " + toStringNum((int)e + 1) + " invalido";
+                return false;
+            }
+            progenitorDe[hijo] = (int)p;
+        }
+        vector<unsigned int> visita(cantidad, 0); // Subida que paso por cada miembro
+        for (size_t k = 0; k < cantidad; k++) {
+            int j = (int)k;
+            while (j != -1 && visita[j] == 0) {
+                visita[j] = (unsigned int)k + 1;
+                j = progenitorDe[j];
+            }
+            if (j != -1 && visita[j] == (unsigned int)k + 1) {
+                error = "el linaje tiene un ciclo";
+                return false;
+            }
+        }
+
+        descartarMiembros();
+        secuenciaInstantanea = secuencia;
+        generos.intercambiar(tablas[0]);
+        relaciones.intercambiar(tablas[1]);
+        ocupaciones.intercambiar(tablas[2]);
+        lugares.intercambiar(tablas[3]);
+
+        vector<Miembro*> nodos;
+        nodos.reserve(cantidad);
+        for (size_t k = 0; k < cantidad; k++) {
+            const unsigned int* c = &campos[k * 7];
+            Miembro* m = new (pool.reservar()) Miembro(string(nombres + c[0], c[1]), (int)c[2],
+                                                        c[3], c[4], c[5], c[6]);
+            indexarMiembro(m);
+            nodos.push_back(m);
+        }
+        // De atras hacia adelante: cada lista de hijos queda en orden alfabetico
+        for (size_t k = cantidad; k-- > 0; )
+            if (progenitorDe[k] != -1) enlazarHijo(nodos[k], nodos[progenitorDe[k]]);
+        raiz = construirBalanceado(nodos, 0, (int)nodos.size());
+        construirIndiceEdad(nodos);
+
+        historial.push_back(string("CARGAR: ") + toStringNum((int)cantidad) + " miembros desde " + ruta);
+        // El diario describe cambios sobre el arbol anterior: ya no aplica
+        if (diario.estaAbierto()) compactarDiario();
+        return true;
+    }
+
+    /**
+     * Activa la persistencia: carga la instantanea (si existe), aplica
+     * las operaciones del diario posteriores a ella y deja el diario
+     * abierto para registrar cada cambio
+     * Si la instantanea existe pero esta danada no se abre el diario,
+     * para no mezclar operaciones nuevas con un estado desconocido
+     * @param rutaInstantanea Archivo de la instantanea
+     * @param rutaDiario Archivo del diario
+     * @param error Recibe la causa si falla
+     * @return true si la persistencia quedo activa
+     */
+    bool abrirPersistencia(const string &rutaInstantanea, const string &rutaDiario,
+                           string &error) {
+        diario.cerrar();
+        ifstream existe(rutaInstantanea.c_str());
+        if (existe) {
+            existe.close();
+            if (!cargarInstantanea(rutaInstantanea, error)) return false;
+        }
+
+        vector<OperacionDiario> operaciones;
+        unsigned long long bytesValidos = 0;
+        DiarioOperaciones::leer(rutaDiario, operaciones, bytesValidos);
+        unsigned long long ultima = secuenciaInstantanea;
+        int aplicadas = 0;
+        for (size_t i = 0; i < operaciones.size(); i++) {
+            OperacionDiario &op = operaciones[i];
+            if (op.secuencia > ultima) ultima = op.secuencia;
+            if (op.secuencia <= secuenciaInstantanea) continue; // Ya esta en la instantanea
+            DatosMiembro &d = op.datos;
+            if (op.tipo == OP_INSERTAR)
+                emplazarMiembro(d); // La operacion leida no se vuelve a usar
+            else if (op.tipo == OP_MODIFICAR)
+                modificarMiembro(d.nombre, d.edad, d.ocupacion, d.relacionFamiliar);
+            else if (op.tipo == OP_ELIMINAR)
+                eliminarMiembro(d.nombre);
+            else if (d.relacionFamiliar.empty())
+                quitarProgenitor(d.nombre);
+            else {
+                string motivo; // Se valido al registrarla: no deberia fallar
+                asignarProgenitor(d.nombre, d.relacionFamiliar, motivo);
+            }
+            aplicadas++;
+        }
+
+        if (!diario.abrir(rutaDiario, bytesValidos, ultima)) {
+            error = "no se pudo abrir el diario " + rutaDiario;
+            return false;
+        }
+        rutaPersistencia = rutaInstantanea;
+        historial.push_back(string("RECUPERAR: ") + toStringNum(aplicadas) + " operaciones del diario");
+        return true;
+    }
+
+    /**
+     * Guarda una instantanea y vacia el diario
+     * @return false si la persistencia no esta activa o no se pudo guardar
+     */
+    bool compactarDiario() {
+        if (!diario.estaAbierto()) return false;
+        return guardarInstantanea(rutaPersistencia);
+    }
+
+    /**
+     * Ajusta cuantas operaciones se juntan por fsync
+     * @param maxPendientes Operaciones por grupo (1 = cada una se sincroniza)
+     * @param latenciaMaxima Milisegundos que puede esperar una operacion
+     */
+    void configurarDiario(size_t maxPendientes, double latenciaMaxima) {
+        diario.configurarGrupo(maxPendientes, latenciaMaxima);
+    }
+
+    /**
+     * Escribe a disco las operaciones pendientes del grupo actual
+     */
+    void sincronizarDiario() {
+        diario.sincronizar();
+    }
+
+    /**
+     * @return Ultima secuencia registrada (0 si nunca hubo persistencia)
+     */
+    unsigned long long ultimaSecuencia() const {
+        return diario.estaAbierto() ? diario.ultimaSecuencia() : secuenciaInstantanea;
+    }
+
+    /**
+     * @return Bytes actuales del diario
+     */
+    unsigned long long bytesDiario() const {
+        return diario.tamano();
+    }
+
+    /**
+     * Agrega una entrada al historial
+     * @param s Texto a agregar
+     */
+    void insertarmeHistorial(const string &s) {
+        historial.push_back(s);
+    }
+
+    /**
+     * Inserta un nuevo miembro con balanceo AVL
+     * @return true si se inserto, false si ya existe o datos invalidos
+     */
+    bool insertarMiembroAVL(const string &nombre, int edad,
+                            const string &genero, const string &relacion,
+                            const string &ocupacion, const string &lugarNacimiento)
+    {
+        bool insertado = false;
+        insertarOObtener(nombre, edad, genero, relacion, ocupacion, lugarNacimiento, insertado);
+        return insertado;
+    }
+
+    /**
+     * Inserta un registro moviendo su nombre al nodo (en C++98, por
+     * intercambio). Primero se busca: el nodo se construye solo si el
+     * nombre no esta, y los atributos repetidos ya estan internados,
+     * asi que el unico texto nuevo en memoria es el nombre. Como en
+     * insertarOObtener, el diario se escribe con el nodo ya enlazado: si
+     * el registro dispara la compactacion, la instantanea lo incluye
+     * @param datos Registro a insertar; si se inserta, datos.nombre queda
+     *              vacio (los demas campos no cambian)
+     * @return true si se inserto, false si ya existe o nombre vacio
+     */
+    bool emplazarMiembro(DatosMiembro &datos) {
+        if (datos.nombre.empty()) return false;
+        PosicionMiembro pos = localizarMiembro(datos.nombre);
+        if (pos.nodo != NULL) return false;
+
+        Miembro* nuevo = crearMiembroMoviendo(datos.nombre, datos.edad, datos.genero,
+                                              datos.relacionFamiliar, datos.ocupacion,
+                                              datos.lugarNacimiento);
+        insertarNodo(nuevo, pos);
+        historial.push_back(string());
+        historial.back().reserve(14 + nuevo->nombre.size());
+        historial.back().append("INSERTAR AVL: ").append(nuevo->nombre);
+        registrar(OP_INSERTAR, nuevo->nombre, datos);
+        return true;
+    }
+
+    /**
+     * Devuelve el miembro con ese nombre, insertandolo si no existe
+     * Una sola busqueda: el nodo se crea solo si el nombre no esta
+     * @param insertado Recibe true si el miembro se creo ahora
+     * @return Miembro existente o recien insertado (NULL si nombre vacio)
+     */
+    Miembro* insertarOObtener(const string &nombre, int edad,
+                              const string &genero, const string &relacion,
+                              const string &ocupacion, const string &lugarNacimiento,
+                              bool &insertado)
+    {
+        insertado = false;
+        if (nombre.empty()) return NULL;
+        PosicionMiembro pos = localizarMiembro(nombre);
+        if (pos.nodo != NULL) return pos.nodo;
+
+        Miembro* nuevo = crearMiembro(nombre, edad, genero, relacion, ocupacion, lugarNacimiento);
+        insertarNodo(nuevo, pos);
+        historial.push_back(string("INSERTAR AVL: ") + nombre);
+        registrar(OP_INSERTAR, DatosMiembro(nombre, edad, genero, relacion, ocupacion, lugarNacimiento));
+        insertado = true;
+        return nuevo;
+    }
+
+    /**
+     * Inserta en el hueco de una posicion ya localizada
+     * El nombre debe ser el mismo que se uso en localizarMiembro. Si la
+     * posicion vencio (el arbol cambio) se vuelve a localizar.
+     * @param pos Posicion obtenida con localizarMiembro
+     * @return true si se inserto, false si ya existe o nombre vacio
+     */
+    bool insertarEnPosicion(const PosicionMiembro &pos, const string &nombre, int edad,
+                            const string &genero, const string &relacion,
+                            const string &ocupacion, const string &lugarNacimiento)
+    {
+        if (!posicionVigente(pos))
+            return insertarMiembroAVL(nombre, edad, genero, relacion, ocupacion, lugarNacimiento);
+        metricas = MetricasOperacion();
+        if (nombre.empty() || pos.nodo != NULL) return false;
+
+        Miembro* nuevo = crearMiembro(nombre, edad, genero, relacion, ocupacion, lugarNacimiento);
+        insertarNodo(nuevo, pos);
+        historial.push_back(string("INSERTAR AVL: ") + nombre);
+        registrar(OP_INSERTAR, DatosMiembro(nombre, edad, genero, relacion, ocupacion, lugarNacimiento));
+        return true;
+    }
+
+    /**
+     * Elimina un miembro del arbol
+     * @param nombre Nombre del miembro a eliminar
+     * @return true si se elimino, false si no existe
+     */
+    bool eliminarMiembro(const string &nombre) {
+        if (nombre.empty()) return false;
+        PosicionMiembro pos = localizarMiembro(nombre);
+        if (pos.nodo == NULL) return false;
+        string nombreEliminado = pos.nodo->nombre;
+        eliminarNodo(pos);
+        historial.push_back(string("ELIMINAR: ") + nombreEliminado);
+        registrar(OP_ELIMINAR, DatosMiembro(nombreEliminado, 0, "", "", "", ""));
+        return true;
+    }
+
+    /**
+     * Elimina un miembro ya localizado (sin volver a buscarlo)
+     * @param pos Posicion vigente obtenida con localizarMiembro
+     * @return true si se elimino, false si no existe o la posicion vencio
+     */
+    bool eliminarEnPosicion(const PosicionMiembro &pos) {
+        metricas = MetricasOperacion();
+        if (pos.nodo == NULL || !posicionVigente(pos)) return false;
+        string nombre = pos.nodo->nombre;
+        eliminarNodo(pos);
+        historial.push_back(string("ELIMINAR: ") + nombre);
+        registrar(OP_ELIMINAR, DatosMiembro(nombre, 0, "", "", "", ""));
+        return true;
+    }
+
+    /* ========== LINAJE (PROGENITORES E HIJOS) ========== */
+
+    /**
+     * Asigna el progenitor de un miembro, reemplazando al anterior
+     * El linaje es un bosque: cada miembro tiene a lo sumo un progenitor
+     * y nadie puede descender de si mismo
+     * @param nombreHijo Miembro que recibe el progenitor
+     * @param nombreProgenitor Nuevo progenitor
+     * @param error Recibe la causa si no se pudo asignar
+     * @return true si quedo asignado
+     */
+    bool asignarProgenitor(const string &nombreHijo, const string &nombreProgenitor,
+                           string &error) {
+        Miembro* hijo = buscarMiembro(nombreHijo);
+        Miembro* nuevo = buscarMiembro(nombreProgenitor);
+        if (hijo == NULL || nuevo == NULL) {
+            error = "no existe " + (hijo == NULL ? nombreHijo : nombreProgenitor);
+            return false;
+        }
+        if (esAncestro(hijo, nuevo)) {
+            error = hijo == nuevo ? "un miembro no puede ser su propio progenitor"
+                                  : nombreProgenitor + " desciende de " + nombreHijo;
+            return false;
+        }
+        if (hijo->progenitor == nuevo) return true;
+        if (hijo->progenitor != NULL) desenlazarHijo(hijo);
+        enlazarHijo(hijo, nuevo);
+        historial.push_back(string("PROGENITOR: ") + nombreProgenitor + " -> " + nombreHijo);
+        registrar(OP_PROGENITOR, DatosMiembro(nombreHijo, 0, "", nombreProgenitor, "", ""));
+        return true;
+    }
+
+    /**
+     * Quita el progenitor de un miembro (sus hijos no cambian)
+     * @param nombreHijo Miembro
+     * @return true si tenia progenitor
+     */
+    bool quitarProgenitor(const string &nombreHijo) {
+        Miembro* hijo = buscarMiembro(nombreHijo);
+        if (hijo == NULL || hijo->progenitor == NULL) return false;
+        desenlazarHijo(hijo);
+        historial.push_back(string("QUITAR PROGENITOR: ") + nombreHijo);
+        registrar(OP_PROGENITOR, DatosMiembro(nombreHijo, 0, "", "", "", ""));
+        return true;
+    }
+
+    /**
+     * Reconstruye el indice de linaje si algun enlace cambio, O(n)
+     * Insertar miembros sin enlaces no lo vence. Despues de llamarlo
+     * las consultas de linaje son O(1) y solo leen (seguras entre hilos)
+     */
+    void prepararLinaje() {
+        if (linaje.estaVigente()) return;
+        vector<Miembro*> todos;
+        todos.reserve(totalMiembros());
+        aplanarInorden(todos);
+        linaje.construir(todos);
+    }
+
+    /**
+     * @return true si las consultas de linaje son O(1) ahora mismo
+     */
+    bool linajeVigente() const { return linaje.estaVigente(); }
+
+    /**
+     * @return Miembros que tienen progenitor asignado
+     */
+    int totalEnlacesLinaje() const { return enlacesLinaje; }
+
+    /**
+     * @return Bytes del indice de linaje
+     */
+    size_t bytesIndiceLinaje() const { return linaje.bytesUsados(); }
+
+    /**
+     * Indica si a es ancestro de b (un miembro es ancestro de si mismo)
+     * O(1) con el indice vigente; si no, sube por los progenitores de b
+     */
+    bool esAncestro(const Miembro* a, const Miembro* b) const {
+        if (linaje.estaVigente()) return linaje.esAncestro(a, b);
+        return esAncestroSubiendo(a, b);
+    }
+
+    /**
+     * Generaciones desde la raiz del linaje de un miembro (0 = sin progenitor)
+     * O(1) con el indice vigente
+     */
+    int generacion(const Miembro* m) const {
+        if (linaje.estaVigente()) return m->linajeEntrada < 0 ? 0 : m->linajeProfundidad;
+        return generacionesSubiendo(m);
+    }
+
+    /**
+     * Ancestro comun mas cercano de dos miembros
+     * O(1) con el indice vigente; si no, O(generaciones)
+     * @return El ancestro (puede ser a o b), o NULL si no comparten linaje
+     */
+    Miembro* ancestroComun(const Miembro* a, const Miembro* b) const {
+        if (linaje.estaVigente()) return linaje.ancestroComun(a, b);
+        int ga = generacionesSubiendo(a), gb = generacionesSubiendo(b);
+        for (; ga > gb; ga--) a = a->progenitor;
+        for (; gb > ga; gb--) b = b->progenitor;
+        while (a != b) {
+            a = a->progenitor;
+            b = b->progenitor;
+        }
+        return const_cast<Miembro*>(a);
+    }
+
+    /**
+     * Distancia de parentesco: enlaces progenitor-hijo en el camino de
+     * a hasta b pasando por su ancestro comun (padre e hijo = 1,
+     * hermanos = 2, primos hermanos = 4)
+     * @return La distancia, o -1 si no comparten linaje
+     */
+    int distanciaParentesco(const Miembro* a, const Miembro* b) const {
+        const Miembro* c = ancestroComun(a, b);
+        if (c == NULL) return -1;
+        return generacion(a) + generacion(b) - 2 * generacion(c);
+    }
+
+    /**
+     * Muestra los ancestros, los hijos y la cantidad de descendientes
+     * de un miembro
+     * @param nombre Miembro a consultar
+     * @return false si no existe
+     */
+    bool mostrarLinaje(const string &nombre) {
+        Miembro* m = buscarMiembro(nombre);
+        if (m == NULL) return false;
+        prepararLinaje();
+
+        vector<Miembro*> ancestros, hijos;
+        for (Miembro* a = m->progenitor; a != NULL; a = a->progenitor) ancestros.push_back(a);
+        for (Miembro* h = m->primerHijo; h != NULL; h = h->siguienteHermano) hijos.push_back(h);
+        // En el recorrido de Euler un subarbol de k miembros ocupa 2k - 1 posiciones
+        int descendientes = m->linajeEntrada < 0 ? 0 : (m->linajeSalida - m->linajeEntrada) / 2;
+
+        BufferSalida salida;
+        salida.texto("\n=== LINAJE DE ").texto(m->nombre).texto(" ===\n");
+        salida.texto("Generacion ").entero(generacion(m))
+              .texto(" de su linaje, ").entero(descendientes).texto(" descendiente(s)\n");
+        salida.vaciar();
+        mostrarListado("ANCESTROS (DEL PROGENITOR HACIA ATRAS)", (int)ancestros.size(), ancestros);
+        mostrarListado("HIJOS", (int)hijos.size(), hijos);
+        return true;
+    }
+
+    /**
+     * Muestra el parentesco entre dos miembros: ancestro comun,
+     * generaciones de cada uno hasta el y distancia
+     * @return false si alguno no existe
+     */
+    bool mostrarParentesco(const string &nombreA, const string &nombreB) {
+        Miembro* a = buscarMiembro(nombreA);
+        Miembro* b = buscarMiembro(nombreB);
+        if (a == NULL || b == NULL) return false;
+        prepararLinaje();
+
+        BufferSalida salida;
+        salida.texto("\n=== PARENTESCO: ").texto(a->nombre).texto(" / ").texto(b->nombre).texto(" ===\n");
+        Parentesco p = parentesco(a, b);
+        if (p.tipo == PARENTESCO_NINGUNO) {
+            salida.texto("No comparten ningun ancestro registrado.\n");
+            return true;
+        }
+        if (p.tipo == PARENTESCO_MISMO) {
+            salida.texto("Es el mismo miembro.\n");
+        } else if (p.tipo == PARENTESCO_ANCESTRO || p.tipo == PARENTESCO_DESCENDIENTE) {
+            bool ancestro = p.tipo == PARENTESCO_ANCESTRO;
+            salida.texto(ancestro ? a->nombre : b->nombre).texto(" es ancestro de ")
+                  .texto(ancestro ? b->nombre : a->nombre).texto(" (")
+                  .entero(p.distancia()).texto(" generacion(es))\n");
+        } else {
+            const char* const nombres[] = { "hermanos", "tio o tia", "sobrino o sobrina", "primos" };
+            salida.texto("Relacion: ").texto(nombres[p.tipo - PARENTESCO_HERMANO])
+                  .texto(" (colaterales de grado ").entero(p.grado());
+            if (p.removido() > 0) salida.texto(", removidos ").entero(p.removido()).texto(" vez/veces");
+            salida.texto(")\n");
+            salida.texto("Ancestro comun mas cercano: ").texto(p.comun->nombre).finLinea();
+            salida.texto("Generaciones hasta el: ").entero(p.generacionesA).texto(" / ")
+                  .entero(p.generacionesB).finLinea();
+        }
+        salida.texto("Distancia de parentesco: ").entero(p.distancia()).finLinea();
+        return true;
+    }
+
+    /**
+     * Parentesco de a respecto de b
+     * O(1) con el indice vigente; si no, O(generaciones)
+     */
+    Parentesco parentesco(const Miembro* a, const Miembro* b) const {
+        if (linaje.estaVigente()) return linaje.parentesco(a, b);
+        const Miembro* c = ancestroComun(a, b);
+        if (c == NULL) return Parentesco(NULL, -1, -1);
+        int gc = generacion(c);
+        return Parentesco(c, generacion(a) - gc, generacion(b) - gc);
+    }
+
+    /**
+     * Resuelve muchos nombres a la vez
+     * Si son pocos respecto al arbol (k * log2(n) < n) se busca cada uno;
+     * si no, se ordenan y se cruzan con un solo recorrido inorden,
+     * O(k log k + n), sin bajar desde la raiz por cada nombre. Los
+     * nombres repetidos se resuelven juntos
+     * @param nombres Nombres a resolver
+     * @param miembros Recibe el miembro de cada nombre (NULL si no existe)
+     */
+    void resolverNombres(const vector<const string*> &nombres, vector<Miembro*> &miembros) const {
+        miembros.assign(nombres.size(), (Miembro*)NULL);
+        size_t n = (size_t)totalMiembros();
+        size_t log2Total = 1;
+        while (((size_t)1 << log2Total) < n) log2Total++;
+        if (nombres.size() * log2Total < n) {
+            for (size_t i = 0; i < nombres.size(); i++)
+                miembros[i] = const_cast<Miembro*>(buscarMiembroLectura(*nombres[i]));
+            return;
+        }
+
+        vector<NombreOrdenado> orden(nombres.size());
+        for (size_t i = 0; i < nombres.size(); i++) {
+            orden[i].alto = prefijoClave(*nombres[i]);
+            orden[i].bajo = prefijoClave(*nombres[i], 8);
+            orden[i].resto = prefijoClave(*nombres[i], 16);
+            orden[i].nombre = nombres[i];
+            orden[i].posicion = i;
+        }
+        sort(orden.begin(), orden.end(), nombreOrdenadoAntes);
+
+        // Mezcla con el recorrido inorden: los nombres menores que el
+        // miembro actual no existen, los iguales son ese miembro
+        vector<Miembro*> pila;
+        Miembro* actual = raiz;
+        size_t i = 0;
+        while (i < orden.size() && (actual != NULL || !pila.empty())) {
+            while (actual != NULL) {
+                pila.push_back(actual);
+                actual = actual->izquierdo;
+            }
+            actual = pila.back();
+            pila.pop_back();
+            for (; i < orden.size(); i++) {
+                const NombreOrdenado &o = orden[i];
+                int cmp;
+                if (o.alto != actual->prefijo) cmp = o.alto < actual->prefijo ? -1 : 1;
+                else if (o.bajo != actual->prefijo2) cmp = o.bajo < actual->prefijo2 ? -1 : 1;
+                else if (o.resto != actual->prefijo3) cmp = o.resto < actual->prefijo3 ? -1 : 1;
+                else cmp = o.nombre->compare(actual->nombre);
+                if (cmp > 0) break;
+                if (cmp == 0) miembros[o.posicion] = actual;
+            }
+            actual = actual->derecho;
+        }
+    }
+
+    /**
+     * Parentesco de muchos pares de nombres
+     * Los nombres se resuelven juntos (resolverNombres) y los pares se
+     * reparten entre hilos que solo leen el indice de linaje
+     * @param pares Pares (A, B): cada resultado es A respecto de B
+     * @param resultados Recibe un Parentesco por par, en el mismo orden
+     *                   (PARENTESCO_DESCONOCIDO si algun nombre no existe)
+     * @param hilos Hilos a usar (0 = todos los procesadores)
+     */
+    void resolverParentescos(const vector< pair<string, string> > &pares,
+                             vector<Parentesco> &resultados, int hilos = 0) {
+        prepararLinaje();
+        vector<const string*> nombres;
+        nombres.reserve(2 * pares.size());
+        for (size_t i = 0; i < pares.size(); i++) {
+            nombres.push_back(&pares[i].first);
+            nombres.push_back(&pares[i].second);
+        }
+        vector<Miembro*> miembros;
+        resolverNombres(nombres, miembros);
+
+        resultados.assign(pares.size(), Parentesco());
+        long turnos = ((long)pares.size() + PARES_POR_TURNO - 1) / PARES_POR_TURNO;
+        if (hilos <= 0) hilos = hilosDisponibles();
+        if (hilos > turnos) hilos = (int)turnos;
+        volatile long siguiente = 0;
+        vector<TareaParalela*> tareas;
+        for (int h = 0; h < hilos; h++)
+            tareas.push_back(new TareaParentescos(&linaje, &miembros, &resultados, &siguiente));
+        ejecutarEnParalelo(tareas);
+        for (size_t h = 0; h < tareas.size(); h++) delete tareas[h];
+    }
+
+    /**
+     * Muestra estadisticas avanzadas del arbol
+     */
+    void mostrarEstadisticasAvanzadas() {
+        BufferSalida salida;
+        salida.texto("\n========== ESTADISTICAS AVANZADAS ==========\n");
+
+        int total = totalMiembros();
+        salida.texto("Total de miembros: ").entero(total).finLinea();
+
+        if (total == 0) {
+            salida.texto("No hay miembros en el arbol.\n");
+            salida.texto("===========================================\n");
+            return;
+        }
+
+        // Agregados mantenidos en la raiz: todo es O(1)
+        ResumenEdades r = resumenSubarbol(raiz);
+        salida.texto("Edad promedio: ").decimal(r.promedio(), 2).texto(" anos\n");
+        salida.texto("Edad maxima: ").entero(r.maxima).texto(" anos\n");
+        salida.texto("Edad minima: ").entero(r.minima).texto(" anos\n");
+        salida.texto("Edad mediana: ").decimal(medianaEdad(), 1).texto(" anos\n");
+        salida.texto("Profundidad del arbol: ").entero(obtenerAltura(raiz)).texto(" niveles\n");
+
+        salida.texto("===========================================\n");
+    }
+
+    /**
+     * Resumen de edades de todo el arbol, O(1)
+     */
+    ResumenEdades resumenEdades() const {
+        return resumenSubarbol(raiz);
+    }
+
+    /**
+     * @return true si todos los nodos cumplen el balance AVL
+     */
+    bool estaBalanceado() {
+        return esAVLBalanceado(raiz);
+    }
+
+    /**
+     * @return Niveles del arbol (0 si esta vacio)
+     */
+    int profundidad() const {
+        return raiz == NULL ? 0 : raiz->altura;
+    }
+
+    /**
+     * @return Raiz del arbol (NULL si esta vacio), solo para recorrerlo
+     */
+    Miembro* obtenerRaiz() const {
+        return raiz;
+    }
+
+    /**
+     * Id de un valor de atributo, sin agregarlo a la tabla
+     * @param campo CAMPO_GENERO, CAMPO_RELACION, CAMPO_OCUPACION o CAMPO_LUGAR
+     * @param texto Valor buscado
+     * @return Id o -1 si ningun miembro tiene ese valor
+     */
+    int idAtributo(int campo, const string &texto) const {
+        if (campo == CAMPO_GENERO) return generos.buscar(texto);
+        if (campo == CAMPO_RELACION) return relaciones.buscar(texto);
+        if (campo == CAMPO_OCUPACION) return ocupaciones.buscar(texto);
+        if (campo == CAMPO_LUGAR) return lugares.buscar(texto);
+        return -1;
+    }
+
+    /**
+     * Resumen de edades de los miembros con nombre en [desde, hasta]
+     * (ambos incluidos), O(log n) usando los agregados de cada nodo
+     * @param desde Primer nombre del rango
+     * @param hasta Ultimo nombre del rango
+     */
+    ResumenEdades estadisticasRango(const string &desde, const string &hasta) const {
+        ResumenEdades r;
+        Miembro* nodo = raiz;
+        // Bajar hasta el primer nodo que cae dentro del rango
+        while (nodo != NULL) {
+            if (nodo->nombre.compare(desde) < 0) nodo = nodo->derecho;
+            else if (nodo->nombre.compare(hasta) > 0) nodo = nodo->izquierdo;
+            else break;
+        }
+        if (nodo == NULL) return r;
+        r.agregarEdad(nodo->edad);
+        r.agregar(resumenDesde(nodo->izquierdo, desde));
+        r.agregar(resumenHasta(nodo->derecho, hasta));
+        return r;
+    }
+
+    /**
+     * Muestra estadisticas de edad para un rango de nombres
+     * @param desde Primer nombre del rango (incluido)
+     * @param hasta Ultimo nombre del rango (incluido)
+     */
+    void mostrarEstadisticasRango(const string &desde, const string &hasta) {
+        BufferSalida salida;
+        salida.texto("\n========== ESTADISTICAS DE \"").texto(desde).texto("\" A \"")
+              .texto(hasta).texto("\" ==========\n");
+        ResumenEdades r = estadisticasRango(desde, hasta);
+        salida.texto("Miembros en el rango: ").entero(r.cantidad).finLinea();
+        if (r.cantidad > 0) {
+            salida.texto("Edad promedio: ").decimal(r.promedio(), 2).texto(" anos\n");
+            salida.texto("Edad maxima: ").entero(r.maxima).texto(" anos\n");
+            salida.texto("Edad minima: ").entero(r.minima).texto(" anos\n");
+        }
+        salida.texto("===========================================\n");
+    }
+
+    /**
+     * Muestra conteo de miembros por relacion familiar
+     */
+    void mostrarConteoRelaciones() {
+        BufferSalida salida;
+        salida.texto("\n========== CONTEO POR RELACION FAMILIAR ==========\n");
+
+        // Un contador por relacion registrada: O(#relaciones)
+        vector<unsigned int> ids = relaciones.idsOrdenados();
+        bool hayResultados = false;
+        for (size_t i = 0; i < ids.size(); i++) {
+            size_t cantidad = ids[i] < porRelacion.size() ? porRelacion[ids[i]].size() : 0;
+            if (cantidad == 0) continue;
+            salida.texto(relaciones.texto(ids[i])).texto(": ").entero((long long)cantidad)
+                  .texto(" miembro(s)\n");
+            hayResultados = true;
+        }
+
+        if (!hayResultados) salida.texto("No se encontraron relaciones registradas.\n");
+        salida.texto("==================================================\n");
+    }
+
+    /**
+     * Cantidad de miembros con una relacion familiar
+     * Solo la busqueda del texto compara strings (O(log R)); el conteo
+     * ya esta en el indice por id
+     * @param relacion Relacion a consultar
+     */
+    int contarRelacion(const string &relacion) const {
+        int id = relaciones.buscar(relacion);
+        if (id < 0 || id >= (int)porRelacion.size()) return 0;
+        return (int)porRelacion[id].size();
+    }
+
+    /**
+     * Miembros con una relacion familiar, O(log R + k)
+     * @param relacion Relacion a consultar
+     * @return Miembros de esa relacion (sin orden particular)
+     */
+    vector<Miembro*> listarPorRelacion(const string &relacion) const {
+        int id = relaciones.buscar(relacion);
+        if (id < 0 || id >= (int)porRelacion.size()) return vector<Miembro*>();
+        return porRelacion[id];
+    }
+
+    /**
+     * Muestra los miembros de una relacion familiar
+     * @param relacion Relacion a listar
+     */
+    void mostrarMiembrosRelacion(const string &relacion) {
+        BufferSalida salida;
+        salida.texto("\n=== MIEMBROS CON RELACION \"").texto(relacion).texto("\" ===\n");
+        vector<Miembro*> lista = listarPorRelacion(relacion);
+        imprimirCabeceraTabla(salida);
+        if (lista.empty()) salida.texto("(ninguno)\n");
+        for (size_t i = 0; i < lista.size(); i++)
+            imprimirLineaEnumerada(salida, lista[i], (int)i + 1);
+        salida.texto("-----------------------------------------------------------------\n");
+    }
+
+    /**
+     * Muestra cuanta memoria usa cada miembro con las tablas de simbolos
+     * comparado con guardar los cuatro atributos como strings en el nodo
+     */
+    void mostrarReporteMemoria() const {
+        cout << "\n=== REPORTE DE MEMORIA ===\n";
+        int total = obtenerTamano(raiz);
+        if (total == 0) {
+            cout << "El arbol esta vacio.\n";
+            return;
+        }
+
+        // Antes: cada nodo con sus propios cuatro strings (mas su heap
+        // cuando el texto no cabe dentro del objeto string)
+        size_t tamanoNodoAntes = sizeof(Miembro) - 4 * sizeof(unsigned int)
+                                 + 4 * sizeof(string);
+        size_t heapAtributos = 0, heapNombres = 0;
+        vector<Miembro*> pila;
+        pila.push_back(raiz);
+        while (!pila.empty()) {
+            Miembro* m = pila.back();
+            pila.pop_back();
+            heapNombres += bytesHeapString(m->nombre);
+            const string* textos[4] = {
+                &generos.texto(m->idGenero), &relaciones.texto(m->idRelacion),
+                &ocupaciones.texto(m->idOcupacion), &lugares.texto(m->idLugar)
+            };
+            for (int i = 0; i < 4; i++) {
+                string copia(*textos[i]); // Como lo guardaria cada nodo
+                heapAtributos += bytesHeapString(copia);
+            }
+            if (m->izquierdo != NULL) pila.push_back(m->izquierdo);
+            if (m->derecho != NULL) pila.push_back(m->derecho);
+        }
+        size_t antes = total * tamanoNodoAntes + heapNombres + heapAtributos;
+
+        size_t tablas = generos.bytesUsados() + relaciones.bytesUsados()
+                      + ocupaciones.bytesUsados() + lugares.bytesUsados();
+        size_t ahora = total * sizeof(Miembro) + heapNombres + tablas;
+
+        cout << "Miembros: " << total << "\n";
+        cout << "Valores distintos: " << generos.cantidad() << " generos, "
+             << relaciones.cantidad() << " relaciones, "
+             << ocupaciones.cantidad() << " ocupaciones, "
+             << lugares.cantidad() << " lugares\n";
+        cout << "Nodo con strings: " << tamanoNodoAntes << " bytes; nodo con ids: "
+             << sizeof(Miembro) << " bytes\n";
+        cout << fixed << setprecision(1);
+        cout << "Bytes por miembro (antes): " << (double)antes / total << "\n";
+        cout << "Bytes por miembro (ahora): " << (double)ahora / total
+             << " (tablas: " << tablas << " bytes en total)\n";
+        cout << "Reserva del pool de nodos: " << pool.bytesReservados() << " bytes\n";
+        cout << "Linaje: " << enlacesLinaje << " enlace(s), indice de "
+             << linaje.bytesUsados() << " bytes" << (linaje.estaVigente() ? "" : " (por reconstruir)") << "\n";
+    }
+
+    /**
+     * Muestra el diagrama visual de una region del arbol
+     * La vista es el subarbol de un miembro, hasta cierta cantidad de
+     * niveles; debajo del ultimo nivel se indica cuantos miembros quedan
+     * fuera. Ambas vistas se escriben en streaming, sin armar el
+     * diagrama completo en memoria.
+     * @param nombreRaiz Miembro en la raiz de la vista ("" = raiz del arbol)
+     * @param niveles Niveles a mostrar (<= 0: hasta NIVELES_DIAGRAMA_DEFECTO;
+     *                se limita a NIVELES_DIAGRAMA_MAXIMO)
+     * @return false si nombreRaiz no existe
+     */
+    bool mostrarDiagramaArbol(const string &nombreRaiz = "", int niveles = 0) {
+        Miembro* inicio = raiz;
+        if (!nombreRaiz.empty()) {
+            inicio = localizarMiembro(nombreRaiz).nodo;
+            if (inicio == NULL) return false;
+        }
+        int alturaVista = obtenerAltura(inicio);
+        if (niveles <= 0) niveles = NIVELES_DIAGRAMA_DEFECTO;
+        if (niveles > NIVELES_DIAGRAMA_MAXIMO) niveles = NIVELES_DIAGRAMA_MAXIMO;
+        if (niveles > alturaVista) niveles = alturaVista;
+
+        BufferSalida salida;
+        salida.texto("\n+---------------------------------------------------------------+\n");
+        salida.texto("¦       DIAGRAMA VISUAL DEL ARBOL GENEALOGICO (AVL)            ¦\n");
+        salida.texto("+---------------------------------------------------------------+\n\n");
+        
+        if (raiz == NULL) {
+            salida.texto("  (Arbol vacio - No hay miembros registrados)\n\n");
+            return true;
+        }
+
+        salida.texto("Leyenda: [Abr] = Abreviatura del nombre\n");
+        salida.texto("         /     = Rama izquierda (menor alfabeticamente)\n");
+        salida.texto("         \\     = Rama derecha (mayor alfabeticamente)\n");
+        salida.texto("         +N    = Miembros debajo del ultimo nivel mostrado\n\n");
+        salida.texto("Vista: ").texto(inicio == raiz ? "arbol completo" : inicio->nombre)
+              .texto(" (").entero(inicio->tamano).texto(" miembros), ").entero(niveles)
+              .texto(" de ").entero(alturaVista).texto(" niveles\n\n");
+        
+        salida.texto("VISTA HORIZONTAL (izquierda=arriba, derecha=abajo):\n");
+        salida.texto("---------------------------------------------------\n");
+        imprimirArbolHorizontal(salida, inicio, niveles);
+        
+        salida.texto("\n\nVISTA VERTICAL (estructura de arbol):\n");
+        salida.texto("--------------------------------------\n");
+        imprimirDiagramaVertical(salida, inicio, niveles);
+        
+        salida.texto("\n---------------------------------------------------------------\n");
+        salida.texto("Estadisticas: ").entero(totalMiembros()).texto(" miembros, ");
+        salida.texto("Profundidad: ").entero(obtenerAltura(raiz)).texto(" niveles\n");
+        salida.texto("Balance AVL: ").texto(esAVLBalanceado(raiz) ? "CORRECTO" : "REQUIERE AJUSTE").finLinea();
+        salida.texto("---------------------------------------------------------------\n");
+        return true;
+    }
+};
+
+/* ---------------------------
+   CLASE: ArbolConcurrente
+   Acceso al arbol desde varios hilos. Las busquedas no toman ningun
+   cerrojo: bajan por el arbol mientras un escritor puede estar
+   cambiandolo y al final comprueban con un contador de secuencia
+   (impar durante cada escritura) que ninguno paso; si paso, repiten, y
+   despues de INTENTOS_OPTIMISTAS fallidos toman el cerrojo compartido.
+   Los recorridos y el resumen toman el cerrojo compartido; insertar,
+   modificar y eliminar lo toman en modo exclusivo (un escritor a la
+   vez) y ademas mueven el contador de secuencia.
+   Un nodo eliminado no vuelve al pool en el acto: el arbol lo retiene
+   y se libera por epocas. Cada escritura avanza la epoca; cada lector
+   anuncia en su ranura la epoca en que entro, y un nodo retirado en la
+   epoca e se libera cuando todos los lectores activos entraron despues
+   de e (ya no pueden llegar a el). Los lectores reciben copias, nunca
+   un Miembro*.
+   --------------------------- */
+class ArbolConcurrente {
+private:
+    static const int RANURAS_LECTORES = 64;
+    static const int INTENTOS_OPTIMISTAS = 4;
+
+    // Epoca de un lector activo (0 = ranura libre), una por linea de cache
+    struct RanuraLector {
+        volatile long epoca;
+        char relleno[64 - sizeof(long)];
+    };
+
+    ArbolGenealogico &arbol;
+    mutable CerrojoLectoresEscritor cerrojo;
+    mutable RanuraLector lectores[RANURAS_LECTORES];
+    volatile long secuencia;                 // Impar mientras un escritor cambia el arbol
+    volatile long epoca;                     // Avanza con cada escritura (empieza en 1)
+    vector<Miembro*> eliminados;             // Retenidos por el arbol en la escritura en curso
+    deque< pair<long, Miembro*> > retirados; // Epoca de retiro y nodo, en orden de epoca
+    mutable volatile long lecturasConCerrojo;// Busquedas que terminaron con el cerrojo
+
+    ArbolConcurrente(const ArbolConcurrente&);
+    ArbolConcurrente& operator=(const ArbolConcurrente&);
+
+    /**
+     * Anuncia la epoca actual en una ranura libre
+     * Cada hilo empieza a buscar en una ranura distinta (segun su pila)
+     * @return Ranura tomada, o -1 si estan todas ocupadas
+     */
+    int entrarEpoca() const {
+        int inicio = (int)(((size_t)&inicio >> 12) % RANURAS_LECTORES);
+        for (int i = 0; i < RANURAS_LECTORES; i++) {
+            RanuraLector &ranura = lectores[(inicio + i) % RANURAS_LECTORES];
+            long e = epoca;
+            if (ranura.epoca != 0 || !cambiarSiIgual(&ranura.epoca, 0, e)) continue;
+            // Si un escritor avanzo la epoca antes de ver el anuncio,
+            // anunciar la nueva: lo retirado antes ya no es alcanzable
+            while (epoca != e) {
+                e = epoca;
+                ranura.epoca = e;
+                barreraMemoria();
+            }
+            return (inicio + i) % RANURAS_LECTORES;
+        }
+        return -1;
+    }
+
+    void salirEpoca(int ranura) const {
+        barreraMemoria();
+        lectores[ranura].epoca = 0;
+    }
+
+    /**
+     * Busca sin cerrojo y copia los datos si se pide
+     * @param datos Destino de la copia (NULL: solo saber si existe)
+     * @return 1 si existe, 0 si no, -1 si no se pudo confirmar
+     */
+    int buscarSinCerrojo(const string &nombre, DatosMiembro* datos) const {
+        int ranura = entrarEpoca();
+        if (ranura < 0) return -1;
+        int resultado = -1;
+        for (int intento = 0; intento < INTENTOS_OPTIMISTAS && resultado < 0; intento++) {
+            long antes = secuencia;
+            barreraMemoria();
+            if (antes & 1) continue; // Escritura en curso
+            bool terminado;
+            const Miembro* m = arbol.buscarMiembroOptimista(nombre, terminado);
+            if (terminado && m != NULL && datos != NULL) *datos = arbol.datosDe(m);
+            barreraMemoria();
+            if (terminado && secuencia == antes) resultado = m != NULL ? 1 : 0;
+        }
+        salirEpoca(ranura);
+        return resultado;
+    }
+
+    void empezarCambio() {
+        tomarTurno(&secuencia);
+    }
+
+    /**
+     * Cierra una escritura: retira los nodos que elimino con la epoca
+     * actual, avanza la epoca y libera los retirados que ningun lector
+     * activo puede ver
+     */
+    void terminarCambio() {
+        tomarTurno(&secuencia);
+        for (size_t i = 0; i < eliminados.size(); i++)
+            retirados.push_back(make_pair((long)epoca, eliminados[i]));
+        eliminados.clear();
+        tomarTurno(&epoca);
+        if (retirados.empty()) return;
+
+        long minima = epoca;
+        for (int i = 0; i < RANURAS_LECTORES; i++) {
+            long e = lectores[i].epoca;
+            if (e != 0 && e < minima) minima = e;
+        }
+        while (!retirados.empty() && retirados.front().first < minima) {
+            arbol.liberarRetenido(retirados.front().second);
+            retirados.pop_front();
+        }
+    }
+
+public:
+    explicit ArbolConcurrente(ArbolGenealogico &_arbol)
+        : arbol(_arbol), secuencia(0), epoca(1), lecturasConCerrojo(0)
+    {
+        for (int i = 0; i < RANURAS_LECTORES; i++) lectores[i].epoca = 0;
+        arbol.retenerEliminados(&eliminados);
+    }
+
+    /**
+     * Sin hilos usandolo ya no hay lectores: libera todo lo retenido
+     */
+    ~ArbolConcurrente() {
+        arbol.retenerEliminados(NULL);
+        for (size_t i = 0; i < retirados.size(); i++) arbol.liberarRetenido(retirados[i].second);
+    }
+
+    /**
+     * Busca un miembro y copia sus datos (sin cerrojo; con el
+     * cerrojo compartido si los escritores no lo dejan confirmar)
+     * @return false si no existe
+     */
+    bool buscar(const string &nombre, DatosMiembro &datos) const {
+        int resultado = buscarSinCerrojo(nombre, &datos);
+        if (resultado >= 0) return resultado == 1;
+        tomarTurno(&lecturasConCerrojo);
+        SeccionLectura lectura(cerrojo);
+        const Miembro* m = arbol.buscarMiembroLectura(nombre);
+        if (m == NULL) return false;
+        datos = arbol.datosDe(m);
+        return true;
+    }
+
+    /**
+     * @return true si el nombre existe (sin cerrojo y sin copias)
+     */
+    bool contiene(const string &nombre) const {
+        int resultado = buscarSinCerrojo(nombre, NULL);
+        if (resultado >= 0) return resultado == 1;
+        tomarTurno(&lecturasConCerrojo);
+        SeccionLectura lectura(cerrojo);
+        return arbol.buscarMiembroLectura(nombre) != NULL;
+    }
+
+    /**
+     * Pagina de un recorrido con los datos copiados (lectura compartida)
+     * @param tipo 1 = Preorden, 2 = Inorden, 3 = Postorden, 4 = Por niveles
+     */
+    vector<DatosMiembro> recorrido(int tipo, int desplazamiento, int limite) const {
+        SeccionLectura lectura(cerrojo);
+        vector<Miembro*> pagina;
+        if (tipo == 1) pagina = arbol.paginaPreorden(desplazamiento, limite);
+        else if (tipo == 3) pagina = arbol.paginaPostorden(desplazamiento, limite);
+        else if (tipo == 4) pagina = arbol.paginaPorNiveles(desplazamiento, limite);
+        else pagina = arbol.paginaInorden(desplazamiento, limite);
+        vector<DatosMiembro> datos;
+        datos.reserve(pagina.size());
+        for (size_t i = 0; i < pagina.size(); i++) datos.push_back(arbol.datosDe(pagina[i]));
+        return datos;
+    }
+
+    /**
+     * Resumen de edades de todo el arbol (lectura compartida)
+     */
+    ResumenEdades resumenEdades() const {
+        SeccionLectura lectura(cerrojo);
+        return arbol.resumenEdades();
+    }
+
+    bool insertar(const DatosMiembro &d) {
+        SeccionEscritura escritura(cerrojo);
+        empezarCambio();
+        bool ok = arbol.insertarMiembroAVL(d.nombre, d.edad, d.genero, d.relacionFamiliar,
+                                           d.ocupacion, d.lugarNacimiento);
+        terminarCambio();
+        return ok;
+    }
+
+    bool modificar(const string &nombre, int edad, const string &ocupacion, const string &relacion) {
+        SeccionEscritura escritura(cerrojo);
+        empezarCambio();
+        bool ok = arbol.modificarMiembro(nombre, edad, ocupacion, relacion);
+        terminarCambio();
+        return ok;
+    }
+
+    bool eliminar(const string &nombre) {
+        SeccionEscritura escritura(cerrojo);
+        empezarCambio();
+        bool ok = arbol.eliminarMiembro(nombre);
+        terminarCambio();
+        return ok;
+    }
+
+    /**
+     * @return Busquedas que no se pudieron confirmar sin cerrojo
+     */
+    long busquedasConCerrojo() const {
+        return lecturasConCerrojo;
+    }
+
+    /**
+     * @return Nodos eliminados que todavia esperan a algun lector
+     */
+    size_t nodosRetenidos() const {
+        return retirados.size();
+    }
+};
+
+/* ========== MOTOR PARALELO DE RECORRIDOS ========== */
+
+/* ---------------------------
+   CLASE: FiltroMiembros
+   Condicion sobre un miembro para los recorridos en paralelo. Se
+   evalua desde varios hilos a la vez, asi que no debe modificar nada
+   --------------------------- */
+class FiltroMiembros {
+public:
+    virtual ~FiltroMiembros() {}
+    virtual bool acepta(const Miembro* m) const = 0;
+};
+
+/* ---------------------------
+   CLASE: FiltroAtributo
+   Miembros con un genero, relacion, ocupacion o lugar dado (por id,
+   sin comparar textos)
+   --------------------------- */
+class FiltroAtributo : public FiltroMiembros {
+private:
+    int campo;
+    int id;                        // -1: valor inexistente, nadie pasa
+
+public:
+    FiltroAtributo(int _campo, int _id) : campo(_campo), id(_id) {}
+
+    bool acepta(const Miembro* m) const {
+        if (campo == CAMPO_GENERO) return (int)m->idGenero == id;
+        if (campo == CAMPO_RELACION) return (int)m->idRelacion == id;
+        if (campo == CAMPO_OCUPACION) return (int)m->idOcupacion == id;
+        return (int)m->idLugar == id;
+    }
+};
+
+/* ---------------------------
+   CLASE: ReduccionMiembros
+   Acumulador de una reduccion en paralelo. Cada tramo del arbol se
+   acumula en una copia vacia propia (nueva) y al final las copias se
+   combinan en orden alfabetico de sus tramos, asi que combinar no
+   necesita ser conmutativa
+   --------------------------- */
+class ReduccionMiembros {
+public:
+    virtual ~ReduccionMiembros() {}
+
+    /**
+     * @return Acumulador vacio del mismo tipo (lo libera el motor)
+     */
+    virtual ReduccionMiembros* nueva() const = 0;
+
+    virtual void visitar(const Miembro* m) = 0;
+
+    /**
+     * @param siguiente Acumulador del tramo que sigue a este, del mismo tipo
+     */
+    virtual void combinar(const ReduccionMiembros &siguiente) = 0;
+};
+
+/* ---------------------------
+   CLASE: ReduccionEdades
+   Resumen de edades de los miembros que pasan un filtro. Sin filtro
+   es lo mismo que los agregados de la raiz; con filtro no hay
+   agregados que sirvan y se recorre todo el arbol
+   --------------------------- */
+class ReduccionEdades : public ReduccionMiembros {
+public:
+    const FiltroMiembros* filtro;  // NULL = todos
+    ResumenEdades resumen;
+
+    explicit ReduccionEdades(const FiltroMiembros* _filtro = NULL) : filtro(_filtro) {}
+
+    ReduccionMiembros* nueva() const { return new ReduccionEdades(filtro); }
+
+    void visitar(const Miembro* m) {
+        if (filtro == NULL || filtro->acepta(m)) resumen.agregarEdad(m->edad);
+    }
+
+    void combinar(const ReduccionMiembros &siguiente) {
+        resumen.agregar(static_cast<const ReduccionEdades&>(siguiente).resumen);
+    }
+};
+
+/**
+ * Tramos en que se divide un recorrido por cada hilo: los hilos que
+ * terminan antes siguen con los tramos que quedan, asi un filtro caro
+ * en una zona del arbol no deja hilos ociosos
+ */
+const int TRAMOS_POR_HILO = 8;
+
+/**
+ * Funciones objeto de los hilos para ArbolGenealogico::recorrerTramo
+ */
+struct VisitaReduccion {
+    ReduccionMiembros* reduccion;
+    explicit VisitaReduccion(ReduccionMiembros* _reduccion) : reduccion(_reduccion) {}
+    void operator()(Miembro* m) { reduccion->visitar(m); }
+};
+
+struct VisitaFiltro {
+    const FiltroMiembros* filtro;
+    vector<Miembro*>* salida;
+    VisitaFiltro(const FiltroMiembros* _filtro, vector<Miembro*>* _salida)
+        : filtro(_filtro), salida(_salida) {}
+    void operator()(Miembro* m) { if (filtro->acepta(m)) salida->push_back(m); }
+};
+
+/* ---------------------------
+   CLASE: TareaTramos
+   Un hilo del motor paralelo: toma numeros de tramo de un contador
+   compartido hasta que se acaban. El resultado de cada tramo va a su
+   propia casilla, asi el orden final no depende de que hilo lo hizo
+   --------------------------- */
+class TareaTramos : public TareaParalela {
+public:
+    const ArbolGenealogico* arbol;
+    volatile long* siguiente;
+    int tramos;
+
+    TareaTramos(const ArbolGenealogico* _arbol, volatile long* _siguiente, int _tramos)
+        : arbol(_arbol), siguiente(_siguiente), tramos(_tramos) {}
+
+    virtual void procesar(int tramo) = 0;
+
+    void ejecutar() {
+        for (;;) {
+            long tramo = tomarTurno(siguiente);
+            if (tramo >= tramos) break;
+            procesar((int)tramo);
+        }
+    }
+
+    /**
+     * Primer miembro (en el orden del recorrido) de un tramo: todos
+     * los tramos tienen casi la misma cantidad de miembros
+     */
+    int inicioTramo(int tramo) const {
+        return (int)((long long)arbol->totalMiembros() * tramo / tramos);
+    }
+};
+
+/**
+ * Reduce un tramo inorden en su acumulador
+ */
+class TareaReduccion : public TareaTramos {
+public:
+    vector<ReduccionMiembros*>* parciales;
+
+    TareaReduccion(const ArbolGenealogico* _arbol, volatile long* _siguiente, int _tramos,
+                   vector<ReduccionMiembros*>* _parciales)
+        : TareaTramos(_arbol, _siguiente, _tramos), parciales(_parciales) {}
+
+    void procesar(int tramo) {
+        VisitaReduccion visita((*parciales)[tramo]);
+        int desde = inicioTramo(tramo);
+        arbol->recorrerTramo(2, desde, inicioTramo(tramo + 1) - desde, visita);
+    }
+};
+
+/**
+ * Filtra un tramo de preorden, inorden o postorden, o (tipo 4) un
+ * subarbol de la frontera del recorrido por niveles
+ */
+class TareaFiltro : public TareaTramos {
+public:
+    const FiltroMiembros* filtro;
+    int tipo;
+    vector<vector<Miembro*> >* resultados;                 // Tipos 1 a 3: uno por tramo
+    const vector<Miembro*>* frontera;                      // Tipo 4: subarboles
+    vector<vector<vector<Miembro*> > >* niveles;           // Tipo 4: por subarbol y nivel
+
+    TareaFiltro(const ArbolGenealogico* _arbol, volatile long* _siguiente, int _tramos,
+                const FiltroMiembros* _filtro, int _tipo)
+        : TareaTramos(_arbol, _siguiente, _tramos), filtro(_filtro), tipo(_tipo),
+          resultados(NULL), frontera(NULL), niveles(NULL) {}
+
+    void procesar(int tramo) {
+        if (tipo != 4) {
+            VisitaFiltro visita(filtro, &(*resultados)[tramo]);
+            int desde = inicioTramo(tramo);
+            arbol->recorrerTramo(tipo, desde, inicioTramo(tramo + 1) - desde, visita);
+            return;
+        }
+        // Por niveles dentro del subarbol: una lista por nivel
+        vector<vector<Miembro*> > &porNivel = (*niveles)[tramo];
+        vector<Miembro*> actual(1, (*frontera)[tramo]), proximo;
+        while (!actual.empty()) {
+            porNivel.push_back(vector<Miembro*>());
+            vector<Miembro*> &aceptados = porNivel.back();
+            proximo.clear();
+            for (size_t i = 0; i < actual.size(); i++) {
+                Miembro* m = actual[i];
+                if (filtro->acepta(m)) aceptados.push_back(m);
+                if (m->izquierdo) proximo.push_back(m->izquierdo);
+                if (m->derecho) proximo.push_back(m->derecho);
+            }
+            actual.swap(proximo);
+        }
+    }
+};
+
+/**
+ * Hilos y tramos para recorrer n miembros
+ * @param hilos Hilos pedidos (0 = todos los procesadores)
+ * @return Tramos (0 si no hay miembros); ajusta hilos a no mas que tramos
+ */
+int planificarTramos(int n, int &hilos) {
+    if (hilos <= 0) hilos = hilosDisponibles();
+    int tramos = hilos == 1 ? 1 : hilos * TRAMOS_POR_HILO;
+    if (tramos > n) tramos = n;
+    if (hilos > tramos) hilos = tramos;
+    return tramos;
+}
+
+/**
+ * Reduce todo el arbol en paralelo: cada hilo acumula tramos inorden
+ * contiguos en acumuladores propios, que luego se combinan en orden
+ * @param total Acumulador donde queda el resultado (se le combinan los tramos)
+ * @param hilos Hilos a usar (0 = todos los procesadores)
+ */
+void reducirEnParalelo(const ArbolGenealogico &arbol, ReduccionMiembros &total, int hilos = 0) {
+    int tramos = planificarTramos(arbol.totalMiembros(), hilos);
+    if (tramos == 0) return;
+    vector<ReduccionMiembros*> parciales(tramos);
+    for (int i = 0; i < tramos; i++) parciales[i] = total.nueva();
+
+    volatile long siguiente = 0;
+    vector<TareaParalela*> tareas;
+    for (int h = 0; h < hilos; h++)
+        tareas.push_back(new TareaReduccion(&arbol, &siguiente, tramos, &parciales));
+    ejecutarEnParalelo(tareas);
+
+    for (int i = 0; i < tramos; i++) {
+        total.combinar(*parciales[i]);
+        delete parciales[i];
+    }
+    for (size_t h = 0; h < tareas.size(); h++) delete tareas[h];
+}
+
+/**
+ * Miembros que pasan un filtro, en el orden de un recorrido, buscados
+ * en paralelo. En preorden, inorden y postorden cada hilo filtra tramos
+ * contiguos del orden y los resultados se concatenan por tramo. Por
+ * niveles, los primeros niveles se filtran aqui y cada subarbol de la
+ * frontera se filtra por separado; despues se intercalan nivel a nivel
+ * @param tipo 1 = Preorden, 2 = Inorden, 3 = Postorden, 4 = Por niveles
+ * @param hilos Hilos a usar (0 = todos los procesadores)
+ */
+vector<Miembro*> filtrarEnParalelo(const ArbolGenealogico &arbol, const FiltroMiembros &filtro,
+                                   int tipo, int hilos = 0)
+{
+    vector<Miembro*> salida;
+    int tramos = planificarTramos(arbol.totalMiembros(), hilos);
+    if (tramos == 0) return salida;
+    volatile long siguiente = 0;
+    vector<TareaFiltro*> tareas;
+
+    if (tipo != 4) {
+        vector<vector<Miembro*> > resultados(tramos);
+        for (int h = 0; h < hilos; h++) {
+            tareas.push_back(new TareaFiltro(&arbol, &siguiente, tramos, &filtro, tipo));
+            tareas.back()->resultados = &resultados;
+        }
+        ejecutarEnParalelo(vector<TareaParalela*>(tareas.begin(), tareas.end()));
+        size_t total = 0;
+        for (int i = 0; i < tramos; i++) total += resultados[i].size();
+        salida.reserve(total);
+        for (int i = 0; i < tramos; i++)
+            salida.insert(salida.end(), resultados[i].begin(), resultados[i].end());
+    } else {
+        // Niveles superiores hasta tener un subarbol por tramo
+        vector<Miembro*> frontera(1, arbol.obtenerRaiz()), proximo;
+        while ((int)frontera.size() < tramos) {
+            proximo.clear();
+            for (size_t i = 0; i < frontera.size(); i++) {
+                if (filtro.acepta(frontera[i])) salida.push_back(frontera[i]);
+                if (frontera[i]->izquierdo) proximo.push_back(frontera[i]->izquierdo);
+                if (frontera[i]->derecho) proximo.push_back(frontera[i]->derecho);
+            }
+            frontera.swap(proximo);
+            if (frontera.empty()) return salida;
+        }
+        vector<vector<vector<Miembro*> > > niveles(frontera.size());
+        int subarboles = (int)frontera.size();
+        if (hilos > subarboles) hilos = subarboles;
+        for (int h = 0; h < hilos; h++) {
+            tareas.push_back(new TareaFiltro(&arbol, &siguiente, subarboles, &filtro, tipo));
+            tareas.back()->frontera = &frontera;
+            tareas.back()->niveles = &niveles;
+        }
+        ejecutarEnParalelo(vector<TareaParalela*>(tareas.begin(), tareas.end()));
+        for (size_t nivel = 0; ; nivel++) {
+            bool quedan = false;
+            for (size_t i = 0; i < niveles.size(); i++) {
+                if (nivel >= niveles[i].size()) continue;
+                quedan = true;
+                salida.insert(salida.end(), niveles[i][nivel].begin(), niveles[i][nivel].end());
+            }
+            if (!quedan) break;
+        }
+    }
+    for (size_t h = 0; h < tareas.size(); h++) delete tareas[h];
+    return salida;
+}
+
+/* ========== FUNCIONES DE VALIDACION ========== */
+
+/**
+ * Limpia el buffer de entrada
+ */
+void limpiarEntradas() {
+    cin.clear();
+    cin.ignore(numeric_limits<streamsize>::max(), '\n');
+}
+
+/*
+ * Reglas de validacion sin mensajes: las usan los validadores
+ * interactivos y el modo por lotes, que informa sus propios errores
+ */
+
+/**
+ * @return true si el texto tiene algun caracter que no sea espacio
+ */
+bool esTextoValido(const string &texto) {
+    for (size_t i = 0; i < texto.length(); i++)
+        if (texto[i] != ' ' && texto[i] != '\t') return true;
+    return false;
+}
+
+/**
+ * @return true si la edad esta entre 0 y 150 anos
+ */
+bool esEdadValida(int edad) {
+    return edad >= 0 && edad <= 150;
+}
+
+/**
+ * @return true si el genero es "Masculino" o "Femenino"
+ */
+bool esGeneroValido(const string &genero) {
+    return genero == "Masculino" || genero == "Femenino";
+}
+
+/**
+ * Valida que una cadena no este vacia
+ * @param texto Texto a validar
+ * @return true si es valido
+ */
+bool validarTextoNoVacio(const string &texto) {
+    if (texto.empty()) {
+        cout << "ERROR: El campo no puede estar vacio.\n";
+        return false;
+    }
+    if (!esTextoValido(texto)) {
+        cout << "ERROR: El campo no puede contener solo espacios.\n";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Valida que la edad este en un rango razonable
+ * @param edad Edad a validar
+ * @return true si es valido
+ */
+bool validarEdad(int edad) {
+    if (!esEdadValida(edad)) {
+        cout << "ERROR: La edad debe estar entre 0 y 150 anos.\n";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Valida que el genero sea Masculino o Femenino
+ * @param genero Genero a validar
+ * @return true si es valido
+ */
+bool validarGenero(const string &genero) {
+    if (!esGeneroValido(genero)) {
         cout << "ERROR: El genero debe ser 'Masculino' o 'Femenino'.\n";
         return false;
     }
-    return true;
+    return true;
+}
+
+/**
+ * Lee un numero entero con validacion
+ * @param prompt Mensaje a mostrar
+ * @return Numero ingresado valido
+ */
+int leerEntero(const string &prompt) {
+    int valor;
+    while (true) {
+        cout << prompt;
+        if (cin >> valor) {
+            limpiarEntradas();
+            return valor;
+        } else {
+            cout << "ERROR: Debe ingresar un numero entero valido.\n";
+            limpiarEntradas();
+        }
+    }
+}
+
+/**
+ * Lee una cadena con validacion de no vacio
+ * @param prompt Mensaje a mostrar
+ * @return Cadena ingresada valida
+ */
+string leerTexto(const string &prompt) {
+    string texto;
+    while (true) {
+        cout << prompt;
+        getline(cin, texto);
+        if (validarTextoNoVacio(texto)) {
+            return texto;
+        }
+    }
+}
+
+/**
+ * Lee y valida una edad
+ * @param prompt Mensaje a mostrar
+ * @return Edad valida
+ */
+int leerEdad(const string &prompt) {
+    int edad;
+    while (true) {
+        edad = leerEntero(prompt);
+        if (validarEdad(edad)) {
+            return edad;
+        }
+    }
+}
+
+/**
+ * Lee y valida un genero
+ * @param prompt Mensaje a mostrar
+ * @return Genero valido
+ */
+string leerGenero(const string &prompt) {
+    string genero;
+    while (true) {
+        cout << prompt << " (Masculino/Femenino): ";
+        getline(cin, genero);
+        if (validarGenero(genero)) {
+            return genero;
+        }
+    }
+}
+
+/**
+ * Pausa la ejecucion hasta que el usuario presione Enter
+ */
+void pausar() {
+    cout << "\nPresione ENTER para continuar...";
+    cin.get();
+}
+
+/**
+ * Limpia la pantalla (compatible con Windows y Linux)
+ */
+void limpiarPantalla() {
+    #ifdef _WIN32
+        system("cls");
+    #else
+        system("clear");
+    #endif
+}
+
+/**
+ * Lee el maximo de filas a mostrar en una busqueda
+ */
+int leerLimiteBusqueda() {
+    int limite = leerEntero("Maximo de miembros a mostrar (0 = 50): ");
+    return limite > 0 ? limite : 50;
+}
+
+/* ========== MENUS DEL SISTEMA ========== */
+
+/**
+ * Muestra el submenu de recorridos
+ * @param arbol Referencia al arbol genealogico
+ */
+void submenuRecorridos(ArbolGenealogico &arbol) {
+    int opcion;
+    do {
+        limpiarPantalla();
+        cout << "\n+----------------------------------------+\n";
+        cout << "?     SUBMENU: RECORRIDOS DEL ARBOL      ?\n";
+        cout << "+----------------------------------------+\n";
+        cout << "  1. Recorrido PREORDEN\n";
+        cout << "  2. Recorrido INORDEN (Orden alfabetico)\n";
+        cout << "  3. Recorrido POSTORDEN\n";
+        cout << "  4. Recorrido POR NIVELES\n";
+        cout << "  5. Recorrido PAGINADO\n";
+        cout << "  0. Volver al menu principal\n";
+        cout << "-----------------------------------------\n";
+        
+        opcion = leerEntero("Seleccione una opcion: ");
+        
+        switch(opcion) {
+            case 1:
+                arbol.mostrarPreorden();
+                pausar();
+                break;
+            case 2:
+                arbol.mostrarInorden();
+                pausar();
+                break;
+            case 3:
+                arbol.mostrarPostorden();
+                pausar();
+                break;
+            case 4:
+                arbol.mostrarPorNiveles();
+                pausar();
+                break;
+            case 5: {
+                int tipo = leerEntero("Recorrido (1=Preorden, 2=Inorden, 3=Postorden): ");
+                int tamanoPagina = leerEntero("Miembros por pagina: ");
+                int numeroPagina = leerEntero("Numero de pagina: ");
+                arbol.mostrarPaginaRecorrido(tipo, numeroPagina, tamanoPagina);
+                pausar();
+                break;
+            }
+            case 0:
+                cout << "Volviendo al menu principal...\n";
+                break;
+            default:
+                cout << "ERROR: Opcion no valida.\n";
+                pausar();
+        }
+    } while (opcion != 0);
+}
+
+/**
+ * Muestra el submenu de estadisticas
+ * @param arbol Referencia al arbol genealogico
+ */
+void submenuEstadisticas(ArbolGenealogico &arbol) {
+    int opcion;
+    do {
+        limpiarPantalla();
+        cout << "\n+----------------------------------------+\n";
+        cout << "?      SUBMENU: ESTADISTICAS             ?\n";
+        cout << "+----------------------------------------+\n";
+        cout << "  1. Estadisticas avanzadas\n";
+        cout << "  2. Conteo por relacion familiar\n";
+        cout << "  3. Historial de operaciones\n";
+        cout << "  4. Estadisticas por rango de nombres\n";
+        cout << "  5. Listar miembros de una relacion\n";
+        cout << "  6. Reporte de memoria\n";
+        cout << "  7. Miembros por rango de edad\n";
+        cout << "  8. Miembros mas longevos\n";
+        cout << "  0. Volver al menu principal\n";
+        cout << "-----------------------------------------\n";
+        
+        opcion = leerEntero("Seleccione una opcion: ");
+        
+        switch(opcion) {
+            case 1:
+                arbol.mostrarEstadisticasAvanzadas();
+                pausar();
+                break;
+            case 2:
+                arbol.mostrarConteoRelaciones();
+                pausar();
+                break;
+            case 3:
+                arbol.mostrarHistorial();
+                pausar();
+                break;
+            case 4: {
+                string desde = leerTexto("Desde el nombre: ");
+                string hasta = leerTexto("Hasta el nombre: ");
+                arbol.mostrarEstadisticasRango(desde, hasta);
+                pausar();
+                break;
+            }
+            case 5: {
+                string relacion = leerTexto("Relacion familiar: ");
+                arbol.mostrarMiembrosRelacion(relacion);
+                pausar();
+                break;
+            }
+            case 6:
+                arbol.mostrarReporteMemoria();
+                pausar();
+                break;
+            case 7: {
+                int desde = leerEdad("Desde la edad: ");
+                int hasta = leerEdad("Hasta la edad: ");
+                arbol.mostrarMiembrosPorEdad(desde, hasta, leerLimiteBusqueda());
+                pausar();
+                break;
+            }
+            case 8: {
+                int k = leerEntero("Cantidad de miembros: ");
+                arbol.mostrarMasLongevos(k);
+                pausar();
+                break;
+            }
+            case 0:
+                cout << "Volviendo al menu principal...\n";
+                break;
+            default:
+                cout << "ERROR: Opcion no valida.\n";
+                pausar();
+        }
+    } while (opcion != 0);
+}
+
+/**
+ * Funcion para insertar un nuevo miembro con validaciones
+ * @param arbol Referencia al arbol genealogico
+ */
+void insertarNuevoMiembro(ArbolGenealogico &arbol) {
+    limpiarPantalla();
+    cout << "\n+----------------------------------------+\n";
+    cout << "?      INSERTAR NUEVO MIEMBRO            ?\n";
+    cout << "+----------------------------------------+\n\n";
+    
+    string nombre = leerTexto("Nombre completo: ");
+    
+    // Verificar si ya existe (la posicion se reutiliza al insertar)
+    PosicionMiembro pos = arbol.localizarMiembro(nombre);
+    if (pos.nodo != NULL) {
+        cout << "\nERROR: Ya existe un miembro con ese nombre.\n";
+        pausar();
+        return;
+    }
+    
+    int edad = leerEdad("Edad: ");
+    string genero = leerGenero("Genero");
+    string relacion = leerTexto("Relacion familiar: ");
+    string ocupacion = leerTexto("Ocupacion: ");
+    string lugar = leerTexto("Lugar de nacimiento: ");
+    
+    bool ok = arbol.insertarEnPosicion(pos, nombre, edad, genero, relacion, ocupacion, lugar);
+    if (ok) {
+        MetricasOperacion met = arbol.metricasUltimaOperacion();
+        cout << "\n? Miembro insertado exitosamente con balanceo AVL.\n";
+        cout << "  (" << met.rotaciones << " rotacion(es))\n";
+    } else {
+        cout << "\nERROR: No se pudo insertar el miembro.\n";
+    }
+    pausar();
+}
+
+/**
+ * Funcion para buscar un miembro
+ * @param arbol Referencia al arbol genealogico
+ */
+void buscarMiembroPorNombre(ArbolGenealogico &arbol) {
+    limpiarPantalla();
+    cout << "\n+----------------------------------------+\n";
+    cout << "?       BUSCAR MIEMBRO POR NOMBRE        ?\n";
+    cout << "+----------------------------------------+\n\n";
+    
+    string nombre = leerTexto("Nombre a buscar: ");
+    Miembro* m = arbol.buscarMiembro(nombre);
+    MetricasOperacion met = arbol.metricasUltimaOperacion();
+    
+    if (m) {
+        arbol.imprimirMiembroCompleto(m);
+        cout << "(" << met.comparaciones << " comparacion(es) de nombres, "
+             << met.comparacionesCompletas << " con el texto completo)\n";
+    } else {
+        cout << "\nMiembro no encontrado en el arbol.\n";
+    }
+    pausar();
+}
+
+/**
+ * Muestra el submenu de busquedas
+ * @param arbol Referencia al arbol genealogico
+ */
+void submenuBusquedas(ArbolGenealogico &arbol) {
+    int opcion;
+    do {
+        limpiarPantalla();
+        cout << "\n+----------------------------------------+\n";
+        cout << "?        SUBMENU: BUSQUEDAS              ?\n";
+        cout << "+----------------------------------------+\n";
+        cout << "  1. Buscar por nombre exacto\n";
+        cout << "  2. Buscar por comienzo del nombre\n";
+        cout << "  3. Buscar por rango de nombres\n";
+        cout << "  0. Volver al menu principal\n";
+        cout << "-----------------------------------------\n";
+
+        opcion = leerEntero("Seleccione una opcion: ");
+
+        switch(opcion) {
+            case 1:
+                buscarMiembroPorNombre(arbol);
+                break;
+            case 2: {
+                string prefijo = leerTexto("Comienzo del nombre: ");
+                int limite = leerLimiteBusqueda();
+                int inicio = 0;
+                int cantidad = arbol.tramoPrefijo(prefijo, inicio);
+                arbol.mostrarCoincidencias("NOMBRES QUE EMPIEZAN CON \"" + prefijo + "\"",
+                                           inicio, cantidad, limite);
+                pausar();
+                break;
+            }
+            case 3: {
+                string desde = leerTexto("Desde el nombre: ");
+                string hasta = leerTexto("Hasta el nombre: ");
+                int limite = leerLimiteBusqueda();
+                int inicio = 0;
+                int cantidad = arbol.tramoRango(desde, hasta, inicio);
+                arbol.mostrarCoincidencias("NOMBRES DE \"" + desde + "\" A \"" + hasta + "\"",
+                                           inicio, cantidad, limite);
+                pausar();
+                break;
+            }
+            case 0:
+                cout << "Volviendo al menu principal...\n";
+                break;
+            default:
+                cout << "ERROR: Opcion no valida.\n";
+                pausar();
+        }
+    } while (opcion != 0);
+}
+
+/**
+ * Submenu de linaje: progenitores, ancestros, hijos y parentesco
+ * @param arbol Referencia al arbol genealogico
+ */
+void submenuLinaje(ArbolGenealogico &arbol) {
+    int opcion;
+    do {
+        limpiarPantalla();
+        cout << "\n+----------------------------------------+\n";
+        cout << "?        SUBMENU: LINAJE FAMILIAR        ?\n";
+        cout << "+----------------------------------------+\n";
+        cout << "  1. Asignar progenitor\n";
+        cout << "  2. Quitar progenitor\n";
+        cout << "  3. Ver ancestros e hijos de un miembro\n";
+        cout << "  4. Parentesco entre dos miembros\n";
+        cout << "  0. Volver al menu principal\n";
+        cout << "-----------------------------------------\n";
+
+        opcion = leerEntero("Seleccione una opcion: ");
+
+        switch(opcion) {
+            case 1: {
+                string hijo = leerTexto("Nombre del hijo o hija: ");
+                string progenitor = leerTexto("Nombre del progenitor: ");
+                string error;
+                if (arbol.asignarProgenitor(hijo, progenitor, error))
+                    cout << "\n? " << progenitor << " es ahora progenitor de " << hijo << ".\n";
+                else
+                    cout << "\nERROR: " << error << ".\n";
+                pausar();
+                break;
+            }
+            case 2: {
+                string hijo = leerTexto("Nombre del hijo o hija: ");
+                if (arbol.quitarProgenitor(hijo))
+                    cout << "\n? " << hijo << " ya no tiene progenitor asignado.\n";
+                else
+                    cout << "\nERROR: El miembro no existe o no tiene progenitor.\n";
+                pausar();
+                break;
+            }
+            case 3: {
+                string nombre = leerTexto("Nombre del miembro: ");
+                if (!arbol.mostrarLinaje(nombre))
+                    cout << "\nERROR: El miembro '" << nombre << "' no existe.\n";
+                pausar();
+                break;
+            }
+            case 4: {
+                string a = leerTexto("Primer miembro: ");
+                string b = leerTexto("Segundo miembro: ");
+                if (!arbol.mostrarParentesco(a, b))
+                    cout << "\nERROR: Alguno de los miembros no existe.\n";
+                pausar();
+                break;
+            }
+            case 0:
+                cout << "Volviendo al menu principal...\n";
+                break;
+            default:
+                cout << "ERROR: Opcion no valida.\n";
+                pausar();
+        }
+    } while (opcion != 0);
+}
+
+/**
+ * Funcion para modificar un miembro existente
+ * @param arbol Referencia al arbol genealogico
+ */
+void modificarMiembroExistente(ArbolGenealogico &arbol) {
+    limpiarPantalla();
+    cout << "\n+----------------------------------------+\n";
+    cout << "?        MODIFICAR MIEMBRO               ?\n";
+    cout << "+----------------------------------------+\n\n";
+    
+    string nombre = leerTexto("Nombre del miembro a modificar: ");
+    PosicionMiembro pos = arbol.localizarMiembro(nombre);
+    Miembro* m = pos.nodo;
+    
+    if (!m) {
+        cout << "\nERROR: Miembro no encontrado.\n";
+        pausar();
+        return;
+    }
+    
+    cout << "\n--- Datos actuales ---\n";
+    arbol.imprimirMiembroCompleto(m);
+    
+    cout << "\n--- Ingrese los nuevos datos ---\n";
+    int nuevaEdad = leerEdad("Nueva edad: ");
+    string nuevaOcupacion = leerTexto("Nueva ocupacion: ");
+    string nuevaRelacion = leerTexto("Nueva relacion familiar: ");
+    
+    bool ok = arbol.modificarMiembro(pos, nuevaEdad, nuevaOcupacion, nuevaRelacion);
+    if (ok) {
+        cout << "\n? Miembro modificado correctamente.\n";
+    } else {
+        cout << "\nERROR: No se pudo modificar el miembro.\n";
+    }
+    pausar();
 }
 
 /**
- * Lee un numero entero con validacion
- * @param prompt Mensaje a mostrar
- * @return Numero ingresado valido
+ * Funcion para eliminar un miembro
+ * @param arbol Referencia al arbol genealogico
  */
-int leerEntero(const string &prompt) {
-    int valor;
-    while (true) {
-        cout << prompt;
-        if (cin >> valor) {
-            limpiarEntradas();
-            return valor;
+void eliminarMiembroDelArbol(ArbolGenealogico &arbol) {
+    limpiarPantalla();
+    cout << "\n+----------------------------------------+\n";
+    cout << "?         ELIMINAR MIEMBRO               ?\n";
+    cout << "+----------------------------------------+\n\n";
+    
+    string nombre = leerTexto("Nombre del miembro a ELIMINAR: ");
+    PosicionMiembro pos = arbol.localizarMiembro(nombre);
+    Miembro* m = pos.nodo;
+    
+    if (!m) {
+        cout << "\nERROR: Miembro no encontrado.\n";
+        pausar();
+        return;
+    }
+    
+    arbol.imprimirMiembroCompleto(m);
+    cout << "\n?Esta seguro de eliminar este miembro? (S/N): ";
+    string confirmacion;
+    getline(cin, confirmacion);
+    
+    if (confirmacion == "S" || confirmacion == "s") {
+        bool ok = arbol.eliminarEnPosicion(pos);
+        if (ok) {
+            MetricasOperacion met = arbol.metricasUltimaOperacion();
+            cout << "\n? Miembro eliminado y arbol rebalanceado (AVL).\n";
+            cout << "  (" << met.rotaciones << " rotacion(es))\n";
         } else {
-            cout << "ERROR: Debe ingresar un numero entero valido.\n";
-            limpiarEntradas();
+            cout << "\nERROR: No se pudo eliminar el miembro.\n";
         }
+    } else {
+        cout << "\nEliminacion cancelada.\n";
     }
+    pausar();
 }
 
 /**
- * Lee una cadena con validacion de no vacio
- * @param prompt Mensaje a mostrar
- * @return Cadena ingresada valida
+ * Funcion para congelar el indice de busqueda
+ * @param arbol Referencia al arbol genealogico
  */
-string leerTexto(const string &prompt) {
-    string texto;
-    while (true) {
-        cout << prompt;
-        getline(cin, texto);
-        if (validarTextoNoVacio(texto)) {
-            return texto;
-        }
-    }
+void optimizarBusquedas(ArbolGenealogico &arbol) {
+    limpiarPantalla();
+    cout << "\n+----------------------------------------+\n";
+    cout << "?      OPTIMIZAR BUSQUEDAS               ?\n";
+    cout << "+----------------------------------------+\n\n";
+
+    int total = arbol.congelar();
+    cout << "? Indice congelado con " << total << " miembro(s) ("
+         << arbol.bytesIndiceCongelado() << " bytes).\n";
+    cout << "  Las busquedas lo usan hasta la proxima insercion o eliminacion.\n";
+    pausar();
 }
 
 /**
- * Lee y valida una edad
- * @param prompt Mensaje a mostrar
- * @return Edad valida
+ * Funcion para guardar el arbol en la instantanea binaria
+ * @param arbol Referencia al arbol genealogico
  */
-int leerEdad(const string &prompt) {
-    int edad;
-    while (true) {
-        edad = leerEntero(prompt);
-        if (validarEdad(edad)) {
-            return edad;
+void guardarArbolEnDisco(ArbolGenealogico &arbol) {
+    limpiarPantalla();
+    cout << "\n+----------------------------------------+\n";
+    cout << "?      GUARDAR ARBOL EN DISCO            ?\n";
+    cout << "+----------------------------------------+\n\n";
+
+    // Cada cambio ya esta en el diario; guardar la instantanea lo compacta
+    unsigned long long bytesAntes = arbol.bytesDiario();
+    if (arbol.guardarInstantanea(RUTA_INSTANTANEA)) {
+        cout << "? " << arbol.totalMiembros() << " miembro(s) guardados en "
+             << RUTA_INSTANTANEA << ".\n";
+        cout << "  Diario compactado (" << bytesAntes << " -> "
+             << arbol.bytesDiario() << " bytes).\n";
+    } else {
+        cout << "ERROR: No se pudo escribir " << RUTA_INSTANTANEA << ".\n";
+    }
+    pausar();
+}
+
+/* ========== MODO POR LOTES ========== */
+
+/* ---------------------------
+   CLASE: LectorLineas
+   Lee un archivo (o la entrada estandar) en bloques grandes y
+   entrega una linea a la vez apuntando al buffer, sin copiarla
+   --------------------------- */
+class LectorLineas {
+private:
+    FILE* archivo;
+    bool propio;                // false para la entrada estandar
+    vector<char> buffer;
+    size_t inicio;              // Primer byte sin entregar
+    size_t fin;                 // Bytes validos en el buffer
+    bool agotado;               // Ya no hay mas datos que leer
+
+    static const size_t BLOQUE = 1 << 20;
+
+    // No copiable: el destructor cierra el archivo
+    LectorLineas(const LectorLineas&);
+    LectorLineas& operator=(const LectorLineas&);
+
+    /**
+     * Mueve lo pendiente al inicio del buffer y lee otro bloque
+     * Si una linea no cabe, el buffer crece al doble
+     */
+    void rellenar() {
+        if (inicio > 0) {
+            memmove(&buffer[0], &buffer[inicio], fin - inicio);
+            fin -= inicio;
+            inicio = 0;
+        }
+        if (fin == buffer.size()) buffer.resize(buffer.size() * 2);
+        size_t leidos = fread(&buffer[fin], 1, buffer.size() - fin, archivo);
+        if (leidos == 0) agotado = true;
+        fin += leidos;
+    }
+
+public:
+    LectorLineas() : archivo(NULL), propio(false), inicio(0), fin(0), agotado(true) {}
+    ~LectorLineas() { cerrar(); }
+
+    /**
+     * @param ruta Archivo a leer ("-" = entrada estandar)
+     * @return false si no se pudo abrir
+     */
+    bool abrir(const string &ruta) {
+        cerrar();
+        if (ruta == "-") {
+            archivo = stdin;
+            propio = false;
+        } else {
+            archivo = fopen(ruta.c_str(), "rb");
+            propio = true;
+        }
+        if (archivo == NULL) return false;
+        buffer.resize(BLOQUE);
+        inicio = fin = 0;
+        agotado = false;
+        return true;
+    }
+
+    void cerrar() {
+        if (archivo != NULL && propio) fclose(archivo);
+        archivo = NULL;
+    }
+
+    /**
+     * Entrega la siguiente linea (sin el salto ni un '\r' final)
+     * El puntero es valido hasta la proxima llamada
+     * @return false al terminar la entrada
+     */
+    bool siguiente(const char* &linea, size_t &n) {
+        while (true) {
+            const char* desde = buffer.empty() ? NULL : &buffer[0] + inicio;
+            const char* salto = desde == NULL ? NULL
+                : static_cast<const char*>(memchr(desde, '\n', fin - inicio));
+            if (salto != NULL || (agotado && inicio < fin)) {
+                size_t largo = salto != NULL ? (size_t)(salto - desde) : fin - inicio;
+                inicio += largo + (salto != NULL ? 1 : 0);
+                if (largo > 0 && desde[largo - 1] == '\r') largo--;
+                linea = desde;
+                n = largo;
+                return true;
+            }
+            if (agotado || archivo == NULL) return false;
+            rellenar();
         }
     }
+};
+
+/**
+ * Trozo de una linea de comando (sin copiar)
+ */
+struct CampoLote {
+    const char* inicio;
+    size_t largo;
+
+    string comoTexto() const { return string(inicio, largo); }
+
+    bool es(const char* palabra) const {
+        return strlen(palabra) == largo && memcmp(inicio, palabra, largo) == 0;
+    }
+};
+
+const int MAX_CAMPOS_LOTE = 8;
+
+/**
+ * Separa una linea por '|' quitando espacios alrededor de cada campo
+ * @return Cantidad de campos (hasta MAX_CAMPOS_LOTE; el ultimo se queda
+ *         con el resto de la linea)
+ */
+int separarCampos(const char* linea, size_t n, CampoLote campos[]) {
+    int cantidad = 0;
+    size_t i = 0;
+    while (cantidad < MAX_CAMPOS_LOTE) {
+        size_t j = i;
+        if (cantidad < MAX_CAMPOS_LOTE - 1)
+            while (j < n && linea[j] != '|') j++;
+        else
+            j = n;
+        size_t a = i, b = j;
+        while (a < b && (linea[a] == ' ' || linea[a] == '\t')) a++;
+        while (b > a && (linea[b-1] == ' ' || linea[b-1] == '\t')) b--;
+        campos[cantidad].inicio = linea + a;
+        campos[cantidad].largo = b - a;
+        cantidad++;
+        if (j >= n) break;
+        i = j + 1;
+    }
+    return cantidad;
 }
 
 /**
- * Lee y valida un genero
- * @param prompt Mensaje a mostrar
- * @return Genero valido
+ * Convierte un campo a entero (solo digitos con signo opcional)
+ * @return false si el campo no es un entero valido
  */
-string leerGenero(const string &prompt) {
-    string genero;
-    while (true) {
-        cout << prompt << " (Masculino/Femenino): ";
-        getline(cin, genero);
-        if (validarGenero(genero)) {
-            return genero;
-        }
+bool campoEntero(const CampoLote &campo, int &valor) {
+    size_t i = 0;
+    bool negativo = false;
+    if (i < campo.largo && (campo.inicio[i] == '-' || campo.inicio[i] == '+'))
+        negativo = campo.inicio[i++] == '-';
+    if (i == campo.largo || campo.largo - i > 9) return false;
+    int v = 0;
+    for (; i < campo.largo; i++) {
+        char c = campo.inicio[i];
+        if (c < '0' || c > '9') return false;
+        v = v * 10 + (c - '0');
     }
+    valor = negativo ? -v : v;
+    return true;
 }
 
 /**
- * Pausa la ejecucion hasta que el usuario presione Enter
+ * Escribe los datos de un miembro separados por '|'
  */
-void pausar() {
-    cout << "\nPresione ENTER para continuar...";
-    cin.get();
+void escribirMiembroLote(BufferSalida &salida, const ArbolGenealogico &arbol, const Miembro* m) {
+    DatosMiembro d = arbol.datosDe(m);
+    salida.texto(d.nombre).caracter('|').entero(d.edad).caracter('|')
+          .texto(d.genero).caracter('|').texto(d.relacionFamiliar).caracter('|')
+          .texto(d.ocupacion).caracter('|').texto(d.lugarNacimiento);
+}
+
+/* ---------------------------
+   ESTRUCTURA: RegistroImportado
+   Fila valida del archivo con su numero de linea
+   --------------------------- */
+struct RegistroImportado {
+    DatosMiembro datos;
+    long long linea;
+};
+
+/* ---------------------------
+   ESTRUCTURA: RechazoImportacion
+   Fila descartada y la causa
+   --------------------------- */
+struct RechazoImportacion {
+    long long linea;
+    string motivo;
+
+    RechazoImportacion(long long _linea, const string &_motivo)
+        : linea(_linea), motivo(_motivo) {}
+};
+
+bool rechazoAntes(const RechazoImportacion &a, const RechazoImportacion &b) {
+    return a.linea < b.linea;
 }
 
+/* ---------------------------
+   ESTRUCTURA: ClaveImportada
+   Entrada del orden de la importacion: los 16 primeros bytes del
+   nombre van junto al puntero, asi casi todas las comparaciones se
+   resuelven con enteros en un arreglo contiguo, sin ir al registro
+   --------------------------- */
+struct ClaveImportada {
+    unsigned long long alto;            // Bytes 0..7 del nombre
+    unsigned long long bajo;            // Bytes 8..15
+    RegistroImportado* registro;
+};
+
 /**
- * Limpia la pantalla (compatible con Windows y Linux)
+ * Orden por nombre; a igual nombre va primero la linea anterior
  */
-void limpiarPantalla() {
-    #ifdef _WIN32
-        system("cls");
-    #else
-        system("clear");
-    #endif
+bool claveAntes(const ClaveImportada &a, const ClaveImportada &b) {
+    if (a.alto != b.alto) return a.alto < b.alto;
+    if (a.bajo != b.bajo) return a.bajo < b.bajo;
+    int c = a.registro->datos.nombre.compare(b.registro->datos.nombre);
+    if (c != 0) return c < 0;
+    return a.registro->linea < b.registro->linea;
 }
 
-/* ========== MENUS DEL SISTEMA ========== */
+/* ---------------------------
+   ESTRUCTURA: ResultadoImportacion
+   Resumen de una importacion y tiempo de cada fase
+   --------------------------- */
+struct ResultadoImportacion {
+    bool abierto;                       // false si no se pudo leer el archivo
+    long long lineas;                   // Lineas leidas (incluida la cabecera)
+    int cargados;                       // Miembros en el arbol al terminar
+    vector<RechazoImportacion> rechazos;// Invalidas y repetidas, por linea
+    int hilos;
+    double msLectura, msOrden, msConstruccion;
+
+    ResultadoImportacion()
+        : abierto(false), lineas(0), cargados(0), hilos(0),
+          msLectura(0), msOrden(0), msConstruccion(0) {}
+};
 
 /**
- * Muestra el submenu de recorridos
- * @param arbol Referencia al arbol genealogico
+ * Quita espacios y tabuladores al inicio y al final
  */
-void submenuRecorridos(ArbolGenealogico &arbol) {
-    int opcion;
-    do {
-        limpiarPantalla();
-        cout << "\n+----------------------------------------+\n";
-        cout << "?     SUBMENU: RECORRIDOS DEL ARBOL      ?\n";
-        cout << "+----------------------------------------+\n";
-        cout << "  1. Recorrido PREORDEN\n";
-        cout << "  2. Recorrido INORDEN (Orden alfabetico)\n";
-        cout << "  3. Recorrido POSTORDEN\n";
-        cout << "  4. Recorrido POR NIVELES\n";
-        cout << "  0. Volver al menu principal\n";
-        cout << "-----------------------------------------\n";
-        
-        opcion = leerEntero("Seleccione una opcion: ");
-        
-        switch(opcion) {
-            case 1:
-                arbol.mostrarPreorden();
-                pausar();
-                break;
-            case 2:
-                arbol.mostrarInorden();
-                pausar();
-                break;
-            case 3:
-                arbol.mostrarPostorden();
-                pausar();
-                break;
-            case 4:
-                arbol.mostrarPorNiveles();
-                pausar();
-                break;
-            case 0:
-                cout << "Volviendo al menu principal...\n";
+void recortarEspacios(const char* &inicio, const char* &fin) {
+    while (inicio < fin && (*inicio == ' ' || *inicio == '\t')) inicio++;
+    while (fin > inicio && (fin[-1] == ' ' || fin[-1] == '\t')) fin--;
+}
+
+/**
+ * Separa una linea CSV en campos (RFC 4180 sin saltos dentro de
+ * comillas: un campo entre comillas admite ',' y "" para una comilla)
+ * @return false si una comilla no se cierra
+ */
+bool separarCSV(const char* p, const char* fin, vector<string> &campos) {
+    size_t cantidad = 0;
+    while (true) {
+        const char* inicio = p;
+        while (p < fin && (*p == ' ' || *p == '\t')) p++;
+        if (cantidad == campos.size()) campos.push_back(string());
+        string &campo = campos[cantidad++]; // Reutiliza la memoria de la fila anterior
+        campo.clear();
+        if (p < fin && *p == '"') {
+            p++;
+            while (true) {
+                if (p >= fin) return false;
+                if (*p == '"') {
+                    if (p + 1 < fin && p[1] == '"') {
+                        campo += '"';
+                        p += 2;
+                        continue;
+                    }
+                    p++;
+                    break;
+                }
+                campo += *p++;
+            }
+            while (p < fin && *p != ',') p++; // Lo que siga a la comilla se ignora
+        } else {
+            p = inicio;
+            while (p < fin && *p != ',') p++;
+            const char* a = inicio;
+            const char* b = p;
+            recortarEspacios(a, b);
+            campo.assign(a, b - a);
+        }
+        if (p >= fin) {
+            campos.resize(cantidad);
+            return true;
+        }
+        p++; // ','
+    }
+}
+
+/**
+ * Lee un string JSON (p apunta a la comilla inicial)
+ * Acepta los escapes simples y \uXXXX (se guarda en UTF-8)
+ * @return false si el string esta mal formado
+ */
+bool leerTextoJSON(const char* &p, const char* fin, string &salida) {
+    salida.clear();
+    if (p >= fin || *p != '"') return false;
+    p++;
+    while (p < fin && *p != '"') {
+        char c = *p++;
+        if (c != '\\') {
+            salida += c;
+            continue;
+        }
+        if (p >= fin) return false;
+        char e = *p++;
+        switch (e) {
+            case '"': case '\\': case '/': salida += e; break;
+            case 'b': salida += '\b'; break;
+            case 'f': salida += '\f'; break;
+            case 'n': salida += '\n'; break;
+            case 'r': salida += '\r'; break;
+            case 't': salida += '\t'; break;
+            case 'u': {
+                if (fin - p < 4) return false;
+                unsigned int cp = 0;
+                for (int i = 0; i < 4; i++) {
+                    char h = *p++;
+                    cp <<= 4;
+                    if (h >= '0' && h <= '9') cp |= h - '0';
+                    else if (h >= 'a' && h <= 'f') cp |= h - 'a' + 10;
+                    else if (h >= 'A' && h <= 'F') cp |= h - 'A' + 10;
+                    else return false;
+                }
+                if (cp < 0x80) {
+                    salida += (char)cp;
+                } else if (cp < 0x800) {
+                    salida += (char)(0xC0 | (cp >> 6));
+                    salida += (char)(0x80 | (cp & 0x3F));
+                } else {
+                    salida += (char)(0xE0 | (cp >> 12));
+                    salida += (char)(0x80 | ((cp >> 6) & 0x3F));
+                    salida += (char)(0x80 | (cp & 0x3F));
+                }
                 break;
-            default:
-                cout << "ERROR: Opcion no valida.\n";
-                pausar();
+            }
+            default: return false;
+        }
+    }
+    if (p >= fin) return false;
+    p++;
+    return true;
+}
+
+/**
+ * Lee un objeto JSON plano de una linea con los campos del miembro
+ * (nombre, edad, genero, relacion, ocupacion, lugar); los demas se ignoran
+ * @param campos Recibe los 6 campos en ese orden ("edad" como texto)
+ * @param error Recibe la causa si falla
+ */
+bool separarJSON(const char* p, const char* fin, vector<string> &campos, string &error) {
+    static const char* const NOMBRES[6] = {
+        "nombre", "edad", "genero", "relacion", "ocupacion", "lugar"
+    };
+    campos.assign(6, string());
+    bool presente[6] = { false, false, false, false, false, false };
+    string clave, valor;
+
+    while (p < fin && (*p == ' ' || *p == '\t')) p++;
+    if (p >= fin || *p++ != '{') { error = "se esperaba un objeto JSON"; return false; }
+    while (true) {
+        while (p < fin && (*p == ' ' || *p == '\t')) p++;
+        if (p < fin && *p == '}') break;
+        if (!leerTextoJSON(p, fin, clave)) { error = "clave JSON invalida"; return false; }
+        while (p < fin && (*p == ' ' || *p == '\t')) p++;
+        if (p >= fin || *p++ != ':') { error = "falta ':' en el objeto JSON"; return false; }
+        while (p < fin && (*p == ' ' || *p == '\t')) p++;
+        if (p < fin && *p == '"') {
+            if (!leerTextoJSON(p, fin, valor)) { error = "texto JSON invalido"; return false; }
+        } else {
+            const char* inicio = p;
+            while (p < fin && *p != ',' && *p != '}' && *p != ' ' && *p != '\t') p++;
+            valor.assign(inicio, p - inicio);
+        }
+        for (int i = 0; i < 6; i++) {
+            if (clave == NOMBRES[i]) {
+                campos[i] = valor;
+                presente[i] = true;
+            }
+        }
+        while (p < fin && (*p == ' ' || *p == '\t')) p++;
+        if (p < fin && *p == ',') { p++; continue; }
+        if (p < fin && *p == '}') break;
+        error = "objeto JSON incompleto";
+        return false;
+    }
+    for (int i = 0; i < 6; i++) {
+        if (!presente[i]) {
+            error = string("falta el campo \"") + NOMBRES[i] + "\"";
+            return false;
         }
-    } while (opcion != 0);
+    }
+    return true;
 }
 
 /**
- * Muestra el submenu de estadisticas
- * @param arbol Referencia al arbol genealogico
+ * Aplica las reglas de validacion del sistema a una fila ya separada
+ * @param campos nombre, edad, genero, relacion, ocupacion, lugar
+ *               (si la fila es valida sus textos pasan a d)
+ * @param d Recibe el registro si es valido
+ * @return Causa del rechazo, o NULL si la fila es valida
  */
-void submenuEstadisticas(ArbolGenealogico &arbol) {
-    int opcion;
-    do {
-        limpiarPantalla();
-        cout << "\n+----------------------------------------+\n";
-        cout << "?      SUBMENU: ESTADISTICAS             ?\n";
-        cout << "+----------------------------------------+\n";
-        cout << "  1. Estadisticas avanzadas\n";
-        cout << "  2. Conteo por relacion familiar\n";
-        cout << "  3. Historial de operaciones\n";
-        cout << "  0. Volver al menu principal\n";
-        cout << "-----------------------------------------\n";
-        
-        opcion = leerEntero("Seleccione una opcion: ");
-        
-        switch(opcion) {
-            case 1:
-                arbol.mostrarEstadisticasAvanzadas();
-                pausar();
-                break;
-            case 2:
-                arbol.mostrarConteoRelaciones();
-                pausar();
-                break;
-            case 3:
-                arbol.mostrarHistorial();
-                pausar();
-                break;
-            case 0:
-                cout << "Volviendo al menu principal...\n";
-                break;
-            default:
-                cout << "ERROR: Opcion no valida.\n";
-                pausar();
-        }
-    } while (opcion != 0);
+const char* validarFilaImportada(vector<string> &campos, DatosMiembro &d) {
+    if (campos.size() != 6) return "se esperaban 6 campos";
+    if (!esTextoValido(campos[0])) return "nombre vacio";
+    CampoLote edad = { campos[1].data(), campos[1].size() };
+    if (!campoEntero(edad, d.edad) || !esEdadValida(d.edad)) return "edad invalida";
+    if (!esGeneroValido(campos[2])) return "genero invalido";
+    if (!esTextoValido(campos[3])) return "relacion vacia";
+    if (!esTextoValido(campos[4])) return "ocupacion vacia";
+    if (!esTextoValido(campos[5])) return "lugar vacio";
+    d.nombre.swap(campos[0]);
+    d.genero.swap(campos[2]);
+    d.relacionFamiliar.swap(campos[3]);
+    d.ocupacion.swap(campos[4]);
+    d.lugarNacimiento.swap(campos[5]);
+    return NULL;
 }
 
+/* ---------------------------
+   CLASE: TareaLecturaImportacion
+   Separa, valida y ordena las filas de un trozo del archivo. Los
+   numeros de linea son locales al trozo hasta que se conoce cuantas
+   lineas tienen los trozos anteriores (el orden relativo dentro del
+   trozo no cambia al corregirlos).
+   --------------------------- */
+class TareaLecturaImportacion : public TareaParalela {
+public:
+    const char* inicio;
+    const char* fin;
+    bool json;
+    bool saltarCabecera;                // Solo el primer trozo
+    long long lineas;
+    vector<RegistroImportado> registros;
+    vector<ClaveImportada> ordenados;
+    vector<RechazoImportacion> rechazos;
+
+    TareaLecturaImportacion(const char* _inicio, const char* _fin, bool _json, bool _cabecera)
+        : inicio(_inicio), fin(_fin), json(_json), saltarCabecera(_cabecera), lineas(0) {}
+
+    void ejecutar() {
+        vector<string> campos;
+        string error;
+        // Sin reserva, cada crecimiento del vector copiaria todos los textos
+        size_t saltos = 1;
+        for (const char* q = inicio; (q = static_cast<const char*>(memchr(q, '\n', fin - q))) != NULL; q++)
+            saltos++;
+        registros.reserve(saltos);
+
+        const char* p = inicio;
+        while (p < fin) {
+            const char* salto = static_cast<const char*>(memchr(p, '\n', fin - p));
+            const char* finLinea = salto != NULL ? salto : fin;
+            const char* a = p;
+            const char* b = finLinea;
+            p = salto != NULL ? salto + 1 : fin;
+            lineas++;
+            if (b > a && b[-1] == '\r') b--;
+            recortarEspacios(a, b);
+            if (a == b) continue;
+            if (saltarCabecera) { // Primera linea con texto del archivo
+                saltarCabecera = false;
+                continue;
+            }
+
+            // El registro se llena en su lugar para no copiar los textos
+            registros.push_back(RegistroImportado());
+            RegistroImportado &r = registros.back();
+            r.linea = lineas;
+            const char* motivo = NULL;
+            if (json) {
+                if (!separarJSON(a, b, campos, error)) motivo = error.c_str();
+            } else if (!separarCSV(a, b, campos)) {
+                motivo = "comilla sin cerrar";
+            }
+            if (motivo == NULL) motivo = validarFilaImportada(campos, r.datos);
+            if (motivo != NULL) {
+                rechazos.push_back(RechazoImportacion(lineas, motivo));
+                registros.pop_back();
+            }
+        }
+        ordenados.resize(registros.size());
+        for (size_t i = 0; i < registros.size(); i++) {
+            ordenados[i].alto = prefijoClave(registros[i].datos.nombre);
+            ordenados[i].bajo = prefijoClave(registros[i].datos.nombre, 8);
+            ordenados[i].registro = &registros[i];
+        }
+        sort(ordenados.begin(), ordenados.end(), claveAntes);
+    }
+};
+
+/* ---------------------------
+   CLASE: TareaMezclaImportacion
+   Mezcla dos listas ordenadas (con los numeros de linea ya globales)
+   --------------------------- */
+class TareaMezclaImportacion : public TareaParalela {
+public:
+    const vector<ClaveImportada>* izquierda;
+    const vector<ClaveImportada>* derecha;
+    vector<ClaveImportada> salida;
+
+    TareaMezclaImportacion(const vector<ClaveImportada>* _izquierda,
+                           const vector<ClaveImportada>* _derecha)
+        : izquierda(_izquierda), derecha(_derecha) {}
+
+    void ejecutar() {
+        salida.resize(izquierda->size() + derecha->size());
+        merge(izquierda->begin(), izquierda->end(), derecha->begin(), derecha->end(),
+              salida.begin(), claveAntes);
+    }
+};
+
 /**
- * Funcion para insertar un nuevo miembro con validaciones
- * @param arbol Referencia al arbol genealogico
+ * Importa un archivo CSV o JSONL y reemplaza el contenido del arbol
+ * 1. El archivo se proyecta en memoria y se parte en trozos que
+ *    terminan en un salto de linea (uno por hilo).
+ * 2. Cada hilo separa, valida y ordena sus filas.
+ * 3. Las listas ordenadas se mezclan de a pares en paralelo.
+ * 4. Los repetidos se descartan (queda la primera aparicion) y el arbol
+ *    se construye una sola vez con construirDesdeRegistros, O(n).
+ * CSV: nombre,edad,genero,relacion,ocupacion,lugar (la primera linea se
+ * salta si es la cabecera "nombre,..."). JSONL: un objeto por linea con
+ * esas claves. El formato se decide por la extension .jsonl/.json o
+ * porque la primera linea empieza con '{'.
+ * @param arbol Arbol a reemplazar
+ * @param ruta Archivo de entrada
+ * @param hilos Hilos a usar (0 = uno por procesador)
+ * @return Resumen con los rechazos ordenados por linea
  */
-void insertarNuevoMiembro(ArbolGenealogico &arbol) {
-    limpiarPantalla();
-    cout << "\n+----------------------------------------+\n";
-    cout << "?      INSERTAR NUEVO MIEMBRO            ?\n";
-    cout << "+----------------------------------------+\n\n";
-    
-    string nombre = leerTexto("Nombre completo: ");
-    
-    // Verificar si ya existe
-    if (arbol.buscarMiembro(nombre) != NULL) {
-        cout << "\nERROR: Ya existe un miembro con ese nombre.\n";
-        pausar();
-        return;
+ResultadoImportacion importarArchivo(ArbolGenealogico &arbol, const string &ruta, int hilos = 0) {
+    ResultadoImportacion resultado;
+    double t0 = milisegundosActuales();
+    ArchivoMapeado archivo;
+    if (!archivo.abrir(ruta)) return resultado;
+    resultado.abierto = true;
+    const char* datos = archivo.contenido();
+    size_t bytes = archivo.tamano();
+
+    size_t primero = 0;
+    while (primero < bytes && (datos[primero] == ' ' || datos[primero] == '\t' ||
+                               datos[primero] == '\r' || datos[primero] == '\n'))
+        primero++;
+    bool json = (primero < bytes && datos[primero] == '{') ||
+                (ruta.size() >= 6 && ruta.compare(ruta.size() - 6, 6, ".jsonl") == 0) ||
+                (ruta.size() >= 5 && ruta.compare(ruta.size() - 5, 5, ".json") == 0);
+    bool cabecera = !json && bytes - primero >= 6 && memcmp(datos + primero, "nombre", 6) == 0;
+
+    // Trozos de al menos 1 MB cortados despues de un salto de linea
+    if (hilos <= 0) hilos = hilosDisponibles();
+    size_t porTrozo = bytes / hilos + 1;
+    if (porTrozo < (1 << 20)) porTrozo = 1 << 20;
+    vector<TareaLecturaImportacion*> lecturas;
+    size_t inicio = 0;
+    while (inicio < bytes || lecturas.empty()) {
+        size_t fin = inicio + porTrozo < bytes ? inicio + porTrozo : bytes;
+        while (fin < bytes && datos[fin - 1] != '\n') fin++;
+        lecturas.push_back(new TareaLecturaImportacion(datos + inicio, datos + fin, json,
+                                                       lecturas.empty() && cabecera));
+        inicio = fin;
     }
-    
-    int edad = leerEdad("Edad: ");
-    string genero = leerGenero("Genero");
-    string relacion = leerTexto("Relacion familiar: ");
-    string ocupacion = leerTexto("Ocupacion: ");
-    string lugar = leerTexto("Lugar de nacimiento: ");
-    
-    bool ok = arbol.insertarMiembroAVL(nombre, edad, genero, relacion, ocupacion, lugar);
-    if (ok) {
-        cout << "\n? Miembro insertado exitosamente con balanceo AVL.\n";
-    } else {
-        cout << "\nERROR: No se pudo insertar el miembro.\n";
+    resultado.hilos = (int)lecturas.size();
+    ejecutarEnParalelo(vector<TareaParalela*>(lecturas.begin(), lecturas.end()));
+
+    // Numeros de linea globales
+    long long antes = 0;
+    vector<const vector<ClaveImportada>*> listas;
+    for (size_t i = 0; i < lecturas.size(); i++) {
+        TareaLecturaImportacion* t = lecturas[i];
+        for (size_t k = 0; k < t->registros.size(); k++) t->registros[k].linea += antes;
+        for (size_t k = 0; k < t->rechazos.size(); k++) {
+            t->rechazos[k].linea += antes;
+            resultado.rechazos.push_back(t->rechazos[k]);
+        }
+        antes += t->lineas;
+        listas.push_back(&t->ordenados);
     }
-    pausar();
+    resultado.lineas = antes;
+    double t1 = milisegundosActuales();
+
+    // Mezclas de a pares hasta que quede una sola lista
+    vector<TareaMezclaImportacion*> ronda, anterior;
+    while (listas.size() > 1) {
+        ronda.clear();
+        vector<const vector<ClaveImportada>*> siguientes;
+        for (size_t i = 0; i + 1 < listas.size(); i += 2)
+            ronda.push_back(new TareaMezclaImportacion(listas[i], listas[i + 1]));
+        ejecutarEnParalelo(vector<TareaParalela*>(ronda.begin(), ronda.end()));
+        for (size_t i = 0; i < ronda.size(); i++) siguientes.push_back(&ronda[i]->salida);
+        if (listas.size() % 2 == 1) siguientes.push_back(listas.back());
+        for (size_t i = 0; i < anterior.size(); i++) delete anterior[i];
+        anterior = ronda;
+        listas = siguientes;
+    }
+
+    // Repetidos: a igual nombre la primera aparicion va antes
+    vector<DatosMiembro*> ordenados;
+    if (!listas.empty()) {
+        const vector<ClaveImportada> &todos = *listas[0];
+        ordenados.reserve(todos.size());
+        const RegistroImportado* ultimo = NULL;
+        for (size_t i = 0; i < todos.size(); i++) {
+            RegistroImportado* r = todos[i].registro;
+            if (ultimo != NULL && ultimo->datos.nombre == r->datos.nombre) {
+                char texto[64];
+                sprintf(texto, "nombre repetido (primera aparicion en la linea %lld)", ultimo->linea);
+                resultado.rechazos.push_back(RechazoImportacion(r->linea, texto));
+                continue;
+            }
+            ordenados.push_back(&r->datos);
+            ultimo = r;
+        }
+    }
+    sort(resultado.rechazos.begin(), resultado.rechazos.end(), rechazoAntes);
+    double t2 = milisegundosActuales();
+
+    resultado.cargados = arbol.construirDesdeRegistros(ordenados); // Mueve los nombres
+    double t3 = milisegundosActuales();
+
+    for (size_t i = 0; i < anterior.size(); i++) delete anterior[i];
+    for (size_t i = 0; i < lecturas.size(); i++) delete lecturas[i];
+    resultado.msLectura = t1 - t0;
+    resultado.msOrden = t2 - t1;
+    resultado.msConstruccion = t3 - t2;
+    return resultado;
 }
 
 /**
- * Funcion para buscar un miembro
- * @param arbol Referencia al arbol genealogico
+ * Escribe el reporte de rechazos: una linea "linea|motivo" por fila
+ * @return false si no se pudo escribir
  */
-void buscarMiembroPorNombre(ArbolGenealogico &arbol) {
-    limpiarPantalla();
-    cout << "\n+----------------------------------------+\n";
-    cout << "?       BUSCAR MIEMBRO POR NOMBRE        ?\n";
-    cout << "+----------------------------------------+\n\n";
-    
-    string nombre = leerTexto("Nombre a buscar: ");
-    Miembro* m = arbol.buscarMiembro(nombre);
-    
-    if (m) {
-        arbol.imprimirMiembroCompleto(m);
-    } else {
-        cout << "\nMiembro no encontrado en el arbol.\n";
+bool escribirRechazos(const ResultadoImportacion &resultado, const string &ruta) {
+    FILE* archivo = fopen(ruta.c_str(), "wb");
+    if (archivo == NULL) return false;
+    for (size_t i = 0; i < resultado.rechazos.size(); i++)
+        fprintf(archivo, "%lld|%s\n", resultado.rechazos[i].linea, resultado.rechazos[i].motivo.c_str());
+    return fclose(archivo) == 0;
+}
+
+/**
+ * Funcion objeto para recorrerTramo: escribe cada miembro como una
+ * fila numerada de la salida por lotes
+ */
+struct VisitaLote {
+    BufferSalida &salida;
+    const ArbolGenealogico &arbol;
+    long long numero;
+    VisitaLote(BufferSalida &_salida, const ArbolGenealogico &_arbol)
+        : salida(_salida), arbol(_arbol), numero(0) {}
+    void operator()(Miembro* m) {
+        escribirMiembroLote(salida.entero(++numero).caracter('|'), arbol, m);
+        salida.finLinea();
     }
-    pausar();
+};
+
+/**
+ * Campo de atributo nombrado en un comando por lotes
+ * @return CAMPO_GENERO ... CAMPO_LUGAR, o -1 si no es un atributo
+ */
+int campoLote(const CampoLote &campo) {
+    if (campo.es("genero")) return CAMPO_GENERO;
+    if (campo.es("relacion")) return CAMPO_RELACION;
+    if (campo.es("ocupacion")) return CAMPO_OCUPACION;
+    if (campo.es("lugar")) return CAMPO_LUGAR;
+    return -1;
 }
 
+/* ---------------------------
+   CLASE: TareaConcurrencia
+   Un hilo de la medicion concurrente: 95% busquedas de nombres
+   existentes y 5% escrituras (inserta un nombre propio y en la
+   siguiente escritura lo elimina, asi el tamano no deriva)
+   --------------------------- */
+class TareaConcurrencia : public TareaParalela {
+public:
+    ArbolConcurrente* arbol;
+    const vector<string>* nombres;
+    long long operaciones;
+    int hilo;
+    long long lecturas, escrituras, encontrados;
+
+    TareaConcurrencia(ArbolConcurrente* _arbol, const vector<string>* _nombres,
+                      long long _operaciones, int _hilo)
+        : arbol(_arbol), nombres(_nombres), operaciones(_operaciones), hilo(_hilo),
+          lecturas(0), escrituras(0), encontrados(0) {}
+
+    void ejecutar() {
+        unsigned int x = 2463534242u + 7919u * (unsigned int)hilo;
+        DatosMiembro datos;
+        DatosMiembro propio("", 30, "Masculino", "Primo", "Chasqui", "Cusco");
+        char texto[48];
+        bool pendiente = false;
+        long long propios = 0;
+        for (long long i = 0; i < operaciones; i++) {
+            x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+            if (x % 100 < 95) {
+                if (arbol->buscar((*nombres)[(x >> 7) % nombres->size()], datos)) encontrados++;
+                lecturas++;
+            } else {
+                if (pendiente) {
+                    arbol->eliminar(propio.nombre);
+                } else {
+                    sprintf(texto, "~concurrencia %d-%lld", hilo, propios++);
+                    propio.nombre = texto;
+                    arbol->insertar(propio);
+                }
+                pendiente = !pendiente;
+                escrituras++;
+            }
+        }
+        if (pendiente) arbol->eliminar(propio.nombre);
+    }
+};
+
 /**
- * Funcion para modificar un miembro existente
- * @param arbol Referencia al arbol genealogico
+ * Mide busquedas concurrentes con una mezcla 95/5 de lecturas y
+ * escrituras, repitiendo con 1, 2, 4, ... hasta maxHilos hilos.
+ * Escribe una linea por medicion:
+ *   CONCURRENCIA|hilos|operaciones|ms|ops/s|busquedas/s|busquedas con cerrojo
+ * (las que no se pudieron confirmar sin cerrojo por las escrituras)
+ * @param operaciones Operaciones por hilo
+ * @return false si el arbol esta vacio
  */
-void modificarMiembroExistente(ArbolGenealogico &arbol) {
-    limpiarPantalla();
-    cout << "\n+----------------------------------------+\n";
-    cout << "?        MODIFICAR MIEMBRO               ?\n";
-    cout << "+----------------------------------------+\n\n";
-    
-    string nombre = leerTexto("Nombre del miembro a modificar: ");
-    Miembro* m = arbol.buscarMiembro(nombre);
-    
-    if (!m) {
-        cout << "\nERROR: Miembro no encontrado.\n";
-        pausar();
-        return;
+bool medirConcurrencia(ArbolGenealogico &arbol, int maxHilos, long long operaciones,
+                       BufferSalida &salida)
+{
+    vector<Miembro*> todos = arbol.paginaInorden(0, arbol.totalMiembros());
+    if (todos.empty()) return false;
+    vector<string> nombres;
+    nombres.reserve(todos.size());
+    for (size_t i = 0; i < todos.size(); i++) nombres.push_back(todos[i]->nombre);
+    vector<Miembro*>().swap(todos);
+
+    ArbolConcurrente concurrente(arbol);
+    for (int hilos = 1; ; hilos = hilos * 2 > maxHilos && hilos < maxHilos ? maxHilos : hilos * 2) {
+        vector<TareaConcurrencia*> tareas;
+        long conCerrojo = concurrente.busquedasConCerrojo();
+        for (int h = 0; h < hilos; h++)
+            tareas.push_back(new TareaConcurrencia(&concurrente, &nombres, operaciones, h));
+        double inicio = milisegundosActuales();
+        ejecutarEnParalelo(vector<TareaParalela*>(tareas.begin(), tareas.end()));
+        double ms = milisegundosActuales() - inicio;
+
+        long long lecturas = 0, total = 0;
+        for (int h = 0; h < hilos; h++) {
+            lecturas += tareas[h]->lecturas;
+            total += tareas[h]->lecturas + tareas[h]->escrituras;
+            delete tareas[h];
+        }
+        double segundos = ms > 0 ? ms / 1000.0 : 0.001;
+        salida.texto("CONCURRENCIA").caracter('|').entero(hilos).caracter('|').entero(total)
+              .caracter('|').decimal(ms, 1).caracter('|').entero((long long)(total / segundos))
+              .caracter('|').entero((long long)(lecturas / segundos))
+              .caracter('|').entero(concurrente.busquedasConCerrojo() - conCerrojo).finLinea();
+        salida.vaciar();
+        if (hilos >= maxHilos) break;
     }
-    
-    cout << "\n--- Datos actuales ---\n";
-    arbol.imprimirMiembroCompleto(m);
-    
-    cout << "\n--- Ingrese los nuevos datos ---\n";
-    int nuevaEdad = leerEdad("Nueva edad: ");
-    string nuevaOcupacion = leerTexto("Nueva ocupacion: ");
-    string nuevaRelacion = leerTexto("Nueva relacion familiar: ");
-    
-    bool ok = arbol.modificarMiembro(nombre, nuevaEdad, nuevaOcupacion, nuevaRelacion);
-    if (ok) {
-        cout << "\n? Miembro modificado correctamente.\n";
-    } else {
-        cout << "\nERROR: No se pudo modificar el miembro.\n";
+    return true;
+}
+
+/**
+ * Calcula el parentesco de los pares de un archivo (una linea nombre|nombre
+ * por par) y escribe una linea por par en el mismo orden:
+ *   A|B|etiqueta|grado|removido|generaciones de diferencia|ancestro comun
+ * y al final PARENTESCOS|pares|no encontrados|lineas invalidas|hilos|ms|pares/s.
+ * El archivo se procesa por bloques de al menos tantos pares como
+ * miembros tiene el arbol, asi el recorrido inorden que resuelve los
+ * nombres de cada bloque cuesta a lo sumo O(1) por par y la memoria no
+ * depende del tamano del archivo
+ * @param hilos Hilos a usar (0 = todos los procesadores)
+ * @return false si no se pudo abrir el archivo
+ */
+bool procesarParentescos(ArbolGenealogico &arbol, const string &ruta, int hilos,
+                         BufferSalida &salida) {
+    LectorLineas entrada;
+    if (!entrada.abrir(ruta)) return false;
+    if (hilos <= 0) hilos = hilosDisponibles();
+    size_t porBloque = max((size_t)65536, (size_t)arbol.totalMiembros());
+
+    CampoLote c[MAX_CAMPOS_LOTE];
+    vector< pair<string, string> > bloque;
+    vector<Parentesco> resultados;
+    const char* linea;
+    size_t largo, usados = 0;
+    long long pares = 0, desconocidos = 0, invalidas = 0;
+    double inicio = milisegundosActuales();
+    bool quedan = true;
+    while (quedan) {
+        quedan = entrada.siguiente(linea, largo);
+        if (quedan) {
+            int n = separarCampos(linea, largo, c);
+            if (c[0].largo == 0 || c[0].inicio[0] == '#') continue;
+            if (n != 2 || c[1].largo == 0) {
+                invalidas++;
+                continue;
+            }
+            if (usados == bloque.size()) bloque.resize(usados + 1);
+            bloque[usados].first.assign(c[0].inicio, c[0].largo);   // Conserva la capacidad
+            bloque[usados].second.assign(c[1].inicio, c[1].largo);
+            usados++;
+            if (usados < porBloque) continue;
+        }
+        if (usados == 0) continue;
+
+        bloque.resize(usados);
+        arbol.resolverParentescos(bloque, resultados, hilos);
+        for (size_t i = 0; i < usados; i++) {
+            const Parentesco &p = resultados[i];
+            salida.texto(bloque[i].first).caracter('|').texto(bloque[i].second).caracter('|')
+                  .texto(ETIQUETAS_PARENTESCO[p.tipo]).caracter('|').entero(p.grado())
+                  .caracter('|').entero(p.removido()).caracter('|')
+                  .entero(p.diferenciaGeneraciones()).caracter('|');
+            if (p.comun != NULL) salida.texto(p.comun->nombre);
+            salida.finLinea();
+            if (p.tipo == PARENTESCO_DESCONOCIDO) desconocidos++;
+        }
+        pares += usados;
+        usados = 0;
     }
-    pausar();
+
+    double ms = milisegundosActuales() - inicio;
+    salida.texto("PARENTESCOS").caracter('|').entero(pares).caracter('|').entero(desconocidos)
+          .caracter('|').entero(invalidas).caracter('|').entero(hilos).caracter('|').decimal(ms, 1)
+          .caracter('|').entero((long long)(ms > 0 ? pares * 1000.0 / ms : 0.0)).finLinea();
+    return true;
 }
 
 /**
- * Funcion para eliminar un miembro
- * @param arbol Referencia al arbol genealogico
+ * Ejecuta los comandos de un archivo sin menus, pausas ni limpiezas de
+ * pantalla. Una linea por comando, campos separados por '|':
+ *   insertar|nombre|edad|genero|relacion|ocupacion|lugar
+ *   buscar|nombre
+ *   modificar|nombre|edad|ocupacion|relacion
+ *   eliminar|nombre
+ *   estadisticas
+ *   recorrer|preorden / inorden / postorden / niveles
+ *   importar|archivo[|reporte de rechazos]  (ver importarArchivo)
+ *   concurrencia|hilos|operaciones por hilo  (ver medirConcurrencia)
+ *   prefijo|comienzo del nombre[|limite]
+ *   rango|desde|hasta[|limite]
+ *   edades|desde|hasta[|limite]
+ *   longevos|cantidad
+ *   mediana
+ *   filtrar|genero/relacion/ocupacion/lugar|valor|recorrido
+ *   resumir|genero/relacion/ocupacion/lugar|valor
+ *   progenitor|hijo|progenitor  (progenitor vacio: quitarlo)
+ *   ancestro|posible ancestro|miembro
+ *   parentesco|miembro|miembro
+ *   parentescos|archivo de pares[|hilos]  (ver procesarParentescos)
+ * Las lineas vacias y las que empiezan con '#' se ignoran. Cada
+ * comando responde una linea (recorrer: una cabecera y un miembro por
+ * linea) en la salida estandar; al final se informa en stderr cuantas
+ * operaciones por segundo se hicieron.
+ * @param arbol Arbol sobre el que se ejecuta
+ * @param ruta Archivo de comandos ("-" = entrada estandar)
+ * @return 0 si todo se ejecuto, 1 si no se pudo abrir, 2 si hubo errores
  */
-void eliminarMiembroDelArbol(ArbolGenealogico &arbol) {
-    limpiarPantalla();
-    cout << "\n+----------------------------------------+\n";
-    cout << "?         ELIMINAR MIEMBRO               ?\n";
-    cout << "+----------------------------------------+\n\n";
-    
-    string nombre = leerTexto("Nombre del miembro a ELIMINAR: ");
-    Miembro* m = arbol.buscarMiembro(nombre);
-    
-    if (!m) {
-        cout << "\nERROR: Miembro no encontrado.\n";
-        pausar();
-        return;
+int ejecutarLote(ArbolGenealogico &arbol, const string &ruta) {
+    LectorLineas entrada;
+    if (!entrada.abrir(ruta)) {
+        fprintf(stderr, "ERROR: no se pudo abrir %s\n", ruta.c_str());
+        return 1;
     }
-    
-    arbol.imprimirMiembroCompleto(m);
-    cout << "\n?Esta seguro de eliminar este miembro? (S/N): ";
-    string confirmacion;
-    getline(cin, confirmacion);
-    
-    if (confirmacion == "S" || confirmacion == "s") {
-        bool ok = arbol.eliminarMiembro(nombre);
-        if (ok) {
-            cout << "\n? Miembro eliminado y arbol rebalanceado (AVL).\n";
+    BufferSalida salida(stdout);
+    CampoLote c[MAX_CAMPOS_LOTE];
+    DatosMiembro registro;
+    string motivo;                   // Texto de los errores que se arman al ejecutar
+    const char* linea;
+    size_t largo;
+    long long numeroLinea = 0, comandos = 0, errores = 0;
+#ifdef MEDIR_ASIGNACIONES
+    long long asignacionesAntes = asignacionesTotales;
+#endif
+    double inicio = milisegundosActuales();
+
+    while (entrada.siguiente(linea, largo)) {
+        numeroLinea++;
+        int n = separarCampos(linea, largo, c);
+        if (c[0].largo == 0 || c[0].inicio[0] == '#') continue;
+        comandos++;
+        const char* error = NULL;
+        int edad = 0;
+
+        if (c[0].es("insertar")) {
+            if (n != 7) error = "insertar necesita 6 campos";
+            else if (!campoEntero(c[2], edad) || !esEdadValida(edad)) error = "edad invalida";
+            else if (!esGeneroValido(c[3].comoTexto())) error = "genero invalido";
+            else {
+                for (int i = 1; i < 7 && error == NULL; i++)
+                    if (c[i].largo == 0) error = "campo vacio";
+            }
+            if (error == NULL) {
+                // El registro se reutiliza entre lineas: assign conserva la
+                // capacidad de cada campo y el nombre se mueve al nodo
+                registro.nombre.assign(c[1].inicio, c[1].largo);
+                registro.edad = edad;
+                registro.genero.assign(c[3].inicio, c[3].largo);
+                registro.relacionFamiliar.assign(c[4].inicio, c[4].largo);
+                registro.ocupacion.assign(c[5].inicio, c[5].largo);
+                registro.lugarNacimiento.assign(c[6].inicio, c[6].largo);
+                bool ok = arbol.emplazarMiembro(registro);
+                salida.texto(ok ? "INSERTADO" : "EXISTE").caracter('|')
+                      .texto(c[1].inicio, c[1].largo).finLinea();
+            }
+        } else if (c[0].es("buscar")) {
+            if (n != 2 || c[1].largo == 0) error = "buscar necesita un nombre";
+            else {
+                Miembro* m = arbol.buscarMiembro(c[1].comoTexto());
+                if (m != NULL) escribirMiembroLote(salida.texto("ENCONTRADO").caracter('|'), arbol, m);
+                else salida.texto("NO_ENCONTRADO").caracter('|').texto(c[1].inicio, c[1].largo);
+                salida.finLinea();
+            }
+        } else if (c[0].es("modificar")) {
+            if (n != 5) error = "modificar necesita 4 campos";
+            else if (!campoEntero(c[2], edad) || !esEdadValida(edad)) error = "edad invalida";
+            else if (c[1].largo == 0 || c[3].largo == 0 || c[4].largo == 0) error = "campo vacio";
+            else {
+                bool ok = arbol.modificarMiembro(c[1].comoTexto(), edad,
+                                                 c[3].comoTexto(), c[4].comoTexto());
+                salida.texto(ok ? "MODIFICADO" : "NO_ENCONTRADO").caracter('|')
+                      .texto(c[1].inicio, c[1].largo).finLinea();
+            }
+        } else if (c[0].es("eliminar")) {
+            if (n != 2 || c[1].largo == 0) error = "eliminar necesita un nombre";
+            else {
+                bool ok = arbol.eliminarMiembro(c[1].comoTexto());
+                salida.texto(ok ? "ELIMINADO" : "NO_ENCONTRADO").caracter('|')
+                      .texto(c[1].inicio, c[1].largo).finLinea();
+            }
+        } else if (c[0].es("estadisticas")) {
+            ResumenEdades r = arbol.resumenEdades();
+            salida.texto("ESTADISTICAS").caracter('|').entero(r.cantidad).caracter('|')
+                  .decimal(r.promedio(), 2).caracter('|').entero(r.maxima).caracter('|')
+                  .entero(r.minima).caracter('|').entero(arbol.profundidad()).finLinea();
+        } else if (c[0].es("recorrer")) {
+            int total = arbol.totalMiembros();
+            vector<Miembro*> orden;
+            if (n != 2) error = "recorrer necesita el tipo";
+            else if (c[1].es("preorden")) orden = arbol.paginaPreorden(0, total);
+            else if (c[1].es("inorden")) orden = arbol.paginaInorden(0, total);
+            else if (c[1].es("postorden")) orden = arbol.paginaPostorden(0, total);
+            else if (c[1].es("niveles")) orden = arbol.paginaPorNiveles(0, total);
+            else error = "recorrido desconocido";
+            if (error == NULL) {
+                salida.texto("RECORRIDO").caracter('|').texto(c[1].inicio, c[1].largo)
+                      .caracter('|').entero((long long)orden.size()).finLinea();
+                for (size_t i = 0; i < orden.size(); i++) {
+                    escribirMiembroLote(salida.entero((long long)i + 1).caracter('|'), arbol, orden[i]);
+                    salida.finLinea();
+                }
+            }
+        } else if (c[0].es("importar")) {
+            if ((n != 2 && n != 3) || c[1].largo == 0) error = "importar necesita un archivo";
+            else {
+                string rutaDatos = c[1].comoTexto();
+                string rutaRechazos = n == 3 && c[2].largo > 0 ? c[2].comoTexto()
+                                                               : rutaDatos + ".rechazos";
+                ResultadoImportacion r = importarArchivo(arbol, rutaDatos);
+                if (!r.abierto) error = "no se pudo abrir el archivo a importar";
+                else if (!r.rechazos.empty() && !escribirRechazos(r, rutaRechazos))
+                    error = "no se pudo escribir el reporte de rechazos";
+                if (r.abierto) {
+                    char tiempos[96];
+                    sprintf(tiempos, "%.1f|%.1f|%.1f", r.msLectura, r.msOrden, r.msConstruccion);
+                    salida.texto("IMPORTADO").caracter('|').entero(r.cargados).caracter('|')
+                          .entero((long long)r.rechazos.size()).caracter('|').entero(r.lineas)
+                          .caracter('|').entero(r.hilos).caracter('|').texto(tiempos).finLinea();
+                }
+            }
+        } else if (c[0].es("prefijo") || c[0].es("rango")) {
+            bool porPrefijo = c[0].es("prefijo");
+            int campos = porPrefijo ? 2 : 3;
+            int limite = -1;
+            if (n != campos && n != campos + 1)
+                error = porPrefijo ? "prefijo necesita el comienzo del nombre"
+                                   : "rango necesita desde y hasta";
+            else if (n == campos + 1 && (!campoEntero(c[campos], limite) || limite < 0))
+                error = "limite invalido";
+            else {
+                int inicio = 0;
+                int cantidad = porPrefijo ? arbol.tramoPrefijo(c[1].comoTexto(), inicio)
+                                          : arbol.tramoRango(c[1].comoTexto(), c[2].comoTexto(), inicio);
+                int mostrados = limite >= 0 && limite < cantidad ? limite : cantidad;
+                salida.texto(porPrefijo ? "PREFIJO" : "RANGO").caracter('|').entero(cantidad)
+                      .caracter('|').entero(mostrados).finLinea();
+                VisitaLote visita(salida, arbol);
+                arbol.recorrerTramo(2, inicio, mostrados, visita);
+            }
+        } else if (c[0].es("edades")) {
+            int desde = 0, hasta = 0, limite = -1;
+            if ((n != 3 && n != 4) || !campoEntero(c[1], desde) || !campoEntero(c[2], hasta))
+                error = "edades necesita desde y hasta";
+            else if (n == 4 && (!campoEntero(c[3], limite) || limite < 0)) error = "limite invalido";
+            else {
+                int inicio = 0;
+                int cantidad = arbol.tramoEdades(desde, hasta, inicio);
+                int mostrados = limite >= 0 && limite < cantidad ? limite : cantidad;
+                salida.texto("EDADES").caracter('|').entero(cantidad).caracter('|')
+                      .entero(mostrados).finLinea();
+                VisitaLote visita(salida, arbol);
+                arbol.recorrerTramoEdad(inicio, mostrados, visita);
+            }
+        } else if (c[0].es("longevos")) {
+            int k = 0;
+            if (n != 2 || !campoEntero(c[1], k) || k < 0) error = "longevos necesita una cantidad";
+            else {
+                vector<Miembro*> longevos = arbol.masLongevos(k);
+                salida.texto("LONGEVOS").caracter('|').entero((long long)longevos.size()).finLinea();
+                VisitaLote visita(salida, arbol);
+                for (size_t i = 0; i < longevos.size(); i++) visita(longevos[i]);
+            }
+        } else if (c[0].es("mediana")) {
+            salida.texto("MEDIANA").caracter('|').decimal(arbol.medianaEdad(), 1).finLinea();
+        } else if (c[0].es("filtrar")) {
+            int tipo = 0;
+            if (n == 4 && c[3].es("preorden")) tipo = 1;
+            else if (n == 4 && c[3].es("inorden")) tipo = 2;
+            else if (n == 4 && c[3].es("postorden")) tipo = 3;
+            else if (n == 4 && c[3].es("niveles")) tipo = 4;
+            if (n != 4 || c[2].largo == 0) error = "filtrar necesita campo, valor y recorrido";
+            else if (campoLote(c[1]) < 0) error = "campo desconocido";
+            else if (tipo == 0) error = "recorrido desconocido";
+            else {
+                int campo = campoLote(c[1]);
+                FiltroAtributo filtro(campo, arbol.idAtributo(campo, c[2].comoTexto()));
+                vector<Miembro*> orden = filtrarEnParalelo(arbol, filtro, tipo);
+                salida.texto("FILTRADO").caracter('|').texto(c[3].inicio, c[3].largo)
+                      .caracter('|').entero((long long)orden.size()).finLinea();
+                for (size_t i = 0; i < orden.size(); i++) {
+                    escribirMiembroLote(salida.entero((long long)i + 1).caracter('|'), arbol, orden[i]);
+                    salida.finLinea();
+                }
+            }
+        } else if (c[0].es("resumir")) {
+            if (n != 3 || c[2].largo == 0) error = "resumir necesita campo y valor";
+            else if (campoLote(c[1]) < 0) error = "campo desconocido";
+            else {
+                int campo = campoLote(c[1]);
+                FiltroAtributo filtro(campo, arbol.idAtributo(campo, c[2].comoTexto()));
+                ReduccionEdades reduccion(&filtro);
+                reducirEnParalelo(arbol, reduccion);
+                const ResumenEdades &r = reduccion.resumen;
+                salida.texto("RESUMEN").caracter('|').entero(r.cantidad).caracter('|')
+                      .decimal(r.promedio(), 2).caracter('|').entero(r.maxima).caracter('|')
+                      .entero(r.minima).finLinea();
+            }
+        } else if (c[0].es("concurrencia")) {
+            int hilos = 0, operaciones = 0;
+            if (n != 3 || !campoEntero(c[1], hilos) || !campoEntero(c[2], operaciones) ||
+                hilos < 1 || hilos > 256 || operaciones < 1)
+                error = "concurrencia necesita hilos (1-256) y operaciones por hilo";
+            else if (!medirConcurrencia(arbol, hilos, operaciones, salida))
+                error = "arbol vacio";
+        } else if (c[0].es("progenitor")) {
+            if (n != 3 || c[1].largo == 0) error = "progenitor necesita hijo y progenitor";
+            else if (c[2].largo == 0) {
+                bool ok = arbol.quitarProgenitor(c[1].comoTexto());
+                salida.texto(ok ? "SIN_PROGENITOR" : "NO_ENCONTRADO").caracter('|')
+                      .texto(c[1].inicio, c[1].largo).finLinea();
+            } else if (arbol.asignarProgenitor(c[1].comoTexto(), c[2].comoTexto(), motivo)) {
+                salida.texto("PROGENITOR").caracter('|').texto(c[1].inicio, c[1].largo)
+                      .caracter('|').texto(c[2].inicio, c[2].largo).finLinea();
+            } else {
+                error = motivo.c_str();
+            }
+        } else if (c[0].es("parentescos")) {
+            int hilos = 0;
+            if ((n != 2 && n != 3) || c[1].largo == 0) error = "parentescos necesita un archivo";
+            else if (n == 3 && (!campoEntero(c[2], hilos) || hilos < 1)) error = "hilos invalidos";
+            else if (!procesarParentescos(arbol, c[1].comoTexto(), hilos, salida))
+                error = "no se pudo abrir el archivo de pares";
+        } else if (c[0].es("ancestro") || c[0].es("parentesco")) {
+            Miembro* a = n == 3 ? arbol.buscarMiembro(c[1].comoTexto()) : NULL;
+            Miembro* b = n == 3 ? arbol.buscarMiembro(c[2].comoTexto()) : NULL;
+            if (n != 3) error = "se necesitan dos nombres";
+            else if (a == NULL || b == NULL) {
+                const CampoLote &falta = a == NULL ? c[1] : c[2];
+                salida.texto("NO_ENCONTRADO").caracter('|').texto(falta.inicio, falta.largo).finLinea();
+            } else {
+                arbol.prepararLinaje(); // Solo trabaja si cambio algun enlace
+                bool ancestro = c[0].es("ancestro");
+                salida.texto(ancestro ? "ANCESTRO" : "PARENTESCO").caracter('|').texto(a->nombre)
+                      .caracter('|').texto(b->nombre).caracter('|');
+                if (ancestro) {
+                    salida.texto(arbol.esAncestro(a, b) ? "SI" : "NO");
+                } else {
+                    // ancestro comun | generaciones de cada uno hasta el | distancia
+                    Miembro* comun = arbol.ancestroComun(a, b);
+                    if (comun == NULL) salida.texto("|-1|-1|-1");
+                    else {
+                        int g = arbol.generacion(comun);
+                        salida.texto(comun->nombre).caracter('|').entero(arbol.generacion(a) - g)
+                              .caracter('|').entero(arbol.generacion(b) - g).caracter('|')
+                              .entero(arbol.distanciaParentesco(a, b));
+                    }
+                }
+                salida.finLinea();
+            }
         } else {
-            cout << "\nERROR: No se pudo eliminar el miembro.\n";
+            error = "comando desconocido";
+        }
+
+        if (error != NULL) {
+            errores++;
+            salida.texto("ERROR").caracter('|').entero(numeroLinea).caracter('|').texto(error).finLinea();
         }
-    } else {
-        cout << "\nEliminacion cancelada.\n";
     }
+    arbol.sincronizarDiario();
+    salida.vaciar();
+
+    double ms = milisegundosActuales() - inicio;
+    fprintf(stderr, "Lote: %lld comando(s), %lld error(es) en %.1f ms (%.0f ops/s)\n",
+            comandos, errores, ms, ms > 0 ? comandos * 1000.0 / ms : 0.0);
+#ifdef MEDIR_ASIGNACIONES
+    long long asignaciones = asignacionesTotales - asignacionesAntes;
+    fprintf(stderr, "Asignaciones: %lld (%.2f por comando)\n", asignaciones,
+            comandos > 0 ? (double)asignaciones / comandos : 0.0);
+#endif
+    return errores == 0 ? 0 : 2;
+}
+
+/**
+ * Funcion para mostrar el diagrama de una region del arbol
+ * @param arbol Referencia al arbol genealogico
+ */
+void mostrarDiagramaRegion(ArbolGenealogico &arbol) {
+    string nombre;
+    cout << "\nMiembro en la raiz de la vista (ENTER = raiz del arbol): ";
+    getline(cin, nombre);
+    if (!esTextoValido(nombre)) nombre = "";
+    int niveles = leerEntero("Niveles a mostrar (0 = automatico): ");
+    if (!arbol.mostrarDiagramaArbol(nombre, niveles))
+        cout << "\nERROR: Miembro no encontrado.\n";
     pausar();
 }
 
 /* ========== MENU PRINCIPAL ========== */
 
-int main() {
+// Con -DARBOL_SIN_MAIN el archivo se incluye desde otro programa (por
+// ejemplo BenchmarkArbolGenealogico.cpp) que trae su propio main
+#ifndef ARBOL_SIN_MAIN
+/**
+ * Sin argumentos abre el menu interactivo
+ *   --lote [archivo]  Ejecuta comandos de un archivo o de la entrada
+ *                     estandar (ver ejecutarLote)
+ *   --memoria         Con --lote: no abre la instantanea ni el diario
+ */
+int main(int argc, char* argv[]) {
     ArbolGenealogico arbol;
     int opcion = -1;
 
+    bool lote = false, memoria = false;
+    string rutaLote = "-";
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--lote") lote = true;
+        else if (arg == "--memoria") memoria = true;
+        else if (lote && (arg == "-" || arg[0] != '-')) rutaLote = arg;
+        else {
+            fprintf(stderr, "Uso: %s [--lote [archivo]] [--memoria]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (lote) {
+        if (!memoria) {
+            string error;
+            if (!arbol.abrirPersistencia(RUTA_INSTANTANEA, RUTA_DIARIO, error))
+                fprintf(stderr, "AVISO: %s. Los cambios no se guardaran.\n", error.c_str());
+            arbol.configurarDiario(512, 50.0); // Confirmacion en grupo
+        }
+        return ejecutarLote(arbol, rutaLote);
+    }
+
     limpiarPantalla();
     cout << "+-------------------------------------------------------+\n";
     cout << "?   SISTEMA DE ARBOL GENEALOGICO CON BALANCEO AVL       ?\n";
     cout << "?           Tahuantinsuyo - Imperio Inca                ?\n";
     cout << "+-------------------------------------------------------+\n\n";
-    cout << "Cargando datos de ejemplo...\n";
-    arbol.cargarDatosEjemplo();
-    cout << "? Datos cargados exitosamente.\n";
+    // Instantanea + diario si existen; si nunca se guardo nada, datos de ejemplo
+    string error;
+    bool persistente = arbol.abrirPersistencia(RUTA_INSTANTANEA, RUTA_DIARIO, error);
+    if (!persistente)
+        cout << "AVISO: " << error << ". Los cambios de esta sesion no se guardaran.\n";
+    if (arbol.totalMiembros() == 0 && arbol.ultimaSecuencia() == 0) {
+        cout << "Cargando datos de ejemplo...\n";
+        arbol.cargarDatosEjemplo();
+        cout << "? Datos cargados exitosamente.\n";
+    } else {
+        cout << "? " << arbol.totalMiembros() << " miembro(s) recuperados de "
+             << RUTA_INSTANTANEA << " y " << RUTA_DIARIO << ".\n";
+    }
     pausar();
 
     while (true) {
@@ -1279,12 +7671,15 @@ int main() {
         cout << "|         MENU PRINCIPAL                 |\n";
         cout << "+----------------------------------------+\n";
         cout << "  1. Insertar nuevo miembro\n";
-        cout << "  2. Buscar miembro por nombre\n";
+        cout << "  2. Buscar miembros [SUBMENU]\n";
         cout << "  3. Modificar miembro\n";
         cout << "  4. Eliminar miembro\n";
         cout << "  5. Recorridos del arbol [SUBMENU]\n";
         cout << "  6. Estadisticas [SUBMENU]\n";
         cout << "  7. Mostrar diagrama del arbol\n";
+        cout << "  8. Optimizar busquedas (congelar indice)\n";
+        cout << "  9. Guardar arbol en disco\n";
+        cout << " 10. Linaje familiar [SUBMENU]\n";
         cout << "  0. Salir del sistema\n";
         cout << "-----------------------------------------\n";
 
@@ -1304,7 +7699,7 @@ int main() {
                 break;
                 
             case 2:
-                buscarMiembroPorNombre(arbol);
+                submenuBusquedas(arbol);
                 break;
                 
             case 3:
@@ -1324,8 +7719,19 @@ int main() {
                 break;
                 
             case 7:
-                arbol.mostrarDiagramaArbol();
-                pausar();
+                mostrarDiagramaRegion(arbol);
+                break;
+
+            case 8:
+                optimizarBusquedas(arbol);
+                break;
+
+            case 9:
+                guardarArbolEnDisco(arbol);
+                break;
+
+            case 10:
+                submenuLinaje(arbol);
                 break;
                 
             default:
@@ -1336,3 +7742,4 @@ int main() {
 
     return 0;
 }
+#endif // ARBOL_SIN_MAIN
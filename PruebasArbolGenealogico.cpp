@@ -0,0 +1,233 @@
+/* ==============================================================
+   PRUEBAS DEL ARBOL GENEALOGICO
+
+   Casos de regresion que necesitan un arbol real (con persistencia,
+   diario, etc.). Reutiliza CodigoArbolGenealogico.cpp sin su main.
+   Cada prueba imprime [OK] o [FALLO]; el programa termina con 1 si
+   alguna fallo. Los archivos temporales se crean y se borran en el
+   directorio actual.
+
+   Compilar y correr junto a CodigoArbolGenealogico.cpp:
+     g++ -std=c++98 -O2 -pthread -o pruebas PruebasArbolGenealogico.cpp
+     ./pruebas
+   ============================================================== */
+#define ARBOL_SIN_MAIN
+#include "CodigoArbolGenealogico.cpp"
+
+const char* const PRUEBA_INSTANTANEA = "prueba_arbol.bin";
+const char* const PRUEBA_DIARIO = "prueba_arbol.wal";
+
+/**
+ * Nombre del miembro i de una prueba (distintos entre si)
+ */
+string nombrePrueba(int i) {
+    char nombre[40];
+    sprintf(nombre, "Miembro de prueba %07d", i);
+    return nombre;
+}
+
+void borrarArchivosPrueba() {
+    remove(PRUEBA_INSTANTANEA);
+    remove(PRUEBA_DIARIO);
+}
+
+/**
+ * Una insercion con emplazarMiembro cuyo registro dispara la
+ * compactacion del diario debe quedar en la instantanea: al reabrir,
+ * el miembro tiene que estar
+ */
+bool pruebaEmplazarCruzaCompactacion() {
+    borrarArchivosPrueba();
+    int insertados = 0;
+    string nombreCompactado;
+    {
+        ArbolGenealogico arbol;
+        string error;
+        if (!arbol.abrirPersistencia(PRUEBA_INSTANTANEA, PRUEBA_DIARIO, error)) {
+            fprintf(stderr, "  no se pudo abrir la persistencia: %s\n", error.c_str());
+            return false;
+        }
+        arbol.configurarDiario(4096, 1000.0);
+        // Textos largos: menos registros hasta UMBRAL_COMPACTACION
+        string relleno(200, 'x');
+        DatosMiembro datos;
+        while (nombreCompactado.empty()) {
+            datos = DatosMiembro(nombrePrueba(insertados), 30, "Femenino",
+                                 "Hija", "Tejido " + relleno, "Cusco " + relleno);
+            string nombre = datos.nombre;
+            unsigned long long antes = arbol.bytesDiario();
+            if (!arbol.emplazarMiembro(datos)) {
+                fprintf(stderr, "  no se inserto %s\n", nombre.c_str());
+                return false;
+            }
+            insertados++;
+            if (arbol.bytesDiario() < antes) nombreCompactado = nombre;
+        }
+        // Una mas despues de compactar: debe salir del diario nuevo
+        datos = DatosMiembro(nombrePrueba(insertados), 31, "Masculino", "Hijo", "Pastoreo", "Puno");
+        arbol.emplazarMiembro(datos);
+        insertados++;
+        arbol.sincronizarDiario();
+    }
+
+    ArbolGenealogico reabierto;
+    string error;
+    bool ok = reabierto.abrirPersistencia(PRUEBA_INSTANTANEA, PRUEBA_DIARIO, error);
+    if (!ok) fprintf(stderr, "  no se pudo reabrir: %s\n", error.c_str());
+    if (ok && reabierto.buscarMiembroLectura(nombreCompactado) == NULL) {
+        fprintf(stderr, "  falta %s (el que disparo la compactacion)\n", nombreCompactado.c_str());
+        ok = false;
+    }
+    if (ok && reabierto.totalMiembros() != insertados) {
+        fprintf(stderr, "  %d miembros al reabrir, se insertaron %d\n",
+                reabierto.totalMiembros(), insertados);
+        ok = false;
+    }
+    borrarArchivosPrueba();
+    return ok;
+}
+
+/**
+ * Eliminar un miembro con dos hijos reenlaza a su sucesor; el arbol
+ * debe seguir cumpliendo el balance AVL despues de cada eliminacion
+ */
+bool pruebaEliminarConDosHijosConservaBalance() {
+    ArbolGenealogico arbol;
+    const int total = 5000;
+    // Orden pseudoaleatorio fijo (LCG) para insertar y para eliminar
+    unsigned long long semilla = 12345;
+    vector<int> orden(total);
+    for (int i = 0; i < total; i++) orden[i] = i;
+    for (int i = total - 1; i > 0; i--) {
+        semilla = semilla * 6364136223846793005ULL + 1442695040888963407ULL;
+        swap(orden[i], orden[(int)((semilla >> 33) % (unsigned long long)(i + 1))]);
+    }
+    for (int i = 0; i < total; i++)
+        arbol.insertarMiembroAVL(nombrePrueba(orden[i]), 20 + i % 60, "Masculino", "Hijo", "Pastoreo", "Puno");
+
+    int conDosHijos = 0;
+    for (int i = total - 1; i >= 0; i--) {
+        string nombre = nombrePrueba(orden[(i * 7919) % total]);
+        const Miembro* m = arbol.buscarMiembroLectura(nombre);
+        if (m == NULL) continue;
+        if (m->izquierdo != NULL && m->derecho != NULL) conDosHijos++;
+        arbol.eliminarMiembro(nombre);
+        if (!arbol.estaBalanceado()) {
+            fprintf(stderr, "  desbalanceado al eliminar %s (%d miembros)\n",
+                    nombre.c_str(), arbol.totalMiembros());
+            return false;
+        }
+    }
+    if (conDosHijos == 0) {
+        fprintf(stderr, "  ninguna eliminacion tuvo dos hijos\n");
+        return false;
+    }
+    return arbol.totalMiembros() == 0;
+}
+
+/* ---------------------------
+   Lectores y escritor de pruebaLecturasSinCerrojo: los miembros pares
+   estan siempre; los impares el escritor los inserta y los elimina
+   --------------------------- */
+const int MIEMBROS_CONCURRENTES = 2000;
+volatile long escritorTermino = 0;
+
+string lugarPrueba(int i) {
+    return "Lugar " + nombrePrueba(i % 40);
+}
+
+class LectorPrueba : public TareaParalela {
+public:
+    const ArbolConcurrente* arbol;
+    unsigned int x;
+    long lecturas, errores;
+
+    LectorPrueba(const ArbolConcurrente* _arbol, unsigned int semilla)
+        : arbol(_arbol), x(semilla), lecturas(0), errores(0) {}
+
+    void ejecutar() {
+        DatosMiembro datos;
+        while (!escritorTermino || lecturas < 1000) {
+            x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+            int i = (int)(x % MIEMBROS_CONCURRENTES);
+            bool existe = arbol->buscar(nombrePrueba(i), datos);
+            if (i % 2 == 0 && !existe) errores++;
+            if (existe && (datos.nombre != nombrePrueba(i) || datos.edad != i % 90 ||
+                           datos.lugarNacimiento != lugarPrueba(i)))
+                errores++;
+            lecturas++;
+        }
+    }
+};
+
+class EscritorPrueba : public TareaParalela {
+public:
+    ArbolConcurrente* arbol;
+
+    explicit EscritorPrueba(ArbolConcurrente* _arbol) : arbol(_arbol) {}
+
+    void ejecutar() {
+        unsigned int x = 99;
+        for (int r = 0; r < 50000; r++) {
+            x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+            int i = (int)(x % MIEMBROS_CONCURRENTES) | 1;
+            // Ocupaciones nuevas: la tabla de simbolos crece mientras se lee
+            DatosMiembro d(nombrePrueba(i), i % 90, "Femenino", "Hija",
+                           "Oficio " + nombrePrueba(r % 500), lugarPrueba(i));
+            if (!arbol->insertar(d)) arbol->eliminar(d.nombre);
+        }
+        escritorTermino = 1;
+    }
+};
+
+/**
+ * Las busquedas sin cerrojo de ArbolConcurrente, con un escritor que
+ * inserta y elimina a la vez, nunca pierden un miembro que no se toca
+ * ni devuelven datos mezclados (compilar con -fsanitize=address y
+ * -DARBOL_NODOS_HEAP para ver ademas que ningun nodo se libera antes
+ * de tiempo)
+ */
+bool pruebaLecturasSinCerrojo() {
+    ArbolGenealogico arbol;
+    for (int i = 0; i < MIEMBROS_CONCURRENTES; i += 2)
+        arbol.insertarMiembroAVL(nombrePrueba(i), i % 90, "Femenino", "Hija", "Tejido", lugarPrueba(i));
+    long lecturas = 0, errores = 0;
+    {
+        ArbolConcurrente concurrente(arbol);
+        EscritorPrueba escritor(&concurrente);
+        vector<LectorPrueba*> lectores;
+        vector<TareaParalela*> tareas(1, &escritor);
+        for (int h = 0; h < 4; h++) {
+            lectores.push_back(new LectorPrueba(&concurrente, 2463534242u + 7919u * (unsigned int)h));
+            tareas.push_back(lectores.back());
+        }
+        ejecutarEnParalelo(tareas);
+        for (size_t h = 0; h < lectores.size(); h++) {
+            lecturas += lectores[h]->lecturas;
+            errores += lectores[h]->errores;
+            delete lectores[h];
+        }
+    }
+    if (errores != 0)
+        fprintf(stderr, "  %ld de %ld busquedas con resultado equivocado\n", errores, lecturas);
+    return errores == 0 && arbol.estaBalanceado();
+}
+
+int main() {
+    struct Prueba {
+        const char* nombre;
+        bool (*correr)();
+    };
+    const Prueba pruebas[] = {
+        { "emplazarMiembro que cruza el umbral de compactacion", pruebaEmplazarCruzaCompactacion },
+        { "eliminar con dos hijos conserva el balance AVL", pruebaEliminarConDosHijosConservaBalance },
+        { "busquedas sin cerrojo con un escritor a la vez", pruebaLecturasSinCerrojo }
+    };
+    int fallidas = 0;
+    for (size_t i = 0; i < sizeof(pruebas) / sizeof(pruebas[0]); i++) {
+        bool ok = pruebas[i].correr();
+        printf("[%s] %s\n", ok ? "OK" : "FALLO", pruebas[i].nombre);
+        if (!ok) fallidas++;
+    }
+    return fallidas == 0 ? 0 : 1;
+}